@@ -1,7 +1,9 @@
 #ifndef RANDOM_AGENT_H
 #define RANDOM_AGENT_H
 
+#include <memory>
 #include <random>
+#include <vector>
 
 #include "bboard.hpp"
 #include "strategy.hpp"
@@ -64,6 +66,7 @@ struct SimpleAgent : bboard::Agent
     //////////////
     int danger = 0;
     bboard::strategy::RMap r;
+    bboard::strategy::DangerMap dangerMap;
     bboard::FixedQueue<bboard::Move, bboard::MOVE_COUNT> moveQueue;
 
     // capacity of recent positions
@@ -96,6 +99,140 @@ struct SimpleUnbiasedAgent : SimpleAgent
     void reset() override;
 };
 
+/**
+ * @brief The policy of all agents in the rollouts of MCTSAgent (and of the
+ * other agents during the tree search).
+ */
+enum class RolloutPolicy
+{
+    // uniformly random moves
+    RANDOM,
+    // SimpleUnbiasedAgent on fully observable observations
+    SIMPLE
+};
+
+/**
+ * @brief The parameters of MCTSAgent.
+ */
+struct MCTSParameters
+{
+    // the maximum number of simulations per move (<= 0 for no limit)
+    int iterations = 0;
+    // the maximum time per move in milliseconds (<= 0 for no limit)
+    int timeBudgetMs = 100;
+    // the maximum number of steps of a simulation (tree and rollout)
+    int maxDepth = 12;
+    // the exploration constant of UCB1
+    float exploration = 1.0f;
+    RolloutPolicy rolloutPolicy = RolloutPolicy::RANDOM;
+    // the number of nodes which are allocated once in the constructor
+    int arenaCapacity = 1 << 19;
+};
+
+/**
+ * @brief A node of the search tree of MCTSAgent. The children of a node are
+ * stored next to each other in the arena (one per move).
+ */
+struct MCTSNode
+{
+    // the index of the first child in the arena, -1 if not expanded
+    int children = -1;
+    int visits = 0;
+    float valueSum = 0;
+};
+
+/**
+ * @brief An arena for MCTS nodes. All nodes are allocated in the
+ * constructor, Allocate hands out consecutive nodes and Reset frees all
+ * nodes at once.
+ */
+class MCTSNodeArena
+{
+public:
+    explicit MCTSNodeArena(int capacity);
+
+    /**
+     * @brief Allocate Returns the index of the first of count fresh nodes,
+     * -1 if the arena is full.
+     */
+    int Allocate(int count);
+
+    /**
+     * @brief Reset Frees all nodes.
+     */
+    void Reset();
+
+    int GetSize() const;
+    int GetCapacity() const;
+
+    inline MCTSNode& operator[](int index)
+    {
+        return nodes[index];
+    }
+
+    inline const MCTSNode& operator[](int index) const
+    {
+        return nodes[index];
+    }
+
+private:
+    std::vector<MCTSNode> nodes;
+    int size = 0;
+};
+
+/**
+ * @brief Plans with Monte Carlo tree search (UCT) on the forward model
+ * (State::Step).
+ *
+ * The tree is open-loop: it only contains the moves of this agent, the
+ * other agents follow the rollout policy. Every simulation starts at the
+ * state of the current observation (see Observation::ToState), descends
+ * with UCB1 and continues with the rollout policy until the game is over
+ * or maxDepth steps have been executed. Wins count +1, draws 0, losses and
+ * the death of this agent -1, otherwise the value is half the fraction of
+ * dead enemies. The most visited move is executed.
+ */
+struct MCTSAgent : bboard::Agent
+{
+    std::mt19937_64 rng;
+
+    MCTSAgent();
+    MCTSAgent(long seed, const MCTSParameters& params = MCTSParameters());
+
+    bboard::Move act(const bboard::Observation* obs) override;
+    void reset() override;
+
+    /**
+     * @brief GetLastIterations Returns the number of simulations of the last move.
+     */
+    int GetLastIterations() const;
+
+    /**
+     * @brief GetRootVisits Returns the visits of every move at the root
+     * after the last search.
+     */
+    void GetRootVisits(int visits[bboard::ACTION_COUNT]) const;
+
+private:
+    MCTSParameters params;
+    MCTSNodeArena arena;
+
+    std::unique_ptr<bboard::State> root;
+    std::unique_ptr<bboard::State> state;
+
+    // only used by the SIMPLE rollout policy
+    std::unique_ptr<bboard::Observation[]> observations;
+    std::unique_ptr<SimpleUnbiasedAgent[]> rolloutAgents;
+
+    std::vector<int> path;
+    int lastIterations = 0;
+
+    void _simulate();
+    int _selectChild(int node);
+    void _policyMoves(bboard::Move moves[bboard::AGENT_COUNT]);
+    float _evaluate(const bboard::State& s) const;
+};
+
 }
 
 #endif
@@ -0,0 +1,492 @@
+#ifndef BATCH_STATE_H
+#define BATCH_STATE_H
+
+#include <cstdint>
+
+#include "bboard.hpp"
+#include "compact_state.hpp"
+#include "step_utility.hpp"
+
+namespace bboard
+{
+
+/**
+ * @brief Holds N games in structure-of-arrays form and steps them together.
+ *
+ * The innermost dimension of every member is the game (cells[i][g] is cell
+ * i of game g), so the phases of the step function run over all games in
+ * tight loops:
+ *
+ * - Flames are stored inside the cells (see cell::FromItem) and are ticked
+ *   in a single pass over the cells of all games.
+ * - Collision-free agent moves (see util::IsCollisionFreeStep) are applied
+ *   agent by agent to all games which have one.
+ * - Bomb timers are counted down slot by slot and the games with expiring
+ *   bombs are found in a single pass.
+ *
+ * Games with collisions, moving bombs, explosions or deaths are gathered
+ * into a CompactState, which executes these phases with the same step
+ * pipeline as State::Step. StepBatch yields exactly the same games as
+ * calling State::Step for every game individually.
+ *
+ * @tparam N The number of games
+ */
+template<int N>
+class BatchState
+{
+public:
+    /**
+     * @brief The agent with a given id in all games, one array per member
+     * of CompactAgentInfo.
+     */
+    struct AgentColumns
+    {
+        // positions are negative for invisible agents
+        int8_t x[N];
+        int8_t y[N];
+        int8_t bombCount[N];
+        int8_t maxBombCount[N];
+        int8_t bombStrength[N];
+        int8_t team[N];
+        bool dead[N];
+        bool visible[N];
+        bool statsVisible[N];
+        bool canKick[N];
+    };
+
+    // the cell codes of cell x + BOARD_SIZE * y
+    uint8_t cells[BOARD_SIZE * BOARD_SIZE][N];
+
+    AgentColumns agents[AGENT_COUNT];
+
+    // bombs[b][g] is the b-th oldest bomb of game g
+    Bomb bombs[MAX_BOMBS][N];
+    int8_t bombCount[N];
+
+    int16_t timeStep[N];
+    int8_t winningTeam[N];
+    int8_t winningAgent[N];
+    int8_t aliveAgents[N];
+    bool finished[N];
+    bool isDraw[N];
+
+    /**
+     * @brief Init Initializes all games. Game g uses the board seed boardSeed + g.
+     * See State::Init for a description of the remaining parameters.
+     */
+    void Init(GameMode gameMode, long boardSeed, long agentPositionSeed, int numRigid = DEFAULT_NUM_RIGID, int numWood = DEFAULT_NUM_WOOD, int numPowerUps = DEFAULT_NUM_POWERUPS, int padding = 1, int breathingRoomSize = 3)
+    {
+        State state;
+        for(int g = 0; g < N; g++)
+        {
+            state = State();
+            state.Init(gameMode, boardSeed + g, agentPositionSeed, numRigid, numWood, numPowerUps, padding, breathingRoomSize);
+            FromState(g, state);
+        }
+    }
+
+    /**
+     * @brief FromState Loads the given state into game g.
+     */
+    void FromState(int g, const State& state)
+    {
+        CompactState c;
+        c.FromState(state);
+        SetGame(g, c);
+    }
+
+    /**
+     * @brief ToState Writes game g into the given state (see CompactState::ToState).
+     */
+    void ToState(int g, State& state) const
+    {
+        CompactState c;
+        GetGame(g, c);
+        c.ToState(state);
+    }
+
+    /**
+     * @brief GetGame Gathers game g into the given compact state.
+     */
+    void GetGame(int g, CompactState& c) const
+    {
+        for(int i = 0; i < BOARD_SIZE * BOARD_SIZE; i++)
+        {
+            c.cells[i] = cells[i][g];
+        }
+
+        for(int i = 0; i < AGENT_COUNT; i++)
+        {
+            const AgentColumns& a = agents[i];
+            CompactAgentInfo& info = c.agents[i];
+            info.x = a.x[g];
+            info.y = a.y[g];
+            info.bombCount = a.bombCount[g];
+            info.maxBombCount = a.maxBombCount[g];
+            info.bombStrength = a.bombStrength[g];
+            info.team = a.team[g];
+            info.dead = a.dead[g];
+            info.visible = a.visible[g];
+            info.statsVisible = a.statsVisible[g];
+            info.canKick = a.canKick[g];
+        }
+
+        c.bombs.index = 0;
+        c.bombs.count = bombCount[g];
+        for(int b = 0; b < bombCount[g]; b++)
+        {
+            c.bombs.queue[b] = bombs[b][g];
+        }
+
+        c.timeStep = timeStep[g];
+        c.winningTeam = winningTeam[g];
+        c.winningAgent = winningAgent[g];
+        c.aliveAgents = aliveAgents[g];
+        c.finished = finished[g];
+        c.isDraw = isDraw[g];
+    }
+
+    /**
+     * @brief SetGame Scatters the given compact state into game g.
+     */
+    void SetGame(int g, const CompactState& c)
+    {
+        for(int i = 0; i < BOARD_SIZE * BOARD_SIZE; i++)
+        {
+            cells[i][g] = c.cells[i];
+        }
+
+        for(int i = 0; i < AGENT_COUNT; i++)
+        {
+            AgentColumns& a = agents[i];
+            const CompactAgentInfo& info = c.agents[i];
+            a.x[g] = info.x;
+            a.y[g] = info.y;
+            a.bombCount[g] = info.bombCount;
+            a.maxBombCount[g] = info.maxBombCount;
+            a.bombStrength[g] = info.bombStrength;
+            a.team[g] = info.team;
+            a.dead[g] = info.dead;
+            a.visible[g] = info.visible;
+            a.statsVisible[g] = info.statsVisible;
+            a.canKick[g] = info.canKick;
+        }
+
+        bombCount[g] = c.bombs.count;
+        for(int b = 0; b < c.bombs.count; b++)
+        {
+            bombs[b][g] = c.bombs[b];
+        }
+
+        timeStep[g] = c.timeStep;
+        winningTeam[g] = c.winningTeam;
+        winningAgent[g] = c.winningAgent;
+        aliveAgents[g] = c.aliveAgents;
+        finished[g] = c.finished;
+        isDraw[g] = c.isDraw;
+    }
+
+    /**
+     * @brief StepBatch Executes a step in all games (see State::Step).
+     * Terminal games are skipped.
+     * @param moves The moves of all agents in all games
+     */
+    void StepBatch(const Move moves[N][AGENT_COUNT])
+    {
+        bool active[N];
+        int8_t aliveAgentsBefore[N];
+        for(int g = 0; g < N; g++)
+        {
+            active[g] = !finished[g];
+            aliveAgentsBefore[g] = aliveAgents[g];
+        }
+
+        _tickFlames(active);
+
+        // move the agents of all collision-free games at once, the
+        // remaining games resolve their collisions one by one
+        int8_t destX[AGENT_COUNT][N];
+        int8_t destY[AGENT_COUNT][N];
+        _fillDestPos(moves, destX, destY);
+
+        int collisionFree[N];
+        int collisionFreeCount = 0;
+        int colliding[N];
+        int collidingCount = 0;
+        for(int g = 0; g < N; g++)
+        {
+            if(!active[g]) continue;
+
+            if(_isCollisionFreeStep(g, destX, destY))
+                collisionFree[collisionFreeCount++] = g;
+            else
+                colliding[collidingCount++] = g;
+        }
+        _moveAgents(moves, collisionFree, collisionFreeCount, destX, destY);
+
+        CompactState c;
+        for(int k = 0; k < collidingCount; k++)
+        {
+            const int g = colliding[k];
+            GetGame(g, c);
+            c.MoveAgentsAndBombs(moves[g]);
+            SetGame(g, c);
+        }
+
+        _tickBombs(active);
+
+        // explosions (and chain reactions) are rare, so they are executed
+        // one game at a time
+        bool explodes[N];
+        for(int g = 0; g < N; g++)
+        {
+            explodes[g] = active[g] && bombCount[g] > 0 && BMB_TIME(bombs[0][g]) <= 0;
+        }
+        for(int g = 0; g < N; g++)
+        {
+            if(!explodes[g]) continue;
+
+            GetGame(g, c);
+            util::ExplodeBombs(&c);
+            SetGame(g, c);
+        }
+
+        for(int g = 0; g < N; g++)
+        {
+            if(!active[g]) continue;
+
+            timeStep[g]++;
+            if(aliveAgentsBefore[g] != aliveAgents[g])
+            {
+                GetGame(g, c);
+                util::CheckTerminalState(c);
+                SetGame(g, c);
+            }
+        }
+    }
+
+    /**
+     * @brief ActiveCount Returns the number of games which are not finished yet.
+     */
+    int ActiveCount() const
+    {
+        int count = 0;
+        for(int g = 0; g < N; g++)
+        {
+            if(!finished[g])
+                count++;
+        }
+        return count;
+    }
+
+private:
+    void _tickFlames(const bool active[N])
+    {
+        uint8_t tick[N];
+        for(int g = 0; g < N; g++)
+        {
+            tick[g] = active[g] ? 1 << cell::FLAME_SHIFT : 0;
+        }
+
+        for(int i = 0; i < BOARD_SIZE * BOARD_SIZE; i++)
+        {
+            for(int g = 0; g < N; g++)
+            {
+                // cells without flames only consist of their kind, so they
+                // are not modified here
+                const uint8_t c = cells[i][g];
+                const uint8_t next = c - ((c & cell::FLAME_MASK) ? tick[g] : 0);
+                // the powerup below a burnt out flame becomes visible again
+                cells[i][g] = (next & cell::FLAME_MASK) ? next : next & cell::KIND_MASK;
+            }
+        }
+    }
+
+    void _tickBombs(const bool active[N])
+    {
+        for(int b = 0; b < MAX_BOMBS; b++)
+        {
+            for(int g = 0; g < N; g++)
+            {
+                // see ReduceBombTimer
+                bombs[b][g] -= (active[g] && b < bombCount[g]) ? 1 << BMB_TIME_SHIFT : 0;
+            }
+        }
+    }
+
+    void _fillDestPos(const Move moves[N][AGENT_COUNT], int8_t destX[AGENT_COUNT][N], int8_t destY[AGENT_COUNT][N]) const
+    {
+        // the position offsets of all moves (see util::DesiredPosition)
+        static const int8_t moveX[6] = {0, 0, 0, -1, 1, 0};
+        static const int8_t moveY[6] = {0, -1, 1, 0, 0, 0};
+
+        for(int i = 0; i < AGENT_COUNT; i++)
+        {
+            for(int g = 0; g < N; g++)
+            {
+                const int m = int(moves[g][i]);
+                destX[i][g] = agents[i].x[g] + moveX[m];
+                destY[i][g] = agents[i].y[g] + moveY[m];
+            }
+        }
+    }
+
+    bool _isOutOfBounds(int x, int y) const
+    {
+        return x < 0 || y < 0 || x >= BOARD_SIZE || y >= BOARD_SIZE;
+    }
+
+    bool _hasBomb(int g, int x, int y) const
+    {
+        for(int b = 0; b < bombCount[g]; b++)
+        {
+            if(BMB_POS_X(bombs[b][g]) == x && BMB_POS_Y(bombs[b][g]) == y)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void _kill(int g, int agentID)
+    {
+        if(!agents[agentID].dead[g])
+        {
+            agents[agentID].dead[g] = true;
+            aliveAgents[g]--;
+        }
+    }
+
+    bool _isCollisionFreeStep(int g, const int8_t destX[AGENT_COUNT][N], const int8_t destY[AGENT_COUNT][N]) const
+    {
+        // same conditions as util::IsCollisionFreeStep
+
+        // moving bombs can collide with agents and other bombs
+        for(int b = 0; b < bombCount[g]; b++)
+        {
+            if(BMB_DIR(bombs[b][g]) != int(Direction::IDLE))
+                return false;
+        }
+
+        for(int i = 0; i < AGENT_COUNT; i++)
+        {
+            const AgentColumns& a = agents[i];
+            if(a.dead[g])
+                continue;
+            if(!a.visible[g])
+                return false;
+
+            // the destinations out of the board are unique
+            const int x = destX[i][g];
+            const int y = destY[i][g];
+            if((x == a.x[g] && y == a.y[g]) || _isOutOfBounds(x, y))
+                continue;
+
+            // every alive agent occupies its cell, so there is an agent or
+            // a bomb at the destination iff the cell shows one
+            const uint8_t c = cells[x + BOARD_SIZE * y][g];
+            if(c == cell::BOMB || (c >= cell::AGENT0 && c < cell::AGENT0 + AGENT_COUNT))
+                return false;
+
+            for(int j = 0; j < i; j++)
+            {
+                if(!agents[j].dead[g] && destX[j][g] == x && destY[j][g] == y)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    void _moveAgents(const Move moves[N][AGENT_COUNT], const int games[N], int gameCount, const int8_t destX[AGENT_COUNT][N], const int8_t destY[AGENT_COUNT][N])
+    {
+        // all agents move independently (see util::MoveAgent)
+        for(int i = 0; i < AGENT_COUNT; i++)
+        {
+            AgentColumns& a = agents[i];
+            for(int k = 0; k < gameCount; k++)
+            {
+                const int g = games[k];
+
+                const int x = a.x[g];
+                const int y = a.y[g];
+
+                // hide the agent from the board
+                if(!_isOutOfBounds(x, y) && cells[x + BOARD_SIZE * y][g] == cell::AGENT0 + i)
+                {
+                    cells[x + BOARD_SIZE * y][g] = _hasBomb(g, x, y) ? cell::BOMB : cell::PASSAGE;
+                }
+
+                if(a.dead[g]) continue;
+
+                if(moves[g][i] == Move::BOMB)
+                {
+                    // see util::TryPutBomb
+                    if(a.bombCount[g] < a.maxBombCount[g] && !_hasBomb(g, x, y))
+                    {
+                        bombs[bombCount[g]++][g] = CreateBomb(i, x, y, a.bombStrength[g], BOMB_LIFETIME + 1);
+                        a.bombCount[g]++;
+                    }
+                    continue;
+                }
+
+                const int dx = destX[i][g];
+                const int dy = destY[i][g];
+                if((dx == x && dy == y) || _isOutOfBounds(dx, dy))
+                    continue;
+
+                // cannot walk on wooden and rigid boxes (the destination
+                // can't be occupied by agents in collision-free steps)
+                const uint8_t c = cells[dx + BOARD_SIZE * dy][g];
+                if(c == cell::RIGID || (c >= cell::WOOD && c <= cell::WOOD + 3))
+                    continue;
+
+                a.x[g] = dx;
+                a.y[g] = dy;
+            }
+        }
+
+        // see util::ApplyAgentMovement
+        for(int i = 0; i < AGENT_COUNT; i++)
+        {
+            AgentColumns& a = agents[i];
+            for(int k = 0; k < gameCount; k++)
+            {
+                const int g = games[k];
+                if(a.dead[g]) continue;
+
+                uint8_t& c = cells[a.x[g] + BOARD_SIZE * a.y[g]][g];
+
+                // agent moved into flame
+                if(c & cell::FLAME_MASK)
+                {
+                    _kill(g, i);
+                    continue;
+                }
+
+                // collect power-ups
+                switch(c)
+                {
+                    case cell::POWERUP + 1: a.maxBombCount[g]++; break;
+                    case cell::POWERUP + 2: a.bombStrength[g]++; break;
+                    case cell::POWERUP + 3: a.canKick[g] = true; break;
+                }
+
+                c = cell::AGENT0 + i;
+            }
+        }
+
+        // see util::ResetBombFlags
+        for(int k = 0; k < gameCount; k++)
+        {
+            const int g = games[k];
+            for(int b = 0; b < bombCount[g]; b++)
+            {
+                bombs[b][g] &= cmaskFlag;
+            }
+        }
+    }
+};
+
+}
+
+#endif // BATCH_STATE_H
@@ -2,21 +2,40 @@
 #define BBOARD_H_
 
 #include <array>
+#include <cstdint>
 #include <string>
 #include <random>
 #include <memory>
 #include <iostream>
 #include <algorithm>
 #include <functional>
+#include <type_traits>
+#include <cassert>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// the board size can be changed at build time (cmake -DPOMCPP_BOARD_SIZE=8)
+#ifndef POMCPP_BOARD_SIZE
+#define POMCPP_BOARD_SIZE 11
+#endif
 
 namespace bboard
 {
 
 const int MOVE_COUNT  = 4;
+// fixed, the game modes, teams and the python interface assume 4 agents
 const int AGENT_COUNT = 4;
-const int BOARD_SIZE  = 11;
+const int BOARD_SIZE  = POMCPP_BOARD_SIZE;
 
-static_assert (BOARD_SIZE <= 15, "Board positions must fit into 8-bit");
+static_assert (BOARD_SIZE >= 6 && BOARD_SIZE <= 31, "Board positions must fit into 5-bit");
+
+/**
+ * @brief CellIndex The smallest unsigned type which can hold the
+ * index x + BOARD_SIZE * y of every cell.
+ */
+typedef std::conditional<BOARD_SIZE * BOARD_SIZE <= 256, uint8_t, uint16_t>::type CellIndex;
 
 const int BOMB_LIFETIME = 9;
 const int BOMB_DEFAULT_STRENGTH = 1;
@@ -26,6 +45,12 @@ const int FLAME_LIFETIME = 3;
 const int MAX_BOMBS_PER_AGENT = 5;
 const int MAX_BOMBS = AGENT_COUNT * MAX_BOMBS_PER_AGENT;
 
+// the default item counts of State::Init (36 rigid blocks, 36 wooden blocks
+// and 20 powerups on 11x11 boards, scaled by the number of cells)
+const int DEFAULT_NUM_RIGID    = 36 * BOARD_SIZE * BOARD_SIZE / 121;
+const int DEFAULT_NUM_WOOD     = 36 * BOARD_SIZE * BOARD_SIZE / 121;
+const int DEFAULT_NUM_POWERUPS = 20 * BOARD_SIZE * BOARD_SIZE / 121;
+
 /**
  * Holds all moves an agent can make on a board. An array
  * of 4 moves are necessary to correctly calculate a full
@@ -42,6 +67,20 @@ enum class Move
     BOMB
 };
 
+/**
+ * @brief A set of moves, bit i is set if Move(i) is part of the set.
+ */
+typedef uint8_t MoveMask;
+
+// the number of all moves (MOVE_COUNT only counts the directions)
+const int ACTION_COUNT = 6;
+const MoveMask ALL_MOVES = (1 << ACTION_COUNT) - 1;
+
+inline MoveMask MoveBit(Move m)
+{
+    return MoveMask(1) << int(m);
+}
+
 enum class Direction
 {
     IDLE = 0,
@@ -227,6 +266,21 @@ struct FixedQueue
         std::copy_n(&arr[0], count, &queue[0]);
     }
 
+    /**
+     * @brief CopyActiveFrom Copies the elements of the other queue, only
+     * the occupied slots are copied (they keep their positions in queue).
+     */
+    void CopyActiveFrom(const FixedQueue<T, TSize>& other)
+    {
+        index = other.index;
+        count = other.count;
+
+        // the elements are stored in up to two partitions
+        const int firstPartitionSize = std::min(count, TSize - index);
+        std::copy_n(&other.queue[index], firstPartitionSize, &queue[index]);
+        std::copy_n(&other.queue[0], count - firstPartitionSize, &queue[0]);
+    }
+
     /**
      * @brief operator [] Circular buffer on all bombs
      * @return The i-th elem if the index is in [0, n]
@@ -313,6 +367,212 @@ inline bool InViewRange(const Position& p1, const Position& p2, int range)
     return InViewRange(p1.x, p1.y, p2.x, p2.y, range);
 }
 
+/**
+ * @brief CountTrailingZeros Returns the index of the lowest set bit.
+ * @param word A non-zero word
+ */
+inline int CountTrailingZeros(uint64_t word)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return (int)index;
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+/**
+ * @brief PopCount Returns the number of set bits.
+ */
+inline int PopCount(uint64_t word)
+{
+#if defined(_MSC_VER)
+    return (int)__popcnt64(word);
+#else
+    return __builtin_popcountll(word);
+#endif
+}
+
+/**
+ * @brief CELL_COUNT The number of cells of the board.
+ */
+const int CELL_COUNT = BOARD_SIZE * BOARD_SIZE;
+
+/**
+ * @brief PLANE_WORDS The number of 64-bit words of a bit plane (a single
+ * word for boards up to 8x8, two words for the default 11x11 board).
+ */
+const int PLANE_WORDS = (CELL_COUNT + 63) / 64;
+
+/**
+ * @brief LAST_WORD_MASK The bits of the last word which belong to the board.
+ */
+const uint64_t LAST_WORD_MASK = CELL_COUNT % 64 == 0 ? ~uint64_t(0) : (uint64_t(1) << (CELL_COUNT % 64)) - 1;
+
+/**
+ * @brief A set of board cells, stored as a bit mask. Cell (x, y) is
+ * represented by bit x + BOARD_SIZE * y. Used for the planes of BitBoard
+ * and to track modified cells (see State::dirtyCells and StepJournal).
+ */
+struct BitPlane
+{
+    // bit i is stored in words[i / 64]
+    uint64_t words[PLANE_WORDS] = {};
+
+    static inline int Index(int x, int y)
+    {
+        return x + BOARD_SIZE * y;
+    }
+
+    inline bool Test(int index) const
+    {
+        return (words[index >> 6] >> (index & 63)) & 1;
+    }
+
+    inline bool Test(int x, int y) const
+    {
+        return Test(Index(x, y));
+    }
+
+    inline void Set(int index)
+    {
+        words[index >> 6] |= uint64_t(1) << (index & 63);
+    }
+
+    inline void Set(int x, int y)
+    {
+        Set(Index(x, y));
+    }
+
+    inline void Reset(int index)
+    {
+        words[index >> 6] &= ~(uint64_t(1) << (index & 63));
+    }
+
+    inline void Reset(int x, int y)
+    {
+        Reset(Index(x, y));
+    }
+
+    /**
+     * @brief Reset Removes all cells.
+     */
+    inline void Reset()
+    {
+        std::fill_n(words, PLANE_WORDS, 0);
+    }
+
+    /**
+     * @brief Any Returns true if at least one cell is set.
+     */
+    inline bool Any() const
+    {
+        uint64_t any = 0;
+        for(int i = 0; i < PLANE_WORDS; i++)
+            any |= words[i];
+        return any != 0;
+    }
+
+    /**
+     * @brief Count Returns the number of set cells.
+     */
+    inline int Count() const
+    {
+        int count = 0;
+        for(int i = 0; i < PLANE_WORDS; i++)
+            count += PopCount(words[i]);
+        return count;
+    }
+
+    /**
+     * @brief ForEach Calls f(x, y) for every set cell in ascending
+     * index order.
+     */
+    template<typename F>
+    inline void ForEach(F f) const
+    {
+        for(int i = 0; i < PLANE_WORDS; i++)
+        {
+            for(uint64_t w = words[i]; w != 0; w &= w - 1)
+            {
+                int index = 64 * i + CountTrailingZeros(w);
+                f(index % BOARD_SIZE, index / BOARD_SIZE);
+            }
+        }
+    }
+
+    /**
+     * @brief ForEachIndex Calls f(index) for every set cell with an index
+     * in [first, last] in ascending order.
+     */
+    template<typename F>
+    inline void ForEachIndex(F f, int first = 0, int last = CELL_COUNT - 1) const
+    {
+        assert(first >= 0 && last < CELL_COUNT);
+        for(int i = first >> 6; i <= (last >> 6); i++)
+        {
+            uint64_t w = words[i];
+            if(i == (first >> 6))
+                w &= ~uint64_t(0) << (first & 63);
+            if(i == (last >> 6) && (last & 63) != 63)
+                w &= (uint64_t(1) << ((last & 63) + 1)) - 1;
+
+            for(; w != 0; w &= w - 1)
+            {
+                f(64 * i + CountTrailingZeros(w));
+            }
+        }
+    }
+};
+
+inline BitPlane operator&(const BitPlane& a, const BitPlane& b)
+{
+    BitPlane r;
+    for(int i = 0; i < PLANE_WORDS; i++)
+        r.words[i] = a.words[i] & b.words[i];
+    return r;
+}
+inline BitPlane operator|(const BitPlane& a, const BitPlane& b)
+{
+    BitPlane r;
+    for(int i = 0; i < PLANE_WORDS; i++)
+        r.words[i] = a.words[i] | b.words[i];
+    return r;
+}
+inline BitPlane operator^(const BitPlane& a, const BitPlane& b)
+{
+    BitPlane r;
+    for(int i = 0; i < PLANE_WORDS; i++)
+        r.words[i] = a.words[i] ^ b.words[i];
+    return r;
+}
+inline BitPlane& operator&=(BitPlane& a, const BitPlane& b)
+{
+    for(int i = 0; i < PLANE_WORDS; i++)
+        a.words[i] &= b.words[i];
+    return a;
+}
+inline BitPlane& operator|=(BitPlane& a, const BitPlane& b)
+{
+    for(int i = 0; i < PLANE_WORDS; i++)
+        a.words[i] |= b.words[i];
+    return a;
+}
+inline bool operator==(const BitPlane& a, const BitPlane& b)
+{
+    for(int i = 0; i < PLANE_WORDS; i++)
+    {
+        if(a.words[i] != b.words[i])
+            return false;
+    }
+    return true;
+}
+inline bool operator!=(const BitPlane& a, const BitPlane& b)
+{
+    return !(a == b);
+}
+
 /**
  * @brief The AgentInfo struct holds information ABOUT
  * an agent.
@@ -410,19 +670,39 @@ struct AgentInfo
  * [12, 16]  Strength
  * [16, 20]  Time
  * [20, 24]  Direction
+ * [24, 28]  Flag
+ *
+ * Boards larger than 15x15 use 5 bit wide position and strength fields,
+ * the following fields are shifted accordingly (see BMB_POS_BITS).
  */
 typedef int Bomb;
 
 // BOMB INFO
-// ACCESS ALL PARTS OF THE BOMB INTEGER (EVERYTHING ENCODED
-// INTO 4 BIT WIDE FIELDS)
+// THE WIDTH OF THE POSITION AND STRENGTH FIELDS DEPENDS ON THE
+// BOARD SIZE, ALL OTHER FIELDS ARE 4 BIT WIDE
+const int BMB_POS_BITS = BOARD_SIZE <= 16 ? 4 : 5;
+
+const int BMB_X_SHIFT        = 0;
+const int BMB_Y_SHIFT        = BMB_X_SHIFT + BMB_POS_BITS;
+const int BMB_ID_SHIFT       = BMB_Y_SHIFT + BMB_POS_BITS;
+const int BMB_STRENGTH_SHIFT = BMB_ID_SHIFT + 4;
+const int BMB_TIME_SHIFT     = BMB_STRENGTH_SHIFT + BMB_POS_BITS;
+const int BMB_DIR_SHIFT      = BMB_TIME_SHIFT + 4;
+const int BMB_FLAG_SHIFT     = BMB_DIR_SHIFT + 4;
+
+const int BMB_POS_MASK   = (1 << BMB_POS_BITS) - 1;
+const int BMB_FIELD_MASK = 0xF;
+
+static_assert (BMB_FLAG_SHIFT + 4 <= 31, "Bombs must fit into a signed int");
+
+// ACCESS ALL PARTS OF THE BOMB INTEGER
 inline int BMB_POS_X(const Bomb x)
 {
-    return (((x) & 0xF));             // [ 0, 4[
+    return ((x) >> BMB_X_SHIFT) & BMB_POS_MASK;
 }
 inline int BMB_POS_Y(const Bomb x)
 {
-    return (((x) & 0xF0) >> 4);       // [ 4, 8[
+    return ((x) >> BMB_Y_SHIFT) & BMB_POS_MASK;
 }
 inline Position BMB_POS(const Bomb x)
 {
@@ -430,41 +710,41 @@ inline Position BMB_POS(const Bomb x)
 }
 inline int BMB_ID(const Bomb x)
 {
-    return (((x) & 0xF00) >> 8);      // [ 8,12[
+    return ((x) >> BMB_ID_SHIFT) & BMB_FIELD_MASK;
 }
 inline int BMB_STRENGTH(const Bomb x)
 {
-    return (((x) & 0xF000) >> 12);    // [12,16[
+    return ((x) >> BMB_STRENGTH_SHIFT) & BMB_POS_MASK;
 }
 inline int BMB_TIME(const Bomb x)
 {
-    return (((x) & 0xF0000) >> 16);   // [16,20[
+    return ((x) >> BMB_TIME_SHIFT) & BMB_FIELD_MASK;
 }
 inline int BMB_DIR(const Bomb x)
 {
-    return (((x) & 0xF00000) >> 20);  // [20,24[
+    return ((x) >> BMB_DIR_SHIFT) & BMB_FIELD_MASK;
 }
 inline int BMB_FLAG(const Bomb x)
 {
-    return (((x) & 0xF000000) >> 24); // [24,28[
+    return ((x) >> BMB_FLAG_SHIFT) & BMB_FIELD_MASK;
 }
 
-// inverted bit-mask
-const int cmask0_4   =  ~0xF;
-const int cmask4_8   =  ~0xF0;
-const int cmask8_12  =  ~0xF00;
-const int cmask12_16 =  ~0xF000;
-const int cmask16_20 =  ~0xF0000;
-const int cmask20_24 =  ~0xF00000;
-const int cmask24_28 =  ~0xF000000;
+// inverted bit-masks
+const int cmaskX        = ~(BMB_POS_MASK << BMB_X_SHIFT);
+const int cmaskY        = ~(BMB_POS_MASK << BMB_Y_SHIFT);
+const int cmaskID       = ~(BMB_FIELD_MASK << BMB_ID_SHIFT);
+const int cmaskStrength = ~(BMB_POS_MASK << BMB_STRENGTH_SHIFT);
+const int cmaskTime     = ~(BMB_FIELD_MASK << BMB_TIME_SHIFT);
+const int cmaskDir      = ~(BMB_FIELD_MASK << BMB_DIR_SHIFT);
+const int cmaskFlag     = ~(BMB_FIELD_MASK << BMB_FLAG_SHIFT);
 
 inline void ReduceBombTimer(Bomb& bomb)
 {
-    bomb = bomb - (1 << 16);
+    bomb = bomb - (1 << BMB_TIME_SHIFT);
 }
 inline void SetBombPosition(Bomb& bomb, int x, int y)
 {
-    bomb = (bomb & cmask0_4 & cmask4_8) + (x) + (y << 4);
+    bomb = (bomb & cmaskX & cmaskY) + (x << BMB_X_SHIFT) + (y << BMB_Y_SHIFT);
 }
 inline void SetBombPosition(Bomb& bomb, Position pos)
 {
@@ -472,23 +752,38 @@ inline void SetBombPosition(Bomb& bomb, Position pos)
 }
 inline void SetBombID(Bomb& bomb, int id)
 {
-    bomb = (bomb & cmask8_12) + (id << 8);
+    bomb = (bomb & cmaskID) + (id << BMB_ID_SHIFT);
 }
 inline void SetBombStrength(Bomb& bomb, int strength)
 {
-    bomb = (bomb & cmask12_16) + (strength << 12);
+    bomb = (bomb & cmaskStrength) + (strength << BMB_STRENGTH_SHIFT);
 }
 inline void SetBombTime(Bomb& bomb, int time)
 {
-    bomb = (bomb & cmask16_20) + (time << 16);
+    bomb = (bomb & cmaskTime) + (time << BMB_TIME_SHIFT);
 }
 inline void SetBombDirection(Bomb& bomb, Direction dir)
 {
-    bomb = (bomb & cmask20_24) + (int(dir) << 20);
+    bomb = (bomb & cmaskDir) + (int(dir) << BMB_DIR_SHIFT);
 }
 inline void SetBombFlag(Bomb& bomb, bool moved)
 {
-    bomb = (bomb & cmask24_28) + (int(moved) << 24);
+    bomb = (bomb & cmaskFlag) + (int(moved) << BMB_FLAG_SHIFT);
+}
+/**
+ * @brief CreateBomb Returns a new idle bomb. All other (also the unused)
+ * bits are cleared.
+ */
+inline Bomb CreateBomb(int agentID, int x, int y, int strength, int lifeTime)
+{
+    Bomb b = 0;
+    SetBombID(b, agentID);
+    SetBombPosition(b, x, y);
+    SetBombStrength(b, strength);
+    SetBombDirection(b, Direction::IDLE);
+    SetBombFlag(b, false);
+    SetBombTime(b, lifeTime);
+    return b;
 }
 
 /**
@@ -530,6 +825,15 @@ public:
      */
     FixedQueue<Bomb, MAX_BOMBS> bombs;
 
+    /**
+     * @brief bombSlots Maps every cell to the slot in bombs.queue which
+     * holds the bomb at this cell. Entries of cells without bombs are stale,
+     * lookups are validated with the position of the bomb in that slot.
+     * Modify bombs with PutBomb, MoveBomb and RemoveBomb or call
+     * RebuildBombIndex after modifying the queue directly.
+     */
+    int8_t bombSlots[BOARD_SIZE * BOARD_SIZE] = {};
+
     /**
      * @brief flames Holds all flames on this board.
      */
@@ -546,6 +850,20 @@ public:
      */
     int currentFlameTime = -1;
 
+    /**
+     * @brief flameBuckets The number of flames with remaining lifetime t + 1.
+     * In an optimized flame queue, the flames of each bucket are stored
+     * consecutively and only the first flame of a bucket has a timeLeft > 0.
+     */
+    int flameBuckets[FLAME_LIFETIME] = {};
+
+    /**
+     * @brief flameSlots Maps every cell to the slot in flames.queue which
+     * holds the flame at this cell (validated like bombSlots). Call
+     * RebuildFlameIndex after modifying an optimized flame queue directly.
+     */
+    CellIndex flameSlots[BOARD_SIZE * BOARD_SIZE] = {};
+
     /**
      * @brief CopyFrom Copies the elements from the given board object to this board.
      * @param board The board which should be copied.
@@ -572,6 +890,22 @@ public:
         items[y][x] = item;
     }
 
+    /**
+     * @brief GetItem Returns the item at the given position
+     */
+    inline int GetItem(int x, int y) const
+    {
+        return items[y][x];
+    }
+
+    /**
+     * @brief SetItem Overrides the item at the given position
+     */
+    inline void SetItem(int x, int y, int item)
+    {
+        items[y][x] = item;
+    }
+
     /**
      * @brief Clear Overrides all items on the board with the given item.
      * @param item The item which will be used to clear the board.
@@ -587,6 +921,16 @@ public:
      */
     int GetAgent(int x, int y) const;
 
+    /**
+     * @brief SetAgentPosition Sets the position of the given agent without
+     * modifying the items (used by the step pipeline).
+     */
+    inline void SetAgentPosition(int agentID, int x, int y)
+    {
+        agents[agentID].x = x;
+        agents[agentID].y = y;
+    }
+
     /**
      * @brief Places agents with given IDs clockwise in the corners of
      * the board, starting from top left.
@@ -622,23 +966,103 @@ public:
      */
     void PutBomb(int x, int y, int agentID, int strength, int lifeTime, bool setItem);
 
+    /**
+     * @brief MoveBomb Moves the bomb at the specified index of the
+     * bomb queue to the given position.
+     */
+    void MoveBomb(int index, Position pos);
+
+    /**
+     * @brief RemoveBomb Removes the bomb at the specified index of the
+     * bomb queue.
+     */
+    void RemoveBomb(int index);
+
+    /**
+     * @brief RebuildBombIndex Rebuilds the cell index of all bombs. Has to
+     * be called after the bomb queue has been modified directly.
+     */
+    void RebuildBombIndex();
+
     /**
      * @brief hasBomb Returns true if a bomb is at the specified
      * position
      */
-    bool HasBomb(int x, int y) const;
+    inline bool HasBomb(int x, int y) const
+    {
+        return GetBombIndex(x, y) != -1;
+    }
 
     /**
      * @brief GetBomb Returns a bomb at the specified location or 0 if
      * no bomb has that position
      */
-    Bomb* GetBomb(int x, int y) const;
+    inline Bomb* GetBomb(int x, int y) const
+    {
+        const int i = GetBombIndex(x, y);
+        return i == -1 ? nullptr : (Bomb*)&bombs[i];
+    }
 
     /**
      * @brief GetBombIndex If a bomb is at position (x,y), then
      * returns the index of the bomb in the bomb queue. -1 otherwise
      */
-    int GetBombIndex(int x, int y) const;
+    inline int GetBombIndex(int x, int y) const
+    {
+        const int slot = bombSlots[x + BOARD_SIZE * y];
+        const int i = (slot - bombs.index + MAX_BOMBS) % MAX_BOMBS;
+        const Bomb b = bombs.queue[slot];
+        if(i < bombs.count && BMB_POS_X(b) == x && BMB_POS_Y(b) == y)
+        {
+            return i;
+        }
+        return -1;
+    }
+
+    /**
+     * @brief GetFlameIndex If a flame is at position (x,y), then
+     * returns the index of the flame in the flame queue. -1 otherwise
+     */
+    inline int GetFlameIndex(int x, int y) const
+    {
+        const int capacity = BOARD_SIZE * BOARD_SIZE;
+        const int slot = flameSlots[x + BOARD_SIZE * y];
+        const int i = (slot - flames.index + capacity) % capacity;
+        const Position& p = flames.queue[slot].position;
+        if(i < flames.count && p.x == x && p.y == y)
+        {
+            return i;
+        }
+        return -1;
+    }
+
+    /**
+     * @brief GetFlameLifetime Returns the remaining lifetime of the flame
+     * at the given index of the optimized flame queue.
+     */
+    inline int GetFlameLifetime(int index) const
+    {
+        int t = 0;
+        for(int end = flameBuckets[0]; index >= end; end += flameBuckets[t])
+        {
+            t++;
+        }
+        return t + 1;
+    }
+
+    /**
+     * @brief RemoveFlame Removes the flame at the given index of the
+     * optimized flame queue. The gap is closed by moving the last flame of
+     * each following bucket to the front of its bucket, so at most
+     * FLAME_LIFETIME flames are moved.
+     */
+    void RemoveFlame(int index);
+
+    /**
+     * @brief RebuildFlameIndex Rebuilds flameBuckets and flameSlots from
+     * the optimized flame queue.
+     */
+    void RebuildFlameIndex();
 
     /**
      * @brief FlagItem Returns the correct powerup
@@ -690,6 +1114,35 @@ inline int GetTeam(GameMode gameMode, int agentID)
     }
 }
 
+/**
+ * @brief A compile-time rule set for State::StepT. The branches of disabled
+ * rules are removed from the step. A rule must only be disabled if it cannot
+ * occur in the stepped game.
+ *
+ * @tparam kick Agents can kick bombs. If disabled, canKick is ignored and all
+ * bombs have to be idle.
+ * @tparam teams Agents can be in teams. If disabled, all agents have team 0.
+ * @tparam partialObservability Agents can be invisible and the board can
+ * contain fog. If disabled, all agents are visible.
+ */
+template<bool kick, bool teams, bool partialObservability>
+struct StepRules
+{
+    static constexpr bool Kick = kick;
+    static constexpr bool Teams = teams;
+    static constexpr bool PartialObservability = partialObservability;
+};
+
+/**
+ * @brief The rules of State::Step, all features are enabled.
+ */
+using DefaultRules = StepRules<true, true, true>;
+
+/**
+ * @brief Fully observable free-for-all games without kicking.
+ */
+using NoKickFreeForAllRules = StepRules<false, false, false>;
+
 /**
  * @brief Gets the ID of the teammate in four player team game modes.
  * @param agentID An agent id
@@ -706,6 +1159,338 @@ inline int GetTeammateID(int agentID)
  */
 void SetTeams(AgentInfo agents[AGENT_COUNT], GameMode gameMode);
 
+/**
+ * @brief GenerateBoard Generates the board items of State::Init (without
+ * the agents). See State::Init for the parameters.
+ * @param items The generated items
+ */
+void GenerateBoard(int items[BOARD_SIZE][BOARD_SIZE], long boardSeed, int numRigid, int numWood, int numPowerUps, int padding, int breathingRoomSize);
+
+/**
+ * Zobrist keys of the state hash. The key of a state is the XOR of
+ * - the keys of all items on the board (flame ids are ignored),
+ * - the keys of all flames (depend on their position and remaining lifetime),
+ * - the keys of all agents and bombs.
+ * The time step is not part of the key.
+ */
+namespace zobrist
+{
+
+const int ITEM_KEY_COUNT = 22;
+
+/**
+ * @brief The random keys of the hash. They are computed at compile time, so
+ * they can already be used during the static initialization of other
+ * translation units.
+ */
+struct Keys
+{
+    /**
+     * @brief itemKeys Random keys for all (canonical) items on all cells.
+     * The key of passages is 0.
+     */
+    uint64_t itemKeys[BOARD_SIZE * BOARD_SIZE][ITEM_KEY_COUNT];
+
+    /**
+     * @brief flameKeys Random keys for flames on all cells. They are rotated
+     * depending on the remaining lifetime of the flame (see FlameKey).
+     */
+    uint64_t flameKeys[BOARD_SIZE * BOARD_SIZE];
+
+    // salts which distinguish agent and bomb keys from each other
+    uint64_t agentSalts[AGENT_COUNT];
+    uint64_t bombSalt;
+};
+
+extern const Keys keys;
+
+/**
+ * @brief ItemKeyIndex Maps an item to its index in Keys::itemKeys.
+ */
+inline int ItemKeyIndex(int item)
+{
+    if(IS_AGENT(item))
+        return 18 + item - Item::AGENT0;
+    if(IS_FLAME(item))
+        return 14 + FLAME_POWFLAG(item);
+    if(IS_WOOD(item))
+        return 10 + WOOD_POWFLAG(item);
+    return item;
+}
+
+/**
+ * @brief ItemKey Returns the key of the given item at (x, y).
+ */
+inline uint64_t ItemKey(int x, int y, int item)
+{
+    return keys.itemKeys[x + BOARD_SIZE * y][ItemKeyIndex(item)];
+}
+
+/**
+ * @brief FlameKey Returns the key of flames with the given remaining
+ * lifetime. Rotations are linear w.r.t. XOR, so cellKeys can also be
+ * the XOR of the flame keys of several cells.
+ */
+inline uint64_t FlameKey(uint64_t cellKeys, int timeLeft)
+{
+    const int r = 17 * timeLeft;
+    return (cellKeys << r) | (cellKeys >> (64 - r));
+}
+
+/**
+ * @brief AgentKey Returns the key of the agent with the given id.
+ */
+uint64_t AgentKey(int id, const AgentInfo& info);
+
+/**
+ * @brief BombKey Returns the key of a single bomb.
+ */
+uint64_t BombKey(Bomb bomb);
+
+}
+
+/**
+ * @brief Records the changes of a single step, which allows to undo the step.
+ * Cells, agents, flames and the entries of the bomb and flame indices are
+ * recorded when they are modified for the first time. The timers of all bombs
+ * change in every step, so the alive bombs are copied as a whole. Scalar
+ * members are always copied. See State::StepRecorded and State::Undo.
+ */
+struct StepJournal
+{
+    /**
+     * @brief touched The cells which have already been recorded.
+     */
+    BitPlane touched;
+
+    /**
+     * @brief cellCount The number of recorded cells.
+     */
+    int cellCount = 0;
+
+    /**
+     * @brief cells The recorded cell indices (x + BOARD_SIZE * y).
+     */
+    int cells[BOARD_SIZE * BOARD_SIZE];
+
+    /**
+     * @brief oldItems The items of the recorded cells before the step.
+     */
+    int oldItems[BOARD_SIZE * BOARD_SIZE];
+
+    // the recorded agents (bit i of agentMask is set if agent i is recorded)
+    uint8_t agentMask = 0;
+    int agentCount = 0;
+    int agentIDs[AGENT_COUNT];
+    AgentInfo oldAgents[AGENT_COUNT];
+
+    // the alive bombs, they are restored at their original slots
+    int bombIndex;
+    int bombCount;
+    Bomb bombs[MAX_BOMBS];
+
+    // the recorded entries of Board::bombSlots
+    BitPlane bombSlotsTouched;
+    int bombSlotCount = 0;
+    int bombSlotCells[BOARD_SIZE * BOARD_SIZE];
+    int8_t oldBombSlots[BOARD_SIZE * BOARD_SIZE];
+
+    // the flame queue, only the recorded slots of the queue are restored
+    int flameIndex;
+    int flameCount;
+    int flameBuckets[FLAME_LIFETIME];
+    BitPlane flamesTouched;
+    int flameRecordCount = 0;
+    int flameQueueSlots[BOARD_SIZE * BOARD_SIZE];
+    Flame oldFlames[BOARD_SIZE * BOARD_SIZE];
+
+    // the recorded entries of Board::flameSlots
+    BitPlane flameSlotsTouched;
+    int flameSlotCount = 0;
+    int flameSlotCells[BOARD_SIZE * BOARD_SIZE];
+    CellIndex oldFlameSlots[BOARD_SIZE * BOARD_SIZE];
+
+    int timeStep;
+    int currentFlameTime;
+    bool finished;
+    bool isDraw;
+    int winningTeam;
+    int winningAgent;
+    int aliveAgents;
+
+    uint64_t hash;
+    uint64_t flameGroupKeys[FLAME_LIFETIME];
+    uint64_t agentKeys[AGENT_COUNT];
+    uint64_t bombKeys;
+
+    /**
+     * @brief RecordCell Remembers the item of a cell before it is modified.
+     */
+    inline void RecordCell(int x, int y, int oldItem)
+    {
+        const int cell = x + BOARD_SIZE * y;
+        if(touched.Test(cell))
+            return;
+
+        touched.Set(cell);
+        cells[cellCount] = cell;
+        oldItems[cellCount] = oldItem;
+        cellCount++;
+    }
+
+    /**
+     * @brief RecordAgent Remembers an agent before it is modified.
+     */
+    inline void RecordAgent(int id, const AgentInfo& oldAgent)
+    {
+        if(agentMask & (1 << id))
+            return;
+
+        agentMask |= 1 << id;
+        agentIDs[agentCount] = id;
+        oldAgents[agentCount] = oldAgent;
+        agentCount++;
+    }
+
+    /**
+     * @brief RecordBombSlot Remembers an entry of Board::bombSlots before
+     * it is modified.
+     */
+    inline void RecordBombSlot(int cell, int8_t oldSlot)
+    {
+        if(bombSlotsTouched.Test(cell))
+            return;
+
+        bombSlotsTouched.Set(cell);
+        bombSlotCells[bombSlotCount] = cell;
+        oldBombSlots[bombSlotCount] = oldSlot;
+        bombSlotCount++;
+    }
+
+    /**
+     * @brief RecordFlame Remembers a slot of the flame queue before it is
+     * modified.
+     */
+    inline void RecordFlame(int slot, const Flame& oldFlame)
+    {
+        if(flamesTouched.Test(slot))
+            return;
+
+        flamesTouched.Set(slot);
+        flameQueueSlots[flameRecordCount] = slot;
+        oldFlames[flameRecordCount] = oldFlame;
+        flameRecordCount++;
+    }
+
+    /**
+     * @brief RecordFlameSlot Remembers an entry of Board::flameSlots before
+     * it is modified.
+     */
+    inline void RecordFlameSlot(int cell, CellIndex oldSlot)
+    {
+        if(flameSlotsTouched.Test(cell))
+            return;
+
+        flameSlotsTouched.Set(cell);
+        flameSlotCells[flameSlotCount] = cell;
+        oldFlameSlots[flameSlotCount] = oldSlot;
+        flameSlotCount++;
+    }
+};
+
+/**
+ * @brief The types of events which can happen during a step.
+ */
+enum class StepEventType : uint8_t
+{
+    // agent: the killed agent, source: the owner of the bomb whose explosion
+    // killed the agent (-1 if the agent walked into existing flames)
+    AgentKilled,
+    // agent: the owner of the bomb, position: the position of the bomb
+    BombExploded,
+    // agent: the owner of the bomb which destroyed the wood,
+    // value: the revealed powerup (Item::PASSAGE if there is none)
+    WoodDestroyed,
+    // agent: the collecting agent, value: the powerup
+    PowerupCollected,
+    // agent: the kicking agent, source: the owner of the bomb,
+    // value: the direction of the bomb, position: the position of the bomb
+    BombKicked
+};
+
+/**
+ * @brief A single event of a step (see StepEventType).
+ */
+struct StepEvent
+{
+    StepEventType type;
+    int8_t agent;
+    int8_t source;
+    int8_t value;
+    Position position;
+
+    /**
+     * @brief timeStep The time step of the state before the step.
+     */
+    int timeStep;
+};
+
+const int STEP_EVENTS_CAPACITY = 128;
+
+/**
+ * @brief A ring buffer of the events of one or more steps. It is filled by
+ * the step function while it is set as State::activeEvents, so consumers
+ * do not have to compare the states before and after a step. When the
+ * buffer is full, the oldest events are overwritten.
+ */
+struct StepEvents
+{
+    FixedQueue<StepEvent, STEP_EVENTS_CAPACITY> events;
+
+    /**
+     * @brief dropped The number of overwritten events since the last Clear.
+     */
+    int dropped = 0;
+
+    /**
+     * @brief explodingBombOwner The owner of the bomb which currently
+     * explodes (-1 outside of explosions). Used to attribute kills and
+     * destroyed wood.
+     */
+    int explodingBombOwner = -1;
+
+    inline void Clear()
+    {
+        events.index = 0;
+        events.count = 0;
+        dropped = 0;
+        explodingBombOwner = -1;
+    }
+
+    inline int Count() const
+    {
+        return events.count;
+    }
+
+    /**
+     * @brief Returns the i-th oldest event.
+     */
+    inline const StepEvent& operator[](int i) const
+    {
+        return events[i];
+    }
+
+    inline void Add(StepEventType type, int agent, int source, int value, Position position, int timeStep)
+    {
+        if(events.count == STEP_EVENTS_CAPACITY)
+        {
+            events.PopElem();
+            dropped++;
+        }
+        events.AddElem({type, (int8_t)agent, (int8_t)source, (int8_t)value, position, timeStep});
+    }
+};
+
 /**
  * @brief Holds all information about the game state and provides member functions to initialize the board and execute steps.
  */
@@ -738,6 +1523,54 @@ public:
      */
     int aliveAgents = AGENT_COUNT;
 
+    /**
+     * @brief hash The Zobrist key of this state. It is updated incrementally
+     * by the step function and by all functions which modify the state
+     * during a step. Call RecomputeHash after modifying the state directly.
+     */
+    uint64_t hash = 0;
+
+    /**
+     * @brief flameGroupKeys The XOR of the flame keys of all flames with
+     * remaining lifetime t + 1. Allows to update the keys of all flames
+     * at once when their lifetime decreases.
+     */
+    uint64_t flameGroupKeys[FLAME_LIFETIME] = {};
+
+    /**
+     * @brief agentKeys The keys of the agents which are part of the hash.
+     */
+    uint64_t agentKeys[AGENT_COUNT] = {};
+
+    /**
+     * @brief bombKeys The XOR of the keys of all bombs which is part of the hash.
+     */
+    uint64_t bombKeys = 0;
+
+    /**
+     * @brief activeJournal Records all modifications of the state while it is set
+     * (only during StepRecorded).
+     */
+    StepJournal* activeJournal = nullptr;
+
+    /**
+     * @brief activeEvents Receives the events of all steps while it is set
+     * (see StepEvents). The events are not cleared by the step function.
+     */
+    StepEvents* activeEvents = nullptr;
+
+    /**
+     * @brief dirtyCells The cells which have been modified since the
+     * beginning of the last step (see Observation::Update).
+     */
+    BitPlane dirtyCells;
+
+    /**
+     * @brief dirtyBaseHash The hash of the state before the last step,
+     * dirtyCells contains the modifications since this state.
+     */
+    uint64_t dirtyBaseHash = 0;
+
     /**
      * @brief Init Initializes the state and puts boxes, rigid objects, powerups and agents on the board.
      * @param boardSeed The random seed for the item generator.
@@ -748,7 +1581,17 @@ public:
      * @param padding The padding of the agents to the walls.
      * @param breathingRoomSize The size of the "breathing room" between agents.
      */
-    void Init(GameMode gameMode, long boardSeed, long agentPositionSeed, int numRigid = 36, int numWood = 36, int numPowerUps = 20, int padding = 1, int breathingRoomSize = 3);
+    void Init(GameMode gameMode, long boardSeed, long agentPositionSeed, int numRigid = DEFAULT_NUM_RIGID, int numWood = DEFAULT_NUM_WOOD, int numPowerUps = DEFAULT_NUM_POWERUPS, int padding = 1, int breathingRoomSize = 3);
+
+    /**
+     * @brief InitFromBoard Same as Init, but copies a board which has been
+     * generated before (see GenerateBoard and BoardCache) instead of
+     * generating it. Does not allocate memory.
+     * @param board The generated board items
+     * @param agentPositionSeed See Init
+     * @param padding The padding which has been used to generate the board
+     */
+    void InitFromBoard(GameMode gameMode, const int board[BOARD_SIZE][BOARD_SIZE], long agentPositionSeed, int padding = 1);
 
     /**
      * @brief Execute a step using the given moves.
@@ -758,20 +1601,152 @@ public:
     void Step(Move* moves);
 
     /**
-     * @brief Puts a bomb at the agent's position if it has enough available bombs.
+     * @brief StepT Executes a step using the given moves and a compile-time
+     * rule set (see StepRules). Step is the same as StepT<DefaultRules>.
+     * Instantiated for all combinations of StepRules.
+     *
+     * @param moves The agents' moves
      */
-    template<bool duringStep>
-    inline void TryPutBomb(int id, bool setItem = false)
+    template<typename Rules>
+    void StepT(Move* moves);
+
+    /**
+     * @brief StepAfterFlameTick Executes all phases of StepT<Rules> after the
+     * flames ticked (util::TickFlames). Several steps of the same state can
+     * share the flame tick this way (see GenerateChildren).
+     *
+     * @param moves The agents' moves
+     */
+    template<typename Rules>
+    void StepAfterFlameTick(Move* moves);
+
+    /**
+     * @brief StepRecorded Executes a step using the given moves and records
+     * all changes in the given journal, so that the step can be reverted
+     * with Undo. This allows to search in-place without copying the state.
+     *
+     * @param moves The agents' moves
+     * @param journal The journal which will contain the changes of this step
+     */
+    void StepRecorded(Move* moves, StepJournal& journal);
+
+    /**
+     * @brief Undo Reverts the step which has been recorded in the given journal.
+     * Steps must be reverted in the reverse order of their execution.
+     *
+     * @param journal The journal of the last step
+     */
+    void Undo(const StepJournal& journal);
+
+    /**
+     * @brief SetItem Overrides the item at the given position and updates the hash.
+     */
+    inline void SetItem(int x, int y, int item)
     {
-        AgentInfo& agent = agents[id];
-        if(agent.bombCount >= agent.maxBombCount || HasBomb(agent.x, agent.y))
-            return;
+        if(activeJournal != nullptr)
+            activeJournal->RecordCell(x, y, items[y][x]);
+
+        dirtyCells.Set(x + BOARD_SIZE * y);
+
+        hash ^= zobrist::ItemKey(x, y, items[y][x]) ^ zobrist::ItemKey(x, y, item);
+        items[y][x] = item;
+    }
 
-        // when we plant a bomb during the step function, we need to increment the bomb lifetime by 1
-        // because all bomb lifetimes will be decremented at the end of this step
-        PutBomb(agent.x, agent.y, id, agent.bombStrength, BOMB_LIFETIME + (duringStep ? 1 : 0), setItem);
+    /**
+     * @brief SetAgentPosition Sets the position of the given agent without
+     * modifying the items (see Board::SetAgentPosition).
+     */
+    inline void SetAgentPosition(int agentID, int x, int y)
+    {
+        // agents which keep their position are not recorded
+        const AgentInfo& a = agents[agentID];
+        if(activeJournal != nullptr && (a.x != x || a.y != y))
+            activeJournal->RecordAgent(agentID, a);
+
+        Board::SetAgentPosition(agentID, x, y);
     }
 
+    /**
+     * @brief RecordFlame Records the flame at the given index of the flame
+     * queue in the active journal (if there is one) before it is modified.
+     */
+    inline void RecordFlame(int index)
+    {
+        if(activeJournal != nullptr)
+        {
+            const int slot = (flames.index + index) % (BOARD_SIZE * BOARD_SIZE);
+            activeJournal->RecordFlame(slot, flames.queue[slot]);
+        }
+    }
+
+    /**
+     * @brief ResetDirtyCells Starts tracking the modified cells of the
+     * next step (called at the beginning of every step).
+     */
+    inline void ResetDirtyCells()
+    {
+        dirtyCells.Reset();
+        dirtyBaseHash = hash;
+    }
+
+    /**
+     * @brief RecordEvent Adds an event to the active events (if there are any).
+     */
+    inline void RecordEvent(StepEventType type, int agent, int source, int value, Position position)
+    {
+        if(activeEvents != nullptr)
+            activeEvents->Add(type, agent, source, value, position, timeStep);
+    }
+
+    /**
+     * @brief ComputeHash Computes the Zobrist key of this state from scratch.
+     */
+    uint64_t ComputeHash() const;
+
+    /**
+     * @brief RecomputeHash Sets the hash (and all partial keys) to the
+     * result of a full recomputation.
+     */
+    void RecomputeHash();
+
+    /**
+     * @brief RehashAgent Updates the key of the given agent in the hash.
+     */
+    inline void RehashAgent(int id)
+    {
+        const uint64_t key = zobrist::AgentKey(id, agents[id]);
+        hash ^= agentKeys[id] ^ key;
+        agentKeys[id] = key;
+    }
+
+    /**
+     * @brief RehashAgentsAndBombs Updates the keys of all agents and bombs
+     * in the hash. Bombs and agents are modified in many places during a
+     * step (movement, timers, powerups), so they are re-keyed at its end.
+     */
+    void RehashAgentsAndBombs();
+
+    /**
+     * @brief PutBomb Puts a bomb on the board and updates the hash.
+     * See Board::PutBomb.
+     */
+    void PutBomb(int x, int y, int agentID, int strength, int lifeTime, bool setItem);
+
+    /**
+     * @brief MoveBomb Moves a bomb and updates the journal (see Board::MoveBomb).
+     */
+    void MoveBomb(int index, Position pos);
+
+    /**
+     * @brief RemoveBomb Removes a bomb and updates the journal (see Board::RemoveBomb).
+     */
+    void RemoveBomb(int index);
+
+    /**
+     * @brief RemoveFlame Removes a flame and updates the journal (see Board::RemoveFlame).
+     */
+    void RemoveFlame(int index);
+
     /**
      * @brief ExplodeTopBomb Explodes the bomb at the the specified index
      * of the queue and spawns flames.
@@ -835,6 +1810,9 @@ public:
 
 
     void Print(bool clearConsole = false) const override;
+
+private:
+    void _initAgents(GameMode gameMode, long agentPositionSeed, int padding);
 };
 
 /**
@@ -879,9 +1857,15 @@ struct ObservationParameters
 class Observation : public Board
 {
 public:
-    int agentID;
+    int agentID = -1;
     ObservationParameters params;
 
+    /**
+     * @brief sourceHash The hash of the state this observation has been
+     * created from.
+     */
+    uint64_t sourceHash = 0;
+
     /**
      * @brief Creates an observation for some agent based on a state.
      * 
@@ -892,6 +1876,32 @@ public:
      */
     static void Get(const State& state, const uint agentID, const ObservationParameters obsParams, Observation& observation);
 
+    /**
+     * @brief Creates the observations of all agents. This is the same as
+     * calling Get for every agent, but the work which is shared between
+     * the agents (erasing powerups, filtering bombs and flames) is only
+     * done once.
+     *
+     * @param state The current state of the environment
+     * @param obsParams The parameters which define which information the observations will contain
+     * @param observations The objects which will be used to save the observations
+     */
+    static void GetAll(const State& state, const ObservationParameters obsParams, Observation observations[AGENT_COUNT]);
+
+    /**
+     * @brief Updates this observation (created with Get or Update for the
+     * same agent and parameters) to the given state. If the observation has
+     * been created from the state before its last step, only the modified
+     * cells (see State::dirtyCells) and the cells which enter or leave the
+     * view of the agent are updated. Otherwise, this is the same as Get.
+     * Note that cells which are modified without State::SetItem are not
+     * tracked. Use GetAll to create the observations of all agents, it is
+     * faster than updating every observation.
+     *
+     * @param state The current state of the environment
+     */
+    void Update(const State& state);
+
     /**
      * @brief Converts this observation to a (potentially incomplete) state. This allows you to execute steps on that observation. 
      * If an agent's stats are not visible in this observation, the stats from the given state are used instead. 
@@ -919,8 +1929,10 @@ public:
      * Warning: is a simple heuristic. Even in the FFA environment, it is impossible to track all stats in all cases.
      * 
      * @param oldBoard The last board holding previous state information (can be observation or state).
+     * @param backtrackingErrors Optional counter, is incremented for every bomb whose previous position
+     * (and therefore its owner) could not be found in oldBoard.
      */
-    void TrackStats(const Board& oldBoard);
+    void TrackStats(const Board& oldBoard, int* backtrackingErrors = nullptr);
 
     void Print(bool clearConsole = false) const override;
 };
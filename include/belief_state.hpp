@@ -0,0 +1,117 @@
+#ifndef BELIEF_STATE_H
+#define BELIEF_STATE_H
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "bboard.hpp"
+
+namespace bboard
+{
+
+/**
+ * @brief A particle filter over the full states which are consistent with
+ * the observations of one agent.
+ *
+ * Every particle is a determinized State: cells which have never been
+ * seen are sampled (rigid, wood or passage), hidden powerups are assigned
+ * to wood and agents outside of the view are placed on free cells. With
+ * every observation, the hidden agents of each particle do a random move
+ * outside of the view and the observation is merged into the particle
+ * with Observation::VirtualStep. Particles which contradict the
+ * observation (a hidden agent would have been seen) are replaced by
+ * copies of consistent particles.
+ *
+ * All particles and samples are allocated in the constructor, Update and
+ * Sample do not allocate memory.
+ *
+ * Note: bombs which have never been seen are not sampled.
+ */
+class BeliefState
+{
+public:
+    /**
+     * @param particleCount The number of particles
+     * @param sampleCount The number of samples in the pool of Sample()
+     * @param seed The seed of the random number generator
+     */
+    explicit BeliefState(int particleCount, int sampleCount = 64, long seed = 0);
+
+    /**
+     * @brief Reset Creates new particles from the first observation of
+     * an episode.
+     */
+    void Reset(const Observation& obs);
+
+    /**
+     * @brief Update Advances all particles to the given observation (the
+     * observation after the last one). Falls back to Reset if the
+     * observation belongs to another agent.
+     */
+    void Update(const Observation& obs);
+
+    /**
+     * @brief Sample Copies a random particle into the next state of the
+     * sample pool and returns it. The state stays valid until the pool
+     * wraps around (after sampleCount calls).
+     */
+    State& Sample();
+
+    /**
+     * @brief Sample Copies a random particle into the given state.
+     */
+    void Sample(State& state);
+
+    /**
+     * @brief GetParticleCount Returns the number of particles.
+     */
+    int GetParticleCount() const;
+
+    /**
+     * @brief GetParticle Returns the i-th particle.
+     */
+    const State& GetParticle(int i) const;
+
+    /**
+     * @brief GetReference Returns the state which has been reconstructed
+     * with Observation::VirtualStep (contains fog).
+     */
+    const State& GetReference() const;
+
+    /**
+     * @brief GetResampleCount Returns the number of particles which have
+     * been replaced in the last update.
+     */
+    int GetResampleCount() const;
+
+private:
+    std::vector<State> particles;
+    std::vector<State> samples;
+    int nextSample = 0;
+
+    // the hidden powerup flags of the cells of all particles
+    std::unique_ptr<uint8_t[]> powerups;
+
+    std::unique_ptr<State> reference;
+    std::vector<int> consistent;
+    int agentID = -1;
+    int resampleCount = 0;
+
+    std::mt19937 rng;
+    std::uniform_real_distribution<float> uniform;
+    std::uniform_int_distribution<int> choosePowerup;
+
+    // the probabilities of unseen cells
+    float pRigid = 0, pWood = 0, pPowerup = 0;
+
+    void _computePriors(const Observation& obs);
+    void _determinize(int p, const Observation& obs);
+    void _moveHiddenAgents(State& s, const Observation& obs);
+    void _assignPowerups(int p, const Observation& obs);
+};
+
+}
+
+#endif // BELIEF_STATE_H
@@ -0,0 +1,407 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <cstdint>
+#include <string>
+#include <stdexcept>
+
+#include "bboard.hpp"
+
+namespace bboard
+{
+
+static_assert (BOARD_SIZE < 64, "Rows must fit into a single 64-bit word");
+static_assert (AGENT_COUNT <= 8, "The agents of a cell must fit into a byte");
+
+/**
+ * @brief operator~ The complement of a plane (restricted to the board)
+ */
+inline BitPlane operator~(const BitPlane& a)
+{
+    BitPlane r;
+    for(int i = 0; i < PLANE_WORDS; i++)
+        r.words[i] = ~a.words[i];
+    r.words[PLANE_WORDS - 1] &= LAST_WORD_MASK;
+    return r;
+}
+
+/**
+ * @brief ShiftUp Moves all cells to higher indices (0 < n < 64). Bits
+ * which leave the board are discarded.
+ */
+inline BitPlane ShiftUp(const BitPlane& a, int n)
+{
+    BitPlane r;
+    r.words[0] = a.words[0] << n;
+    for(int i = 1; i < PLANE_WORDS; i++)
+        r.words[i] = (a.words[i] << n) | (a.words[i - 1] >> (64 - n));
+    r.words[PLANE_WORDS - 1] &= LAST_WORD_MASK;
+    return r;
+}
+
+/**
+ * @brief ShiftDown Moves all cells to lower indices (0 < n < 64).
+ */
+inline BitPlane ShiftDown(const BitPlane& a, int n)
+{
+    BitPlane r;
+    for(int i = 0; i < PLANE_WORDS - 1; i++)
+        r.words[i] = (a.words[i] >> n) | (a.words[i + 1] << (64 - n));
+    r.words[PLANE_WORDS - 1] = a.words[PLANE_WORDS - 1] >> n;
+    return r;
+}
+
+/**
+ * @brief ColumnPlane Returns the plane which contains all cells of column x.
+ */
+constexpr BitPlane ColumnPlane(int x)
+{
+    BitPlane p;
+    for(int y = 0; y < BOARD_SIZE; y++)
+    {
+        int index = x + BOARD_SIZE * y;
+        p.words[index >> 6] |= uint64_t(1) << (index & 63);
+    }
+    return p;
+}
+
+/**
+ * @brief Shift Moves every cell of the plane by one position in the
+ * given direction. Cells which leave the board are discarded (no wrap-around).
+ */
+inline BitPlane Shift(const BitPlane& a, Direction d)
+{
+    constexpr BitPlane firstColumn = ColumnPlane(0);
+    constexpr BitPlane lastColumn = ColumnPlane(BOARD_SIZE - 1);
+
+    switch(d)
+    {
+        case Direction::RIGHT: return ShiftUp(a & ~lastColumn, 1);
+        case Direction::LEFT:  return ShiftDown(a & ~firstColumn, 1);
+        case Direction::DOWN:  return ShiftUp(a, BOARD_SIZE);
+        case Direction::UP:    return ShiftDown(a, BOARD_SIZE);
+        default:               return a;
+    }
+}
+
+/**
+ * @brief A fully observable game state which stores the items of the board as
+ * bit planes (one bit per cell). Agents and bombs are stored the same way as
+ * in State, flames are grouped by their remaining lifetime.
+ *
+ * The movement of agents and bombs is executed by the same step pipeline
+ * as State::Step (see step_utility.hpp), explosions are computed on whole
+ * planes. Stepping a BitBoard yields the same game as stepping the
+ * corresponding State.
+ */
+class BitBoard
+{
+public:
+    BitPlane rigid;
+    BitPlane wood;
+
+    /**
+     * @brief powerUps powerUps[f - 1] holds all powerups with pow-flag f.
+     * Includes powerups which are hidden below wood and flames.
+     */
+    BitPlane powerUps[3];
+
+    /**
+     * @brief bombItems Cells which show a bomb (bombs below agents are not included)
+     */
+    BitPlane bombItems;
+
+    /**
+     * @brief flames flames[t] holds all flames which burn for t + 1 more steps
+     */
+    BitPlane flames[FLAME_LIFETIME];
+
+    /**
+     * @brief burning The union of all flame planes
+     */
+    BitPlane burning;
+
+    /**
+     * @brief woodFlames Flames which destroyed a wooden box
+     */
+    BitPlane woodFlames;
+
+    /**
+     * @brief agentItems agentItems[i] is the cell which shows agent i (if any)
+     */
+    BitPlane agentItems[AGENT_COUNT];
+
+    AgentInfo agents[AGENT_COUNT];
+    FixedQueue<Bomb, MAX_BOMBS> bombs;
+
+    /**
+     * @brief agentMasks Bit i of agentMasks[c] is set if the alive agent i
+     * is at cell c (agents can share a cell while they are moved).
+     */
+    uint8_t agentMasks[CELL_COUNT] = {};
+
+    /**
+     * @brief bombCounts The number of bombs at every cell (bombs can share
+     * a cell while they are moved).
+     */
+    uint8_t bombCounts[CELL_COUNT] = {};
+
+    int timeStep = -1;
+    bool finished = false;
+    bool isDraw = false;
+    int winningTeam = 0;
+    int winningAgent = -1;
+    int aliveAgents = AGENT_COUNT;
+
+    /**
+     * @brief FromBoard Loads the items, agents, bombs and flames of the
+     * given board. Fog is not supported.
+     */
+    void FromBoard(const Board& board);
+
+    /**
+     * @brief FromState Loads the given state (including the game status).
+     */
+    void FromState(const State& state);
+
+    /**
+     * @brief ToBoard Writes this board into the given board. The flames are
+     * written as optimized flame queue (ordered by their lifetime, then by
+     * their position).
+     */
+    void ToBoard(Board& board) const;
+
+    /**
+     * @brief ToState Writes this board and the game status into the given state.
+     */
+    void ToState(State& state) const;
+
+    /**
+     * @brief Step Executes a step using the given moves (see State::Step).
+     */
+    void Step(const Move* moves);
+
+    /**
+     * @brief GetItem Returns the item at the given position (flames do not
+     * contain flame ids).
+     */
+    int GetItem(int x, int y) const;
+
+    /**
+     * @brief SetItem Overrides the item at the given position. Flames
+     * and fog can't be set this way.
+     */
+    void SetItem(int x, int y, int item);
+
+    /**
+     * @brief GetAgent Returns the index of the alive agent at the
+     * given position. -1 if no agent is there
+     */
+    inline int GetAgent(int x, int y) const
+    {
+        const uint8_t mask = agentMasks[BitPlane::Index(x, y)];
+        return mask == 0 ? -1 : CountTrailingZeros(mask);
+    }
+
+    /**
+     * @brief SetAgentPosition Sets the position of the given agent without
+     * modifying the items (see Board::SetAgentPosition).
+     */
+    inline void SetAgentPosition(int agentID, int x, int y)
+    {
+        AgentInfo& a = agents[agentID];
+        _toggleAgentMask(agentID);
+        a.x = x;
+        a.y = y;
+        _toggleAgentMask(agentID);
+    }
+
+    /**
+     * @brief HasBomb Returns true if a bomb is at the specified position
+     */
+    inline bool HasBomb(int x, int y) const
+    {
+        return bombCounts[BitPlane::Index(x, y)] != 0;
+    }
+
+    /**
+     * @brief PutBomb Puts a bomb at the specified position and adds one
+     * to the agent's bomb count (see Board::PutBomb).
+     */
+    inline void PutBomb(int x, int y, int agentID, int strength, int lifeTime, bool setItem)
+    {
+        bombs.AddElem(CreateBomb(agentID, x, y, strength, lifeTime));
+        bombCounts[BitPlane::Index(x, y)]++;
+        agents[agentID].bombCount++;
+
+        if(setItem)
+        {
+            SetItem(x, y, Item::BOMB);
+        }
+    }
+
+    /**
+     * @brief MoveBomb Moves the bomb at the specified index of the
+     * bomb queue to the given position.
+     */
+    inline void MoveBomb(int index, Position pos)
+    {
+        Bomb& b = bombs[index];
+        bombCounts[BitPlane::Index(BMB_POS_X(b), BMB_POS_Y(b))]--;
+        bombCounts[BitPlane::Index(pos.x, pos.y)]++;
+        SetBombPosition(b, pos);
+    }
+
+    /**
+     * @brief RemoveBomb Removes the bomb at the specified index of the
+     * bomb queue.
+     */
+    inline void RemoveBomb(int index)
+    {
+        const Bomb b = bombs[index];
+        bombCounts[BitPlane::Index(BMB_POS_X(b), BMB_POS_Y(b))]--;
+        if(index == 0)
+        {
+            bombs.PopElem();
+        }
+        else
+        {
+            bombs.RemoveAt(index);
+        }
+    }
+
+    /**
+     * @brief ExplodeBombAt Explodes the bomb at the specified index of the
+     * queue together with all bombs hit by its chain reaction.
+     */
+    void ExplodeBombAt(int index);
+
+    /**
+     * @brief TickFlames Counts down all flames and extinguishes the flames
+     * which burnt out.
+     */
+    void TickFlames();
+
+    /**
+     * @brief Kill Kill some agent on this board.
+     * @param agentID The id of the agent
+     */
+    void Kill(const int agentID);
+
+    /**
+     * @brief EventBombExploded Called when a bomb explodes.
+     * @param b The bomb which explodes.
+     */
+    void EventBombExploded(Bomb b);
+
+private:
+    void _spawnFlames(const BitPlane& blast);
+
+    /**
+     * @brief _toggleAgentMask Adds (or removes) the given agent to the mask
+     * of its cell, dead agents and agents outside the board are ignored.
+     */
+    inline void _toggleAgentMask(int agentID)
+    {
+        const AgentInfo& a = agents[agentID];
+        if(!a.dead && a.x >= 0 && a.x < BOARD_SIZE && a.y >= 0 && a.y < BOARD_SIZE)
+            agentMasks[BitPlane::Index(a.x, a.y)] ^= uint8_t(1) << agentID;
+    }
+};
+
+inline int BitBoard::GetItem(int x, int y) const
+{
+    // all planes are tested at the same word and bit
+    const int index = BitPlane::Index(x, y);
+    const int word = index >> 6;
+    const uint64_t bit = uint64_t(1) << (index & 63);
+    auto test = [word, bit](const BitPlane& p)
+    {
+        return (p.words[word] & bit) != 0;
+    };
+
+    for(int i = 0; i < AGENT_COUNT; i++)
+    {
+        if(test(agentItems[i]))
+            return Item::AGENT0 + i;
+    }
+    if(test(bombItems))
+        return Item::BOMB;
+    if(test(rigid))
+        return Item::RIGID;
+
+    int powFlag = 0;
+    for(int f = 0; f < 3; f++)
+    {
+        if(test(powerUps[f]))
+            powFlag = f + 1;
+    }
+
+    if(test(wood))
+        return Item::WOOD + powFlag;
+    if(test(burning))
+        return Item::FLAME + powFlag;
+    return Board::FlagItem(powFlag);
+}
+
+inline void BitBoard::SetItem(int x, int y, int item)
+{
+    const int index = BitPlane::Index(x, y);
+
+    // remove everything from this cell
+    const int word = index >> 6;
+    const uint64_t keep = ~(uint64_t(1) << (index & 63));
+    auto reset = [word, keep](BitPlane& p)
+    {
+        p.words[word] &= keep;
+    };
+
+    reset(rigid);
+    reset(wood);
+    reset(bombItems);
+    reset(woodFlames);
+    reset(burning);
+    for(int f = 0; f < 3; f++)
+        reset(powerUps[f]);
+    for(int t = 0; t < FLAME_LIFETIME; t++)
+        reset(flames[t]);
+    for(int i = 0; i < AGENT_COUNT; i++)
+        reset(agentItems[i]);
+
+    if(IS_AGENT(item))
+    {
+        agentItems[item - Item::AGENT0].Set(index);
+    }
+    else if(IS_WOOD(item))
+    {
+        wood.Set(index);
+        if(WOOD_POWFLAG(item) != 0)
+            powerUps[WOOD_POWFLAG(item) - 1].Set(index);
+    }
+    else if(IS_POWERUP(item))
+    {
+        powerUps[Board::ItemFlag(Item(item)) - 1].Set(index);
+    }
+    else if(item == Item::BOMB)
+    {
+        bombItems.Set(index);
+    }
+    else if(item == Item::RIGID)
+    {
+        rigid.Set(index);
+    }
+    else if(item != Item::PASSAGE)
+    {
+        throw std::runtime_error("BitBoard::SetItem does not support item " + std::to_string(item));
+    }
+}
+
+bool operator==(const BitBoard& a, const BitBoard& b);
+inline bool operator!=(const BitBoard& a, const BitBoard& b)
+{
+    return !(a == b);
+}
+
+}
+
+#endif // BITBOARD_H
@@ -0,0 +1,146 @@
+#ifndef BOARD_GENERATOR_H
+#define BOARD_GENERATOR_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "bboard.hpp"
+#include "rollout_engine.hpp"
+
+namespace bboard
+{
+
+/**
+ * @brief The parameters of State::Init which determine the board.
+ */
+struct BoardKey
+{
+    int64_t boardSeed = 0;
+    int32_t numRigid = DEFAULT_NUM_RIGID;
+    int32_t numWood = DEFAULT_NUM_WOOD;
+    int32_t numPowerUps = DEFAULT_NUM_POWERUPS;
+    int32_t padding = 1;
+    int32_t breathingRoomSize = 3;
+
+    // unused, keeps the layout free of implicit padding bytes
+    int32_t reserved = 0;
+};
+
+bool operator<(const BoardKey& a, const BoardKey& b);
+bool operator==(const BoardKey& a, const BoardKey& b);
+
+/**
+ * @brief A generated board and its parameters.
+ */
+struct CachedBoard
+{
+    BoardKey key;
+    int items[BOARD_SIZE][BOARD_SIZE];
+};
+
+/**
+ * @brief A contiguous array of generated boards which is sorted by their
+ * keys. The file format of Save is the header followed by the array, so
+ * Load maps the file into memory instead of reading it.
+ */
+class BoardCache
+{
+public:
+    BoardCache() = default;
+
+    /**
+     * @brief Creates a cache of the given boards (duplicate keys are removed).
+     */
+    explicit BoardCache(std::vector<CachedBoard> boards);
+    ~BoardCache();
+
+    BoardCache(BoardCache&& other) noexcept;
+    BoardCache& operator=(BoardCache&& other) noexcept;
+    BoardCache(const BoardCache&) = delete;
+    BoardCache& operator=(const BoardCache&) = delete;
+
+    /**
+     * @brief Size Returns the number of boards.
+     */
+    int Size() const;
+
+    /**
+     * @brief Boards Returns the boards (sorted by their keys).
+     */
+    const CachedBoard* Boards() const;
+
+    /**
+     * @brief Find Returns the board with the given key (nullptr if it is
+     * not in the cache).
+     */
+    const CachedBoard* Find(const BoardKey& key) const;
+
+    /**
+     * @brief Init Initializes the given state like State::Init with the
+     * parameters of the key. Copies the board if it is in the cache,
+     * otherwise the board is generated.
+     *
+     * @return Whether the board was in the cache
+     */
+    bool Init(State& state, GameMode gameMode, const BoardKey& key, long agentPositionSeed) const;
+
+    /**
+     * @brief Save Writes the cache to the given file.
+     */
+    void Save(const std::string& path) const;
+
+    /**
+     * @brief Load Maps the cache in the given file into memory. Throws a
+     * std::runtime_error if the file is not a cache of the current
+     * BOARD_SIZE.
+     */
+    static BoardCache Load(const std::string& path);
+
+private:
+    std::vector<CachedBoard> owned;
+    const CachedBoard* boards = nullptr;
+    int count = 0;
+
+    // the memory mapped file (if the cache has been loaded)
+    void* mapping = nullptr;
+    size_t mappingSize = 0;
+
+    void _release();
+};
+
+/**
+ * @brief Generates many boards in parallel.
+ */
+class BoardGenerator
+{
+public:
+    /**
+     * @param threadCount The number of workers (<= 0 uses all hardware threads)
+     */
+    explicit BoardGenerator(int threadCount = 0);
+
+    /**
+     * @brief Generate Generates the boards of the given keys.
+     */
+    BoardCache Generate(const std::vector<BoardKey>& keys);
+
+    /**
+     * @brief Generate Generates the boards of count consecutive seeds
+     * starting at firstSeed, all other parameters are taken from the
+     * given key.
+     */
+    BoardCache Generate(long firstSeed, int count, const BoardKey& parameters = BoardKey());
+
+    /**
+     * @brief GetThreadCount Returns the number of worker threads.
+     */
+    int GetThreadCount() const;
+
+private:
+    WorkStealingPool pool;
+};
+
+}
+
+#endif // BOARD_GENERATOR_H
@@ -0,0 +1,112 @@
+#ifndef CHILD_GENERATION_H
+#define CHILD_GENERATION_H
+
+#include "bboard.hpp"
+#include "step_utility.hpp"
+
+namespace bboard
+{
+
+/**
+ * @brief MoveClasses Groups the moves of the given mask by their effect on
+ * the agent. All no-op moves (see util::IsNoOpMove) are equivalent to IDLE,
+ * every other move forms its own class.
+ *
+ * @param state The state after the flames ticked
+ * @param agentID The id of the agent
+ * @param mask The moves of the agent
+ * @param classes The resulting classes (disjoint masks)
+ * @return The number of classes
+ */
+template<typename Rules = DefaultRules>
+int MoveClasses(const State& state, int agentID, MoveMask mask, MoveMask classes[ACTION_COUNT])
+{
+    MoveMask idle = 0;
+    int count = 0;
+    for(int m = 0; m < ACTION_COUNT; m++)
+    {
+        const Move move = Move(m);
+        if(!(mask & MoveBit(move)))
+            continue;
+
+        if(util::IsNoOpMove<Rules>(state, agentID, move))
+            idle |= MoveBit(move);
+        else
+            classes[count++] = MoveBit(move);
+    }
+
+    if(idle != 0)
+    {
+        classes[count++] = idle;
+    }
+    return count;
+}
+
+/**
+ * @brief GenerateChildren Calls callback(moves, equivalent, child) for every
+ * child of the given state which can be reached with the given moves.
+ *
+ * The flames tick once for all children. Afterwards, the remaining step is
+ * only executed for one joint action of every combination of move classes
+ * (see MoveClasses), because all moves of a class result in the same child.
+ * The callback receives the executed joint action and the classes of the
+ * moves which result in the same child (a subset of the given masks).
+ * Terminal states have no children.
+ *
+ * @param state The parent state
+ * @param masks The moves of every agent (there are no children if the
+ * mask of some agent is empty)
+ * @param callback A function void(const Move moves[AGENT_COUNT],
+ * const MoveMask equivalent[AGENT_COUNT], const State& child)
+ */
+template<typename Rules = DefaultRules, typename Callback>
+void GenerateChildren(const State& state, const MoveMask masks[AGENT_COUNT], Callback callback)
+{
+    if(state.finished)
+        return;
+
+    std::unique_ptr<State> base = std::make_unique<State>(state);
+    base->ResetDirtyCells();
+    util::TickFlames(base.get());
+
+    MoveMask classes[AGENT_COUNT][ACTION_COUNT];
+    int classCount[AGENT_COUNT];
+    for(int i = 0; i < AGENT_COUNT; i++)
+    {
+        classCount[i] = MoveClasses<Rules>(*base, i, masks[i], classes[i]);
+        if(classCount[i] == 0)
+            return;
+    }
+
+    std::unique_ptr<State> child = std::make_unique<State>();
+    Move moves[AGENT_COUNT];
+    MoveMask equivalent[AGENT_COUNT];
+    int index[AGENT_COUNT] = {};
+    while(true)
+    {
+        for(int i = 0; i < AGENT_COUNT; i++)
+        {
+            equivalent[i] = classes[i][index[i]];
+            // execute the first move of the class
+            moves[i] = Move(CountTrailingZeros(equivalent[i]));
+        }
+
+        *child = *base;
+        child->template StepAfterFlameTick<Rules>(moves);
+        callback((const Move*)moves, (const MoveMask*)equivalent, (const State&)*child);
+
+        // next combination
+        int i = 0;
+        while(i < AGENT_COUNT && ++index[i] == classCount[i])
+        {
+            index[i] = 0;
+            i++;
+        }
+        if(i == AGENT_COUNT)
+            break;
+    }
+}
+
+}
+
+#endif // CHILD_GENERATION_H
@@ -0,0 +1,297 @@
+#ifndef COMPACT_STATE_H
+#define COMPACT_STATE_H
+
+#include <cstdint>
+#include <stdexcept>
+
+#include "bboard.hpp"
+
+namespace bboard
+{
+
+/**
+ * @brief Bit-packed version of AgentInfo (8 bytes instead of 40). The members
+ * have the same names, so the step pipeline can use both.
+ */
+struct CompactAgentInfo
+{
+    // positions are negative for invisible agents
+    int x : BMB_POS_BITS + 1;
+    int y : BMB_POS_BITS + 1;
+    int bombCount : 6;
+    int maxBombCount : 6;
+    int bombStrength : 6;
+    int team : 3;
+    bool dead : 1;
+    bool visible : 1;
+    bool statsVisible : 1;
+    bool canKick : 1;
+
+    inline Position GetPos() const
+    {
+        return {x, y};
+    }
+};
+
+/**
+ * @brief The cell codes of a CompactState. Every cell is stored in a single
+ * byte: the item kind (bits 0-3), the remaining lifetime of a flame (bits 4-5,
+ * 0 if there is no flame) and whether the flame destroyed a wooden box (bit 6).
+ * Flame cells store the powerup below the flame as item kind.
+ */
+namespace cell
+{
+
+const uint8_t KIND_MASK = 0x0F;
+const uint8_t FLAME_SHIFT = 4;
+const uint8_t FLAME_MASK = 0x30;
+const uint8_t WOOD_FLAME = 0x40;
+
+// item kinds
+const uint8_t PASSAGE = 0;
+const uint8_t RIGID = 1;
+// wood with pow-flag f has kind WOOD + f
+const uint8_t WOOD = 2;
+const uint8_t BOMB = 6;
+const uint8_t FOG = 7;
+// the powerup with pow-flag f has kind POWERUP + f
+const uint8_t POWERUP = 7;
+const uint8_t AGENTDUMMY = 11;
+const uint8_t AGENT0 = 12;
+
+/**
+ * @brief FromItem Returns the cell code of the given item. Flames can't be
+ * converted this way.
+ */
+inline uint8_t FromItem(int item)
+{
+    if(IS_AGENT(item))
+        return AGENT0 + (item - Item::AGENT0);
+    if(IS_WOOD(item))
+        return WOOD + WOOD_POWFLAG(item);
+
+    switch(item)
+    {
+        case Item::PASSAGE:    return PASSAGE;
+        case Item::RIGID:      return RIGID;
+        case Item::BOMB:       return BOMB;
+        case Item::FOG:        return FOG;
+        case Item::EXTRABOMB:  return POWERUP + 1;
+        case Item::INCRRANGE:  return POWERUP + 2;
+        case Item::KICK:       return POWERUP + 3;
+        case Item::AGENTDUMMY: return AGENTDUMMY;
+        default: throw std::runtime_error("Cannot convert item " + std::to_string(item) + " to a cell code.");
+    }
+}
+
+/**
+ * @brief PowFlag Returns the pow-flag of the powerup (kind) in the given cell.
+ */
+inline int PowFlag(uint8_t code)
+{
+    const int kind = code & KIND_MASK;
+    if(kind > WOOD && kind <= WOOD + 3)
+        return kind - WOOD;
+    if(kind > POWERUP && kind <= POWERUP + 3)
+        return kind - POWERUP;
+    return 0;
+}
+
+/**
+ * @brief ToItem Returns the item of the given cell code (flames do not
+ * contain flame ids).
+ */
+inline int ToItem(uint8_t code)
+{
+    static const int kindItems[16] = {
+        Item::PASSAGE, Item::RIGID, Item::WOOD, Item::WOOD + 1, Item::WOOD + 2, Item::WOOD + 3,
+        Item::BOMB, Item::FOG, Item::EXTRABOMB, Item::INCRRANGE, Item::KICK, Item::AGENTDUMMY,
+        Item::AGENT0, Item::AGENT1, Item::AGENT2, Item::AGENT3
+    };
+
+    if(code & FLAME_MASK)
+        return Item::FLAME + PowFlag(code);
+
+    return kindItems[code & KIND_MASK];
+}
+
+}
+
+/**
+ * @brief A fully observable game state with a packed memory layout (see
+ * cell::FromItem and CompactAgentInfo). Flames are stored inside the cells,
+ * so there is no flame queue.
+ *
+ * The movement of agents and bombs is executed by the same step pipeline
+ * as State::Step (see step_utility.hpp). Stepping a CompactState yields the
+ * same game as stepping the corresponding State.
+ */
+class CompactState
+{
+public:
+    uint8_t cells[BOARD_SIZE * BOARD_SIZE];
+
+    CompactAgentInfo agents[AGENT_COUNT];
+    FixedQueue<Bomb, MAX_BOMBS> bombs;
+
+    int16_t timeStep = -1;
+    int8_t winningTeam = 0;
+    int8_t winningAgent = -1;
+    int8_t aliveAgents = AGENT_COUNT;
+    bool finished = false;
+    bool isDraw = false;
+
+    /**
+     * @brief FromBoard Loads the items, agents, bombs and flames of the
+     * given board.
+     */
+    void FromBoard(const Board& board);
+
+    /**
+     * @brief FromState Loads the given state (including the game status).
+     */
+    void FromState(const State& state);
+
+    /**
+     * @brief ToBoard Writes this state into the given board. The flames are
+     * written as optimized flame queue (ordered by their lifetime, then by
+     * their position).
+     */
+    void ToBoard(Board& board) const;
+
+    /**
+     * @brief ToState Writes this state and the game status into the given state.
+     */
+    void ToState(State& state) const;
+
+    /**
+     * @brief Step Executes a step using the given moves (see State::Step).
+     */
+    void Step(const Move* moves);
+
+    /**
+     * @brief MoveAgentsAndBombs Executes the movement phase of Step: moves
+     * the agents and bombs, collects powerups and places new bombs. Flames
+     * and bomb timers are not ticked.
+     */
+    void MoveAgentsAndBombs(const Move* moves);
+
+    /**
+     * @brief GetItem Returns the item at the given position (flames do not
+     * contain flame ids).
+     */
+    inline int GetItem(int x, int y) const
+    {
+        return cell::ToItem(cells[x + BOARD_SIZE * y]);
+    }
+
+    /**
+     * @brief SetItem Overrides the item at the given position. Flames
+     * can't be set this way.
+     */
+    inline void SetItem(int x, int y, int item)
+    {
+        cells[x + BOARD_SIZE * y] = cell::FromItem(item);
+    }
+
+    /**
+     * @brief GetAgent Returns the index of the alive agent at the
+     * given position. -1 if no agent is there
+     */
+    int GetAgent(int x, int y) const;
+
+    /**
+     * @brief SetAgentPosition Sets the position of the given agent without
+     * modifying the items (see Board::SetAgentPosition).
+     */
+    inline void SetAgentPosition(int agentID, int x, int y)
+    {
+        agents[agentID].x = x;
+        agents[agentID].y = y;
+    }
+
+    /**
+     * @brief HasBomb Returns true if a bomb is at the specified position
+     */
+    bool HasBomb(int x, int y) const;
+
+    /**
+     * @brief PutBomb Puts a bomb at the specified position and adds one
+     * to the agent's bomb count (see Board::PutBomb).
+     */
+    inline void PutBomb(int x, int y, int agentID, int strength, int lifeTime, bool setItem)
+    {
+        bombs.AddElem(CreateBomb(agentID, x, y, strength, lifeTime));
+        agents[agentID].bombCount++;
+
+        if(setItem)
+        {
+            SetItem(x, y, Item::BOMB);
+        }
+    }
+
+    /**
+     * @brief MoveBomb Moves the bomb at the specified index of the
+     * bomb queue to the given position.
+     */
+    inline void MoveBomb(int index, Position pos)
+    {
+        SetBombPosition(bombs[index], pos);
+    }
+
+    /**
+     * @brief RemoveBomb Removes the bomb at the specified index of the
+     * bomb queue.
+     */
+    inline void RemoveBomb(int index)
+    {
+        if(index == 0)
+        {
+            bombs.PopElem();
+        }
+        else
+        {
+            bombs.RemoveAt(index);
+        }
+    }
+
+    /**
+     * @brief ExplodeBombAt Explodes the bomb at the specified index of the
+     * queue and spawns flames (see State::ExplodeBombAt).
+     */
+    void ExplodeBombAt(int index);
+
+    /**
+     * @brief TickFlames Counts down all flames and extinguishes the flames
+     * which burnt out.
+     */
+    void TickFlames();
+
+    /**
+     * @brief Kill Kill some agent on this board.
+     * @param agentID The id of the agent
+     */
+    void Kill(const int agentID);
+
+    /**
+     * @brief EventBombExploded Called when a bomb explodes.
+     * @param b The bomb which explodes.
+     */
+    void EventBombExploded(Bomb b);
+
+private:
+    void _spawnFlames(int x, int y, int strength);
+    bool _spawnFlameItem(int x, int y, bool isCenterFlame);
+};
+
+static_assert(sizeof(CompactState) < BOARD_SIZE * BOARD_SIZE + 256, "CompactState should only use a single byte per cell");
+
+bool operator==(const CompactState& a, const CompactState& b);
+inline bool operator!=(const CompactState& a, const CompactState& b)
+{
+    return !(a == b);
+}
+
+}
+
+#endif // COMPACT_STATE_H
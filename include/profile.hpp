@@ -0,0 +1,176 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include "bboard.hpp"
+
+#if defined(POMCPP_PROFILE) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#elif defined(POMCPP_PROFILE)
+#include <chrono>
+#endif
+
+// Instrumentation of the step pipeline and the agents. Build with
+// cmake -DPOMCPP_PROFILE=ON to enable it, otherwise the macros expand to
+// nothing and the step functions are not changed at all.
+#ifdef POMCPP_PROFILE
+#define POMCPP_PROFILE_CONCAT_(a, b) a##b
+#define POMCPP_PROFILE_CONCAT(a, b) POMCPP_PROFILE_CONCAT_(a, b)
+#define POMCPP_PROFILE_SCOPE(phase) \
+    bboard::profile::ScopedTimer POMCPP_PROFILE_CONCAT(_profileTimer, __LINE__)(int(phase))
+#define POMCPP_PROFILE_ACT(agentID) \
+    bboard::profile::ScopedTimer POMCPP_PROFILE_CONCAT(_profileTimer, __LINE__)(bboard::profile::ActSlot(agentID))
+#else
+#define POMCPP_PROFILE_SCOPE(phase)
+#define POMCPP_PROFILE_ACT(agentID)
+#endif
+
+namespace bboard::profile
+{
+
+/**
+ * @brief The measured phases of State::Step.
+ */
+enum Phase
+{
+    TICK_FLAMES = 0,
+    FIX_DEST_POS,
+    RESOLVE_DEPENDENCIES,
+    MOVE_AGENT,
+    APPLY_AGENT_MOVEMENT,
+    RESOLVE_BOMB_MOVEMENT,
+    MOVE_BOMBS,
+    TICK_BOMBS,
+    // includes the chain explosions
+    EXPLODE_BOMBS,
+
+    PHASE_COUNT
+};
+
+/**
+ * @brief The counters of the phases are followed by the counters of
+ * Agent::act of every agent.
+ */
+const int SLOT_COUNT = PHASE_COUNT + AGENT_COUNT;
+
+/**
+ * @brief ActSlot Returns the counter slot of Agent::act of the given agent.
+ */
+inline int ActSlot(int agentID)
+{
+    return PHASE_COUNT + agentID;
+}
+
+/**
+ * @brief SlotName Returns the name of the given slot.
+ */
+std::string SlotName(int slot);
+
+/**
+ * @brief Enabled Returns true if the library was built with POMCPP_PROFILE.
+ */
+bool Enabled();
+
+/**
+ * @brief The total cycles and the number of calls of every slot.
+ */
+struct Counters
+{
+    uint64_t cycles[SLOT_COUNT] = {};
+    uint64_t calls[SLOT_COUNT] = {};
+};
+
+/**
+ * @brief Collect Returns the sum of the counters of all threads.
+ */
+Counters Collect();
+
+/**
+ * @brief Reset Sets the counters of all threads to zero.
+ */
+void Reset();
+
+/**
+ * @brief Report Prints a table with the cycles of every phase and agent.
+ */
+void Report(std::ostream& out = std::cout);
+
+/**
+ * @brief ReportJSON Returns the counters as a JSON object (slot name ->
+ * {"cycles", "calls"}).
+ */
+std::string ReportJSON();
+
+#ifdef POMCPP_PROFILE
+
+/**
+ * @brief ReadCycles Returns the time stamp counter (or nanoseconds on
+ * platforms without one).
+ */
+inline uint64_t ReadCycles()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+/**
+ * @brief The counters of a single thread. Only the owning thread writes
+ * them, so relaxed loads and stores are sufficient.
+ */
+struct ThreadCounters
+{
+    std::atomic<uint64_t> cycles[SLOT_COUNT] = {};
+    std::atomic<uint64_t> calls[SLOT_COUNT] = {};
+};
+
+/**
+ * @brief RegisterThread Creates the counters of the calling thread. They
+ * are kept after the thread exits.
+ */
+ThreadCounters* RegisterThread();
+
+inline thread_local ThreadCounters* localCounters = nullptr;
+
+inline void Add(int slot, uint64_t cycles)
+{
+    ThreadCounters* c = localCounters;
+    if(c == nullptr)
+    {
+        c = localCounters = RegisterThread();
+    }
+    c->cycles[slot].store(c->cycles[slot].load(std::memory_order_relaxed) + cycles, std::memory_order_relaxed);
+    c->calls[slot].store(c->calls[slot].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Adds the cycles between construction and destruction to a slot.
+ */
+class ScopedTimer
+{
+public:
+    explicit ScopedTimer(int slot) : slot(slot), start(ReadCycles()) {}
+    ~ScopedTimer()
+    {
+        Add(slot, ReadCycles() - start);
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    const int slot;
+    const uint64_t start;
+};
+
+#endif // POMCPP_PROFILE
+
+}
+
+#endif // PROFILE_H
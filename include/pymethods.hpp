@@ -1,6 +1,7 @@
 #ifndef PYMETHODS_H
 #define PYMETHODS_H
 
+#include <cstdint>
 #include <memory>
 #include "bboard.hpp"
 
@@ -53,6 +54,43 @@ extern "C" {
      * @param word1 Pointer to the second word (used to return value)
      */
     void get_message(int* word0, int* word1);
+
+    /**
+     * @brief Get the number of planes of the default tensor encoding (see bboard::TensorEncoder).
+     */
+    int encoder_default_plane_count();
+
+    /**
+     * @brief Get the width and height of the encoded planes.
+     */
+    int encoder_board_size();
+
+    /**
+     * @brief Encode the last observation of the current agent (see agent_act) into the given buffer.
+     * @param planes The encoded planes (values of bboard::Plane) or nullptr for the default planes
+     * @param planeCount The number of planes
+     * @param buffer A buffer with space for planeCount * board size * board size values
+     * @return Whether the observation has been encoded
+     */
+    bool encode_observation(const int* planes, int planeCount, float* buffer);
+
+    /**
+     * @brief Encode a batch of states/observations into the given buffer.
+     * @param cjsons The states/observations as json char arrays
+     * @param count The number of json char arrays
+     * @param jsonIsState Whether the json char arrays contain states (true) or observations (false)
+     * @param agentIDs The ids of the agents whose perspectives are encoded
+     * @param planes The encoded planes (values of bboard::Plane) or nullptr for the default planes
+     * @param planeCount The number of planes
+     * @param buffer A buffer with space for count * planeCount * board size * board size values
+     * @return Whether the batch has been encoded
+     */
+    bool encode_json_batch(char** cjsons, int count, bool jsonIsState, const int* agentIDs, const int* planes, int planeCount, float* buffer);
+
+    /**
+     * @brief Same as encode_json_batch with a uint8 buffer.
+     */
+    bool encode_json_batch_u8(char** cjsons, int count, bool jsonIsState, const int* agentIDs, const int* planes, int planeCount, uint8_t* buffer);
 }
 
 #endif // PYMETHODS_H
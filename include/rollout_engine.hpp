@@ -0,0 +1,178 @@
+#ifndef ROLLOUT_ENGINE_H
+#define ROLLOUT_ENGINE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "bboard.hpp"
+
+namespace bboard
+{
+
+/**
+ * @brief A persistent pool of worker threads which executes index ranges
+ * with work stealing.
+ *
+ * ParallelFor splits the range [0, count) into one contiguous block per
+ * worker. Every worker processes its own block from the front. A worker
+ * without work steals the back half of the remaining block of another
+ * worker, so uneven workloads are balanced without a central queue.
+ */
+class WorkStealingPool
+{
+public:
+    /**
+     * @brief Starts the worker threads.
+     * @param threadCount The number of workers (<= 0 uses all hardware threads)
+     */
+    explicit WorkStealingPool(int threadCount = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /**
+     * @brief GetThreadCount Returns the number of worker threads.
+     */
+    int GetThreadCount() const;
+
+    /**
+     * @brief ParallelFor Calls f(index, worker) for every index in [0, count)
+     * and blocks until all calls returned. The first exception thrown by f
+     * is rethrown after all other calls finished.
+     *
+     * @param count The number of indices
+     * @param f The function, worker is the id of the calling worker (0 <= worker < GetThreadCount())
+     */
+    void ParallelFor(int count, const std::function<void(int, int)>& f);
+
+private:
+    struct alignas(64) WorkerRange
+    {
+        std::mutex mutex;
+        int begin = 0;
+        int end = 0;
+    };
+
+    std::vector<std::thread> threads;
+    std::unique_ptr<WorkerRange[]> ranges;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    uint64_t generation = 0;
+    bool stop = false;
+
+    // the number of workers which wait for the next generation
+    int parked = 0;
+
+    const std::function<void(int, int)>* job = nullptr;
+    std::atomic<int> remaining{0};
+    std::exception_ptr error;
+
+    void _workerLoop(int worker);
+    bool _nextIndex(int worker, int& index);
+};
+
+/**
+ * @brief Creates the rollout policy of an agent.
+ * @param agentID The id of the agent in the rollout
+ * @param seed A seed which only depends on the seed of the rollouts, the
+ * index of the rollout and the agent id
+ */
+typedef std::function<std::unique_ptr<Agent>(int agentID, long seed)> AgentFactory;
+
+/**
+ * @brief The aggregated result of several rollouts.
+ */
+struct RolloutResult
+{
+    int rollouts = 0;
+
+    /**
+     * @brief returns The sum of the returns of each agent. A finished game
+     * returns +1 to the winners and -1 to all other agents (also in draws),
+     * rollouts which reach the step limit return 0.
+     */
+    int returns[AGENT_COUNT] = {};
+
+    /**
+     * @brief wins The number of rollouts won by each agent.
+     */
+    int wins[AGENT_COUNT] = {};
+
+    int draws = 0;
+
+    /**
+     * @brief unfinished The number of rollouts which reached the step limit.
+     */
+    int unfinished = 0;
+
+    /**
+     * @brief steps The total number of steps of all rollouts.
+     */
+    long steps = 0;
+
+    /**
+     * @brief MeanReturn Returns the average return of the given agent.
+     */
+    inline float MeanReturn(int agentID) const
+    {
+        return rollouts == 0 ? 0.0f : float(returns[agentID]) / rollouts;
+    }
+};
+
+/**
+ * @brief Runs many rollouts of a state in parallel (see WorkStealingPool).
+ *
+ * Every rollout plays the game until it is finished or the step limit is
+ * reached, all agents act on their own observation of the current state.
+ * The agents are created for every rollout with a seed derived from the
+ * seed of Run and the index of the rollout, so the result only depends on
+ * the seed and not on the number of threads. Messages are not delivered.
+ */
+class RolloutEngine
+{
+public:
+    /**
+     * @brief The default step limit of a rollout (the episode length of Pommerman).
+     */
+    static const int DEFAULT_MAX_STEPS = 800;
+
+    /**
+     * @param threadCount The number of workers (<= 0 uses all hardware threads)
+     */
+    explicit RolloutEngine(int threadCount = 0);
+
+    /**
+     * @brief Run Executes the given number of rollouts starting at root.
+     *
+     * @param root The start state of all rollouts
+     * @param policy Creates the agents of each rollout
+     * @param rollouts The number of rollouts
+     * @param seed The seed of the rollouts
+     * @param maxSteps Rollouts stop after this number of steps
+     * @param obsParams The parameters of the observations of the agents
+     * @return The aggregated result of all rollouts
+     */
+    RolloutResult Run(const State& root, const AgentFactory& policy, int rollouts, long seed,
+                      int maxSteps = DEFAULT_MAX_STEPS, const ObservationParameters& obsParams = ObservationParameters());
+
+    /**
+     * @brief GetThreadCount Returns the number of worker threads.
+     */
+    int GetThreadCount() const;
+
+private:
+    WorkStealingPool pool;
+};
+
+}
+
+#endif // ROLLOUT_ENGINE_H
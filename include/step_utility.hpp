@@ -6,6 +6,15 @@
 namespace bboard::util
 {
 
+// The functions of the step pipeline which are templated on the state type S
+// only access the board through GetItem/SetItem, GetAgent, HasBomb, the agents
+// and the bomb queue (agents are moved with SetAgentPosition, bombs are moved
+// and removed with MoveBomb/RemoveBomb).
+// They are instantiated for State, BitBoard and CompactState (see
+// step_utility.cpp), so all representations share the same movement rules.
+// Functions with a Rules parameter skip the checks of disabled rules (see
+// StepRules), they are instantiated for all rule sets for State.
+
 /**
  * @brief DesiredPosition returns the x and y values of the agents
  * destination
@@ -34,14 +43,16 @@ Position DesiredPosition(const Bomb b);
  * we don't need to read the direction and find out if they've been alraedy moved
  * @return The position of the last agent/bomb that was bounced back in the chain.
  */
-Position AgentBombChainReversion(State* state, const Position oldAgentPos[AGENT_COUNT],
+template<typename Rules = DefaultRules, typename S>
+Position AgentBombChainReversion(S* state, const Position oldAgentPos[AGENT_COUNT],
                                  Position bombDest[MAX_BOMBS], int agentID);
 
 /**
  * @brief FillPositions Fills an array of Positions with positions of
  * all agents of the given state.
  */
-void FillPositions(const State* state, Position p[AGENT_COUNT]);
+template<typename S>
+void FillPositions(const S* state, Position p[AGENT_COUNT]);
 
 /**
  * @brief FillDestPos Fills an array of destination positions.
@@ -49,17 +60,21 @@ void FillPositions(const State* state, Position p[AGENT_COUNT]);
  * @param m An array of all agent moves
  * @param p The array to be filled wih dest positions
  */
-void FillDestPos(const State* state, Move m[AGENT_COUNT], Position p[AGENT_COUNT]);
+template<typename S>
+void FillDestPos(const S* state, const Move m[AGENT_COUNT], Position p[AGENT_COUNT]);
 
-void FillBombPositions(const Board* board, Position p[]);
+template<typename S>
+void FillBombPositions(const S* board, Position p[]);
 
 /**
  * @brief FillBombDestPos Fills the given array p with all desired bomb
  * positions that moving bombs are anticipating
  */
-void FillBombDestPos(const Board* board, Position p[MAX_BOMBS]);
+template<typename S>
+void FillBombDestPos(const S* board, Position p[MAX_BOMBS]);
 
-void FillAgentDead(const State* state, bool dead[AGENT_COUNT]);
+template<typename S>
+void FillAgentDead(const S* state, bool dead[AGENT_COUNT]);
 
 inline void _printPositions(Position p[], int size)
 {
@@ -130,7 +145,8 @@ bool FixDestPos(const Position o[], Position d[], const int size, bool skip[] =
  * TODO: Fill doc for dependency resolving
  *
  */
-int ResolveDependencies(const State* state, Position des[AGENT_COUNT],
+template<typename Rules = DefaultRules, typename S>
+int ResolveDependencies(const S* state, Position des[AGENT_COUNT],
                         int dependency[AGENT_COUNT], int chain[AGENT_COUNT]);
 
 /**
@@ -142,12 +158,14 @@ void TickFlames(State* state);
 /**
  * @brief TickBombs Counts down all bomb timers
  */
-void TickBombs(State* state);
+template<typename S>
+void TickBombs(S* state);
 
 /**
  * @brief ExplodeBombs Lights up bombs when their timer is up
  */
-void ExplodeBombs(State* state);
+template<typename S>
+void ExplodeBombs(S* state);
 
 /**
  * @brief MoveBombsForward moves all bombs forward that have been
@@ -155,13 +173,48 @@ void ExplodeBombs(State* state);
  */
 void MoveBombsForward(State* state);
 
+/**
+ * @brief TryPutBomb Puts a bomb at the agent's position if it has enough
+ * available bombs. Works with every state type of the step pipeline.
+ * @param state The state (State, BitBoard or CompactState)
+ * @param id The id of the agent
+ * @param setItem Whether to set the board item to Item::BOMB
+ */
+template<bool duringStep, typename S>
+inline void TryPutBomb(S* state, int id, bool setItem = false)
+{
+    const auto& agent = state->agents[id];
+    if(agent.bombCount >= agent.maxBombCount || state->HasBomb(agent.x, agent.y))
+        return;
+
+    // when we plant a bomb during the step function, we need to increment the bomb lifetime by 1
+    // because all bomb lifetimes will be decremented at the end of this step
+    state->PutBomb(agent.x, agent.y, id, agent.bombStrength, BOMB_LIFETIME + (duringStep ? 1 : 0), setItem);
+}
+
 /**
  * @brief ConsumePowerup Lets an agent consume a powerup
- * @param info The agentInfo of the agent which consumes the item.
+ * @param info The agentInfo of the agent which consumes the item
+ * (AgentInfo or CompactAgentInfo).
  * @param powerUp A powerup item. If it's something else,
  * this function will do nothing.
  */
-void ConsumePowerup(AgentInfo& info, int powerUp);
+template<typename A>
+inline void ConsumePowerup(A& info, int powerUp)
+{
+    if(powerUp == Item::EXTRABOMB)
+    {
+        info.maxBombCount++;
+    }
+    else if(powerUp == Item::INCRRANGE)
+    {
+        info.bombStrength++;
+    }
+    else if(powerUp == Item::KICK)
+    {
+        info.canKick = true;
+    }
+}
 
 /**
  * @brief PrintDependency Prints a dependency array in a nice
@@ -191,7 +244,8 @@ bool HasDPCollision(const State* state, Position dp[AGENT_COUNT], int agentID);
  * @brief ResetBombFlags Resets the "moved" flag of each bomb on the board
  * back to false.
  */
-void ResetBombFlags(Board* board);
+template<typename S>
+void ResetBombFlags(S* board);
 
 /**
  * @brief ResolveBombMovement Checks for collisions between bomb destinations and handles bomb kicks. Resets agent moves if necessary.
@@ -200,7 +254,8 @@ void ResetBombFlags(Board* board);
  * @param originalAgentDestination Original agent destinations (before collision handling)
  * @param bombDestinations The current bomb destinations (will be modified)
  */
-void ResolveBombMovement(State* state, const Position oldAgentPos[AGENT_COUNT], const Position originalAgentDestination[AGENT_COUNT], Position bombDestinations[]);
+template<typename Rules = DefaultRules, typename S>
+void ResolveBombMovement(S* state, const Position oldAgentPos[AGENT_COUNT], const Position originalAgentDestination[AGENT_COUNT], Position bombDestinations[]);
 
 /**
  * @brief MoveAgent Execute move m for agent i (includes laying bombs).
@@ -212,7 +267,40 @@ void ResolveBombMovement(State* state, const Position oldAgentPos[AGENT_COUNT],
  * @param fixedDest The fixed destinations of the agent. Has a higher priority than the move
  * @param ouroboros Whether he have an ouroboros scenario
  */
-void MoveAgent(State* state, const int i, const Move m, const Position fixedDest, const bool ouroboros);
+template<typename Rules = DefaultRules, typename S>
+void MoveAgent(S* state, const int i, const Move m, const Position fixedDest, const bool ouroboros);
+
+/**
+ * @brief IsCollisionFreeStep Returns true if no bomb moves and all alive
+ * agents which want to move have pairwise distinct destinations without
+ * agents and bombs. Then, the agents can be moved independently (in any
+ * order) and the step does not require collision and bomb movement handling.
+ * @param state The state object
+ * @param oldPos The current agent positions
+ * @param destPos The desired agent destinations (see FillDestPos)
+ */
+template<typename Rules = DefaultRules, typename S>
+bool IsCollisionFreeStep(const S* state, const Position oldPos[AGENT_COUNT], const Position destPos[AGENT_COUNT]);
+
+/**
+ * @brief MoveAgents Executes the moves of all agents in the order of the
+ * dependencies between them (see ResolveDependencies and MoveAgent).
+ * @param state The state object
+ * @param moves The moves of all agents
+ * @param destPos The destinations of all agents after resolving
+ * destination collisions (see FixDestPos)
+ */
+template<typename Rules = DefaultRules, typename S>
+void MoveAgents(S* state, const Move moves[AGENT_COUNT], Position destPos[AGENT_COUNT]);
+
+/**
+ * @brief ApplyAgentMovement Puts all alive agents on their (final) positions
+ * on the board. Agents which moved into flames die, agents which moved on
+ * powerups collect them.
+ * @param state The state object
+ */
+template<typename Rules = DefaultRules, typename S>
+void ApplyAgentMovement(S* state);
 
 /**
  * @brief MoveBombs Moves the bombs (bombs explode when they hit flames).
@@ -220,7 +308,8 @@ void MoveAgent(State* state, const int i, const Move m, const Position fixedDest
  * @param state The state object
  * @param bombDestinations The bomb destinations
  */
-void MoveBombs(State* state, const Position bombDestinations[]);
+template<typename Rules = DefaultRules, typename S>
+void MoveBombs(S* state, const Position bombDestinations[]);
 
 /**
  * @brief IsOutOfBounds Checks wether a given position is out of bounds
@@ -242,40 +331,91 @@ inline bool IsOutOfBounds(const int& x, const int& y)
  * @brief BombMovementIsBlocked Checks whether the bomb movement to the specified
  * target is blocked (not possible)
  */
-inline bool BombMovementIsBlocked(const Board* board, Position target)
+template<typename S>
+inline bool BombMovementIsBlocked(const S* board, Position target)
 {
     return IsOutOfBounds(target)
-            || IS_STATIC_MOV_BLOCK(board->items[target.y][target.x])
+            || IS_STATIC_MOV_BLOCK(board->GetItem(target.x, target.y))
             || board->GetAgent(target.x, target.y) != -1;
 }
 
+/**
+ * @brief IsNoOpMove Returns true if the move of the given agent results in
+ * the same state as Move::IDLE (for all moves of the other agents): all moves
+ * of dead (or hidden) agents, bombs which can't be placed, moves into rigid
+ * blocks, wooden blocks or out of the board and moves of agents without kick
+ * onto bombs which do not move. Flames do not change the result, so the
+ * states before and after util::TickFlames have the same no-op moves.
+ */
+template<typename Rules = DefaultRules>
+inline bool IsNoOpMove(const State& state, int agentID, Move m)
+{
+    const AgentInfo& a = state.agents[agentID];
+    if(m == Move::IDLE || a.dead || (Rules::PartialObservability && !a.visible))
+        return true;
+
+    if(m == Move::BOMB)
+        return a.bombCount >= a.maxBombCount || state.HasBomb(a.x, a.y);
+
+    const Position dest = DesiredPosition(a.x, a.y, m);
+    if(IsOutOfBounds(dest))
+        return true;
+
+    const int item = state.items[dest.y][dest.x];
+    if(IS_WOOD(item) || item == Item::RIGID)
+        return true;
+
+    if(!(Rules::Kick && a.canKick) && item == Item::BOMB)
+    {
+        const Bomb* b = state.GetBomb(dest.x, dest.y);
+        return b != nullptr && BMB_DIR(*b) == int(Direction::IDLE);
+    }
+    return false;
+}
+
+/**
+ * @brief ComputeMoveMasks Computes the distinct effective moves of all
+ * agents: Move::IDLE and all moves which are not a no-op (see IsNoOpMove).
+ * Every other move results in the same child as one of these moves.
+ * @param state The state
+ * @param masks The resulting masks
+ */
+template<typename Rules = DefaultRules>
+inline void ComputeMoveMasks(const State& state, MoveMask masks[AGENT_COUNT])
+{
+    for(int i = 0; i < AGENT_COUNT; i++)
+    {
+        MoveMask mask = MoveBit(Move::IDLE);
+        for(int m = 1; m < ACTION_COUNT; m++)
+        {
+            if(!IsNoOpMove<Rules>(state, i, Move(m)))
+                mask |= MoveBit(Move(m));
+        }
+        masks[i] = mask;
+    }
+}
+
 /**
  * @brief GetWinningTeam Get the winning team of the provided state.
  * @param state The state
  * @return 0 when there is no winner or the winner is in no team, team
  * id of the winning team otherwise
  */
-int GetWinningTeam(const State& state);
+template<typename S>
+int GetWinningTeam(const S& state);
 
 /**
  * @brief CheckTerminalState Checks whether the state is a terminal state
  * (some agent/team won) and updates the state attributes accordingly.
  * @param state The state
  */
-void CheckTerminalState(State& state);
-
-/**
- * @brief CompareTimeLeft Checks whether timeLeft of lhs is smaller than
- * timeLeft of rhs.
- * @param lhs A flame object
- * @param rhs A flame object
- * @return lhs.timeLeft < rhs.timeLeft
- */
-bool CompareTimeLeft(const Flame& lhs, const Flame& rhs);
+template<typename Rules = DefaultRules, typename S>
+void CheckTerminalState(S& state);
 
 /**
  * @brief OptimizeFlameQueue Optimizes (ordering + additive flame times) a
  * flame queue with absolute frame times for faster step processing.
+ * Also rebuilds the flame buckets and the flame index of the board.
  * @param board The board used to save flame ids
  * @param flames The flame queue which should be optimized
  * @return the remaining timeLeft
@@ -1,6 +1,8 @@
 #ifndef STRATEGY_H
 #define STRATEGY_H
 
+#include <type_traits>
+
 #include "bboard.hpp"
 #include "step_utility.hpp"
 
@@ -62,6 +64,93 @@ inline bool IsReachable(RMap& r, int x, int y)
     return r.GetDistance(x, y) != 0;
 }
 
+/**
+ * @brief The MultiRMap struct holds the reachable maps of several
+ * agents. It is filled with a bit-parallel BFS: every row of the board is
+ * a 64-bit word which holds one lane per agent, so a single pass over the
+ * rows expands the frontiers of all agents in the word by one layer.
+ *
+ * The distances are the same as the ones of RMap (0 for the source and
+ * unreachable cells). Predecessors are not stored during the search,
+ * GetPredecessor recovers the predecessor which FillRMap would have
+ * chosen on demand and caches it.
+ */
+struct MultiRMap
+{
+    // every lane has at least one spare bit, so bits which are shifted
+    // out of a row do not enter the lane of the next agent
+    static const int LANE_BITS = BOARD_SIZE < 16 ? 16 : 32;
+    // the number of agents which are searched in a single pass
+    static const int LANES = 64 / LANE_BITS;
+    static_assert (BOARD_SIZE < LANE_BITS, "Every row of every agent must fit into a lane");
+
+    // bits of a single row
+    typedef std::conditional_t<LANE_BITS == 16, uint16_t, uint32_t> Row;
+    // distances and cell indices
+    typedef std::conditional_t<BOARD_SIZE * BOARD_SIZE <= 256, uint8_t, uint16_t> Cell;
+
+    Cell distance[AGENT_COUNT][BOARD_SIZE * BOARD_SIZE];
+    Position source[AGENT_COUNT];
+    RMapInfo info[AGENT_COUNT];
+
+    // the agents whose maps have been filled (bit i for agent i)
+    int agentMask = 0;
+
+    // cells which continue the search (bit x of row y)
+    Row walkable[BOARD_SIZE];
+
+    // lazily recovered predecessors (bit x of row y is set if resolved)
+    mutable Row resolved[AGENT_COUNT][BOARD_SIZE];
+    mutable Cell predecessor[AGENT_COUNT][BOARD_SIZE * BOARD_SIZE];
+
+    /**
+     * @brief GetDistance Returns the shortest walking distance from
+     * the position of the given agent to (x, y).
+     */
+    inline int GetDistance(int agentID, int x, int y) const
+    {
+        return distance[agentID][x + BOARD_SIZE * y];
+    }
+
+    /**
+     * @brief GetPredecessor Returns the index i = x' + BOARD_SIZE * y' of the
+     * predecessor of (x, y) on the path of the given agent (the same
+     * as RMap::GetPredecessor).
+     */
+    int GetPredecessor(int agentID, int x, int y) const;
+};
+
+/**
+ * @brief AgentRMap A view on the reachable map of a single agent
+ * in a MultiRMap. Has the same interface as RMap.
+ */
+struct AgentRMap
+{
+    const MultiRMap& maps;
+    const int agentID;
+    const Position source;
+
+    AgentRMap(const MultiRMap& maps, int agentID)
+        : maps(maps), agentID(agentID), source(maps.source[agentID]) {}
+
+    inline int GetDistance(int x, int y) const
+    {
+        return maps.GetDistance(agentID, x, y);
+    }
+
+    inline int GetPredecessor(int x, int y) const
+    {
+        return maps.GetPredecessor(agentID, x, y);
+    }
+};
+
+/**
+ * @brief FillMultiRMap Fills the reachable maps of all agents in the
+ * given mask in a single pass. Dead agents and agents which are not
+ * visible get empty maps.
+ */
+void FillMultiRMap(const Board& b, MultiRMap& r, int agentMask = (1 << AGENT_COUNT) - 1);
+
 //////////////
 // Movement //
 //////////////
@@ -83,6 +172,7 @@ bool IsAdjacentItem(const Board& b, int agentID, int distance, Item item);
  * from the RMap source to the specified target
  */
 Move MoveTowardsPosition(const RMap& r, const Position& position);
+Move MoveTowardsPosition(const AgentRMap& r, const Position& position);
 
 /**
  * @brief MoveTowardsSafePlace Returns the direction towards one
@@ -124,6 +214,46 @@ Move MoveTowardsEnemy(const Board& b, const RMap& r, int agentID, int radius);
  */
 void SafeDirections(const Board& b, FixedQueue<Move, MOVE_COUNT>& q, int x, int y);
 
+/**
+ * @brief The DangerMap struct holds the time until each cell is hit
+ * by an explosion, computed once per board. In contrast to IsInDanger,
+ * it considers chain reactions and flames are blocked by rigid and
+ * wooden blocks like in the game, until the wooden blocks burnt (moving
+ * bombs are not simulated).
+ */
+struct DangerMap
+{
+    // 0 if the cell is not in range of a bomb
+    int time[BOARD_SIZE][BOARD_SIZE] = {};
+
+    /**
+     * @brief GetTime Returns the time until (x, y) explodes, 0 if
+     * (x, y) is safe or out of bounds (the same as IsInDanger).
+     */
+    inline int GetTime(int x, int y) const
+    {
+        return util::IsOutOfBounds(x, y) ? 0 : time[y][x];
+    }
+};
+
+/**
+ * @brief FillDangerMap Computes the earliest explosion time of every
+ * cell on the given board.
+ */
+void FillDangerMap(const Board& b, DangerMap& d);
+
+/**
+ * @brief SafeDirections Adds all possible safe moves to the queue
+ * (uses a filled DangerMap instead of IsInDanger)
+ */
+void SafeDirections(const Board& b, const DangerMap& d, FixedQueue<Move, MOVE_COUNT>& q, int x, int y);
+
+/**
+ * @brief MoveTowardsSafePlace The same as MoveTowardsSafePlace(b, r, radius),
+ * but uses a filled DangerMap instead of IsInDanger.
+ */
+Move MoveTowardsSafePlace(const DangerMap& d, const RMap& r, int radius);
+
 /**
  * @brief SortDirections Sort a move-queue, where unvisited states are
  * last in the queue
@@ -159,6 +289,15 @@ void SortDirections(FixedQueue<Move, MOVE_COUNT>& q,
 int IsInDanger(const Board& b, int agentID);
 int IsInDanger(const Board& b, int x, int y);
 
+/**
+ * @brief IsInDanger Returns the time until the given position explodes
+ * according to the DangerMap (0 if it is safe).
+ */
+inline int IsInDanger(const DangerMap& d, int x, int y)
+{
+    return d.GetTime(x, y);
+}
+
 /**
  * @brief IsInBombRange Returns True if the given position is in range
  * of a bomb planted at (x, y) with strength s
@@ -0,0 +1,111 @@
+#ifndef TENSOR_ENCODER_H
+#define TENSOR_ENCODER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "bboard.hpp"
+
+namespace bboard
+{
+
+/**
+ * @brief The feature planes of a TensorEncoder. Every plane contains
+ * BOARD_SIZE x BOARD_SIZE values (row-major).
+ */
+enum class Plane : uint8_t
+{
+    // 1 if the cell contains the item (wood and flames with any powerup)
+    PASSAGE = 0,
+    RIGID,
+    WOOD,
+    BOMB,
+    FLAME,
+    FOG,
+    EXTRABOMB,
+    INCRRANGE,
+    KICK,
+
+    // the remaining time and the strength of bombs
+    BOMB_TIME,
+    BOMB_STRENGTH,
+    // 1 if the bomb moves
+    BOMB_MOVING,
+    // the remaining lifetime of flames
+    FLAME_TIME,
+
+    // 1 at the positions of the agents (relative to the encoded agent)
+    SELF,
+    TEAMMATE,
+    ENEMIES,
+
+    // constant planes with the stats of the encoded agent
+    SELF_AMMO,
+    SELF_BOMB_STRENGTH,
+    SELF_CAN_KICK,
+
+    PLANE_COUNT
+};
+
+/**
+ * @brief Encodes observations (or states) into planar tensors. The planes
+ * are written straight into a caller-provided buffer of Size() values,
+ * plane after plane.
+ */
+class TensorEncoder
+{
+public:
+    /**
+     * @brief DefaultPlanes Returns the 18 default planes (all planes
+     * except BOMB_MOVING).
+     */
+    static std::vector<Plane> DefaultPlanes();
+
+    explicit TensorEncoder(std::vector<Plane> planes = DefaultPlanes());
+
+    /**
+     * @brief GetPlanes Returns the encoded planes in their order.
+     */
+    const std::vector<Plane>& GetPlanes() const;
+
+    /**
+     * @brief PlaneCount Returns the number of encoded planes.
+     */
+    int PlaneCount() const;
+
+    /**
+     * @brief Size Returns the number of values of a single encoding
+     * (PlaneCount() * BOARD_SIZE * BOARD_SIZE).
+     */
+    int Size() const;
+
+    /**
+     * @brief Encode Encodes the board from the perspective of the given
+     * agent into out (Size() values).
+     */
+    void Encode(const Board& board, int agentID, float* out) const;
+    void Encode(const Board& board, int agentID, uint8_t* out) const;
+
+    /**
+     * @brief Encode Encodes the observation from the perspective of its agent.
+     */
+    void Encode(const Observation& obs, float* out) const;
+    void Encode(const Observation& obs, uint8_t* out) const;
+
+    /**
+     * @brief EncodeBatch Encodes count observations into out
+     * (count * Size() values).
+     */
+    void EncodeBatch(const Observation* observations, int count, float* out) const;
+    void EncodeBatch(const Observation* observations, int count, uint8_t* out) const;
+
+private:
+    std::vector<Plane> planes;
+
+    template<typename T>
+    void _encode(const Board& board, int agentID, T* out) const;
+};
+
+}
+
+#endif // TENSOR_ENCODER_H
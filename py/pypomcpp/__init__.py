@@ -5,3 +5,4 @@ from .clib import CLib
 from .cppagent import CppAgent
 from .cppagent_runner import CppAgentRunner
 from .autocopy import AutoCopy
+from .tensor_encoder import TensorEncoder
@@ -25,6 +25,8 @@ class CppAgent(agents.BaseAgent):
         # load interface
 
         lib = CLib(library_path)
+        # can be shared with a TensorEncoder
+        self.lib = lib
         self.agent_create = lib.get_fun("agent_create", [ctypes.c_char_p, ctypes.c_long], ctypes.c_bool)
         self.agent_reset = lib.get_fun("agent_reset", [], ctypes.c_void_p)
         self.agent_act = lib.get_fun("agent_act", [ctypes.c_char_p, ctypes.c_bool], ctypes.c_int)
@@ -0,0 +1,99 @@
+import ctypes
+import json
+
+import numpy as np
+
+from pypomcpp.clib import CLib
+
+
+class TensorEncoder:
+    """
+    Encodes states/observations into planar tensors with pomcpp (see tensor_encoder.hpp).
+    The planes are written directly into the memory of numpy arrays.
+    """
+
+    def __init__(self, lib: CLib, planes=None, dtype=np.float32):
+        """
+        :param lib: The loaded pomcpp library (e.g. CppAgent.lib)
+        :param planes: The encoded planes (values of bboard::Plane) or None for the default planes
+        :param dtype: The type of the tensors (np.float32 or np.uint8)
+        """
+        if dtype not in (np.float32, np.uint8):
+            raise ValueError(f"Unsupported dtype {dtype}!")
+
+        self.dtype = dtype
+        self.board_size = lib.get_fun("encoder_board_size", [], ctypes.c_int)()
+        if planes is None:
+            self.planes = None
+            self.plane_count = lib.get_fun("encoder_default_plane_count", [], ctypes.c_int)()
+        else:
+            self.planes = (ctypes.c_int * len(planes))(*planes)
+            self.plane_count = len(planes)
+
+        buffer_type = ctypes.POINTER(ctypes.c_float if dtype == np.float32 else ctypes.c_uint8)
+        batch_args = [ctypes.POINTER(ctypes.c_char_p), ctypes.c_int, ctypes.c_bool, ctypes.POINTER(ctypes.c_int),
+                      ctypes.POINTER(ctypes.c_int), ctypes.c_int, buffer_type]
+        batch_name = "encode_json_batch" if dtype == np.float32 else "encode_json_batch_u8"
+        self._encode_json_batch = lib.get_fun(batch_name, batch_args, ctypes.c_bool)
+        self._encode_observation = lib.get_fun(
+            "encode_observation", [ctypes.POINTER(ctypes.c_int), ctypes.c_int, ctypes.POINTER(ctypes.c_float)],
+            ctypes.c_bool)
+        self._buffer_type = buffer_type
+
+    def shape(self, batch_size=None):
+        """
+        :return: The shape of an encoding (or of a batch of encodings).
+        """
+        shape = (self.plane_count, self.board_size, self.board_size)
+        return shape if batch_size is None else (batch_size, ) + shape
+
+    def _check_out(self, out, shape):
+        if out is None:
+            return np.empty(shape, dtype=self.dtype)
+        if out.shape != shape or out.dtype != self.dtype or not out.flags['C_CONTIGUOUS']:
+            raise ValueError(f"Expected a contiguous array of shape {shape} and type {self.dtype}!")
+        return out
+
+    def encode_batch(self, states, agent_ids, is_state=True, out=None):
+        """
+        Encodes a batch of states/observations.
+
+        :param states: The states/observations as json strings or dicts
+        :param agent_ids: The ids of the agents whose perspectives are encoded
+        :param is_state: Whether states (True) or observations (False) are given
+        :param out: An optional array for the result
+        :return: The array of shape (len(states), planes, board_size, board_size)
+        """
+        if len(agent_ids) != len(states):
+            raise ValueError(f"Expected {len(states)} agent ids, got {len(agent_ids)}!")
+
+        out = self._check_out(out, self.shape(len(states)))
+        encoded = [(s if isinstance(s, str) else json.dumps(s)).encode('utf-8') for s in states]
+        cjsons = (ctypes.c_char_p * len(encoded))(*encoded)
+        ids = (ctypes.c_int * len(agent_ids))(*agent_ids)
+
+        if not self._encode_json_batch(cjsons, len(encoded), is_state, ids, self.planes, self.plane_count,
+                                       out.ctypes.data_as(self._buffer_type)):
+            raise ValueError("Could not encode the batch!")
+        return out
+
+    def encode(self, state, agent_id, is_state=True, out=None):
+        """
+        Encodes a single state/observation (see encode_batch).
+        """
+        out = self._check_out(out, self.shape())
+        self.encode_batch([state], [agent_id], is_state, out.reshape(self.shape(1)))
+        return out
+
+    def encode_last_observation(self, out=None):
+        """
+        Encodes the last observation of the agent in the library (see CppAgent.act).
+        """
+        if self.dtype != np.float32:
+            raise ValueError("The last observation can only be encoded as np.float32!")
+
+        out = self._check_out(out, self.shape())
+        if not self._encode_observation(self.planes, self.plane_count,
+                                        out.ctypes.data_as(ctypes.POINTER(ctypes.c_float))):
+            raise ValueError("Could not encode the observation!")
+        return out
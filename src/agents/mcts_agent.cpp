@@ -0,0 +1,269 @@
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+
+#include "bboard.hpp"
+#include "agents.hpp"
+
+using namespace bboard;
+
+namespace agents
+{
+
+///////////////////
+//  Node Arena   //
+///////////////////
+
+MCTSNodeArena::MCTSNodeArena(int capacity)
+{
+    if(capacity < 1 + ACTION_COUNT)
+    {
+        throw std::runtime_error("The node arena needs space for at least one expanded node");
+    }
+    nodes.resize(capacity);
+}
+
+int MCTSNodeArena::Allocate(int count)
+{
+    if(size + count > (int)nodes.size())
+        return -1;
+
+    const int first = size;
+    std::fill_n(nodes.begin() + first, count, MCTSNode());
+    size += count;
+    return first;
+}
+
+void MCTSNodeArena::Reset()
+{
+    size = 0;
+}
+
+int MCTSNodeArena::GetSize() const
+{
+    return size;
+}
+
+int MCTSNodeArena::GetCapacity() const
+{
+    return (int)nodes.size();
+}
+
+//////////////////
+//  MCTS Agent  //
+//////////////////
+
+MCTSAgent::MCTSAgent() : MCTSAgent(std::random_device()()) {}
+
+MCTSAgent::MCTSAgent(long seed, const MCTSParameters& params)
+    : params(params), arena(params.arenaCapacity)
+{
+    if(params.iterations <= 0 && params.timeBudgetMs <= 0)
+    {
+        throw std::runtime_error("MCTSAgent requires an iteration or time budget");
+    }
+
+    rng = std::mt19937_64(seed);
+    root = std::make_unique<State>();
+    state = std::make_unique<State>();
+    path.reserve(params.maxDepth + 1);
+
+    if(params.rolloutPolicy == RolloutPolicy::SIMPLE)
+    {
+        observations = std::make_unique<Observation[]>(AGENT_COUNT);
+        rolloutAgents = std::make_unique<SimpleUnbiasedAgent[]>(AGENT_COUNT);
+        for(int i = 0; i < AGENT_COUNT; i++)
+        {
+            rolloutAgents[i] = SimpleUnbiasedAgent(rng());
+            rolloutAgents[i].id = i;
+        }
+    }
+}
+
+void MCTSAgent::reset()
+{
+    // stats which are not visible are copied from the last root
+    *root = State();
+    lastIterations = 0;
+    arena.Reset();
+}
+
+int MCTSAgent::GetLastIterations() const
+{
+    return lastIterations;
+}
+
+void MCTSAgent::GetRootVisits(int visits[ACTION_COUNT]) const
+{
+    const int children = arena.GetSize() == 0 ? -1 : arena[0].children;
+    for(int m = 0; m < ACTION_COUNT; m++)
+    {
+        visits[m] = children == -1 ? 0 : arena[children + m].visits;
+    }
+}
+
+void MCTSAgent::_policyMoves(Move moves[AGENT_COUNT])
+{
+    if(params.rolloutPolicy == RolloutPolicy::RANDOM)
+    {
+        for(int i = 0; i < AGENT_COUNT; i++)
+        {
+            moves[i] = Move(rng() % ACTION_COUNT);
+        }
+        return;
+    }
+
+    Observation::GetAll(*state, ObservationParameters(), observations.get());
+    for(int i = 0; i < AGENT_COUNT; i++)
+    {
+        moves[i] = state->agents[i].dead ? Move::IDLE : rolloutAgents[i].act(&observations[i]);
+    }
+}
+
+float MCTSAgent::_evaluate(const State& s) const
+{
+    if(s.finished)
+    {
+        if(s.isDraw)
+            return 0.0f;
+        return s.IsWinner(id) ? 1.0f : -1.0f;
+    }
+    if(s.agents[id].dead)
+        return -1.0f;
+
+    int enemies = 0, deadEnemies = 0;
+    for(int i = 0; i < AGENT_COUNT; i++)
+    {
+        if(i != id && s.agents[id].IsEnemy(s.agents[i]))
+        {
+            enemies++;
+            deadEnemies += s.agents[i].dead;
+        }
+    }
+    return enemies == 0 ? 0.0f : 0.5f * deadEnemies / enemies;
+}
+
+int MCTSAgent::_selectChild(int node)
+{
+    const MCTSNode& parent = arena[node];
+    const float logVisits = std::log((float)std::max(1, parent.visits));
+
+    int best = 0;
+    float bestScore = -INFINITY;
+    for(int m = 0; m < ACTION_COUNT; m++)
+    {
+        const MCTSNode& child = arena[parent.children + m];
+        if(child.visits == 0)
+        {
+            // try every move once
+            return m;
+        }
+
+        const float score = child.valueSum / child.visits
+                            + params.exploration * std::sqrt(logVisits / child.visits);
+        if(score > bestScore)
+        {
+            bestScore = score;
+            best = m;
+        }
+    }
+    return best;
+}
+
+void MCTSAgent::_simulate()
+{
+    *state = *root;
+    path.clear();
+    path.push_back(0);
+
+    if(params.rolloutPolicy == RolloutPolicy::SIMPLE)
+    {
+        for(int i = 0; i < AGENT_COUNT; i++)
+        {
+            rolloutAgents[i].reset();
+        }
+    }
+
+    Move moves[AGENT_COUNT];
+    int node = 0, depth = 0;
+
+    // selection and expansion
+    while(!state->finished && !state->agents[id].dead && depth < params.maxDepth)
+    {
+        MCTSNode& current = arena[node];
+        if(current.children == -1)
+        {
+            // expand leaves after their first visit (the root immediately)
+            if(node != 0 && current.visits == 0)
+                break;
+
+            const int children = arena.Allocate(ACTION_COUNT);
+            if(children == -1)
+                break;
+            arena[node].children = children;
+        }
+
+        const int m = _selectChild(node);
+        node = arena[node].children + m;
+        path.push_back(node);
+
+        _policyMoves(moves);
+        moves[id] = Move(m);
+        state->Step(moves);
+        depth++;
+    }
+
+    // rollout
+    while(!state->finished && !state->agents[id].dead && depth < params.maxDepth)
+    {
+        _policyMoves(moves);
+        state->Step(moves);
+        depth++;
+    }
+
+    const float value = _evaluate(*state);
+    for(int n : path)
+    {
+        arena[n].visits++;
+        arena[n].valueSum += value;
+    }
+}
+
+Move MCTSAgent::act(const Observation* obs)
+{
+    obs->ToState(*root);
+
+    arena.Reset();
+    arena.Allocate(1);
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto budget = std::chrono::milliseconds(params.timeBudgetMs);
+
+    int iterations = 0;
+    while(params.iterations <= 0 || iterations < params.iterations)
+    {
+        _simulate();
+        iterations++;
+
+        // checking the clock is expensive compared to a simulation
+        if(params.timeBudgetMs > 0 && iterations % 16 == 0
+                && std::chrono::steady_clock::now() - start >= budget)
+        {
+            break;
+        }
+    }
+    lastIterations = iterations;
+
+    // execute the most visited move
+    int visits[ACTION_COUNT];
+    GetRootVisits(visits);
+    int best = 0;
+    for(int m = 1; m < ACTION_COUNT; m++)
+    {
+        if(visits[m] > visits[best])
+            best = m;
+    }
+    return Move(best);
+}
+
+}
@@ -44,7 +44,7 @@ Move _MoveSafeOneSpace(SimpleAgent& me, const Board& b)
 {
     const AgentInfo& a = b.agents[me.id];
     me.moveQueue.count = 0;
-    SafeDirections(b, me.moveQueue, a.x, a.y);
+    SafeDirections(b, me.dangerMap, me.moveQueue, a.x, a.y);
     SortDirections(me.moveQueue, me.recentPositions, a.x, a.y);
 
     if(me.moveQueue.count == 0)
@@ -60,15 +60,16 @@ Move SimpleAgent::decide(const Observation* obs)
     const AgentInfo& a = obs->agents[id];
     
     FillRMap(b, r, id);
+    FillDangerMap(b, dangerMap);
 
-    danger = IsInDanger(b, id);
+    danger = IsInDanger(dangerMap, a.x, a.y);
 
     if(danger > 0) // ignore danger if not too high
     {
-        Move m = MoveTowardsSafePlace(b, r, danger);
+        Move m = MoveTowardsSafePlace(dangerMap, r, danger);
         Position p = util::DesiredPosition(a.x, a.y, m);
         if(!util::IsOutOfBounds(p.x, p.y) && IS_WALKABLE(b.items[p.y][p.x]) &&
-                _safe_condition(IsInDanger(b, p.x, p.y), 2))
+                _safe_condition(IsInDanger(dangerMap, p.x, p.y), 2))
         {
             return m;
         }
@@ -92,7 +93,7 @@ Move SimpleAgent::decide(const Observation* obs)
             Move m = MoveTowardsEnemy(b, r, id, 7);
             Position p = util::DesiredPosition(a.x, a.y, m);
             if(!util::IsOutOfBounds(p.x, p.y) && IS_WALKABLE(b.items[p.y][p.x]) &&
-                    _safe_condition(IsInDanger(b, p.x, p.y), 5))
+                    _safe_condition(IsInDanger(dangerMap, p.x, p.y), 5))
             {
                 return m;
             }
@@ -86,7 +86,7 @@ void _USafeDirections(const SimpleUnbiasedAgent& me, const Board& b, FixedQueue<
     for (Move m : me.dirAxis) 
     {
         Position desired = util::DesiredPosition(x, y, m);
-        int d = IsInDanger(b, desired.x, desired.y);
+        int d = IsInDanger(me.dangerMap, desired.x, desired.y);
         if(_UCheckPos(b, desired.x, desired.y) && _safe_condition(d))
         {
             q.AddElem(m);
@@ -127,7 +127,7 @@ Move _UMoveTowardsSafePlace(const SimpleUnbiasedAgent &me, const Board& b, const
             if(util::IsOutOfBounds({x, y}) ||
                     std::abs(x - originX) + std::abs(y - originY) > radius) continue;
 
-            if(r.GetDistance(x, y) != 0 && _safe_condition(IsInDanger(b, x, y)))
+            if(r.GetDistance(x, y) != 0 && _safe_condition(IsInDanger(me.dangerMap, x, y)))
             {
                 return MoveTowardsPosition(r, {x, y});
             }
@@ -183,7 +183,7 @@ Move _UMoveTowardsPowerup(const SimpleUnbiasedAgent &me, const Board& b, const R
                     Move m = MoveTowardsPosition(r, {x, y});
                     Position p = util::DesiredPosition(a.x, a.y, m);
 
-                    if(!_safe_condition(IsInDanger(b, p.x, p.y)))
+                    if(!_safe_condition(IsInDanger(me.dangerMap, p.x, p.y)))
                     {
                         continue;
                     }
@@ -257,8 +257,9 @@ Move SimpleUnbiasedAgent::decide(const Observation* obs)
     const AgentInfo& a = obs->agents[id];
 
     FillRMap(b, r, id);
+    FillDangerMap(b, dangerMap);
 
-    danger = IsInDanger(b, id);
+    danger = IsInDanger(dangerMap, a.x, a.y);
 
     // the upper bound controls the greedyness of the agent (lower bound for more greed). 
     // Note that greedy agents seem to perform quite bad against non-greedy agents.
@@ -267,7 +268,7 @@ Move SimpleUnbiasedAgent::decide(const Observation* obs)
         Move m = _UMoveTowardsSafePlace(*this, b, r, danger);
         Position p = util::DesiredPosition(a.x, a.y, m);
         if(!util::IsOutOfBounds(p.x, p.y) && IS_WALKABLE(b.items[p.y][p.x]) &&
-                _safe_condition(IsInDanger(b, p.x, p.y), 2))
+                _safe_condition(IsInDanger(dangerMap, p.x, p.y), 2))
         {
             return m;
         }
@@ -293,7 +294,7 @@ Move SimpleUnbiasedAgent::decide(const Observation* obs)
             Move m = _UMoveTowardsEnemy(*this, b, r, 14);
             Position p = util::DesiredPosition(a.x, a.y, m);
             if(!util::IsOutOfBounds(p.x, p.y) && IS_WALKABLE(b.items[p.y][p.x]) &&
-                    _safe_condition(IsInDanger(b, p.x, p.y), 3))
+                    _safe_condition(IsInDanger(dangerMap, p.x, p.y), 3))
             {
                 return m;
             }
@@ -38,7 +38,10 @@ void Board::CopyFrom(const Board& board, bool copyAgents)
     std::copy_n(&board.items[0][0], BOARD_SIZE * BOARD_SIZE, &items[0][0]);
     
     bombs = board.bombs;
+    std::copy_n(board.bombSlots, BOARD_SIZE * BOARD_SIZE, bombSlots);
     flames = board.flames;
+    std::copy_n(board.flameBuckets, FLAME_LIFETIME, flameBuckets);
+    std::copy_n(board.flameSlots, BOARD_SIZE * BOARD_SIZE, flameSlots);
     timeStep = board.timeStep;
     currentFlameTime = board.currentFlameTime;
 
@@ -84,14 +87,8 @@ void Board::PutAgentsInCorners(int a0, int a1, int a2, int a3, int padding)
 
 void Board::PutBomb(int x, int y, int agentID, int strength, int lifeTime, bool setItem)
 {
-    Bomb& b = bombs.NextPos();
-
-    SetBombID(b, agentID);
-    SetBombPosition(b, x, y);
-    SetBombStrength(b, strength);
-    SetBombDirection(b, Direction::IDLE);
-    SetBombFlag(b, false);
-    SetBombTime(b, lifeTime);
+    bombSlots[x + BOARD_SIZE * y] = (bombs.index + bombs.count) % MAX_BOMBS;
+    bombs.NextPos() = CreateBomb(agentID, x, y, strength, lifeTime);
 
     if(setItem)
     {
@@ -102,40 +99,120 @@ void Board::PutBomb(int x, int y, int agentID, int strength, int lifeTime, bool
     agents[agentID].bombCount++;
 }
 
-bool Board::HasBomb(int x, int y) const
+void Board::MoveBomb(int index, Position pos)
 {
-    for(int i = 0; i < bombs.count; i++)
+    SetBombPosition(bombs[index], pos);
+    bombSlots[pos.x + BOARD_SIZE * pos.y] = (bombs.index + index) % MAX_BOMBS;
+}
+
+void Board::RemoveBomb(int index)
+{
+    if(index == 0)
     {
-        if(BMB_POS_X(bombs[i]) == x && BMB_POS_Y(bombs[i]) == y)
-        {
-            return true;
-        }
+        bombs.PopElem();
+        return;
+    }
+
+    // the following bombs are shifted by one slot
+    bombs.RemoveAt(index);
+    for(int i = index; i < bombs.count; i++)
+    {
+        const Bomb b = bombs[i];
+        bombSlots[BMB_POS_X(b) + BOARD_SIZE * BMB_POS_Y(b)] = (bombs.index + i) % MAX_BOMBS;
     }
-    return false;
 }
 
-Bomb* Board::GetBomb(int x, int y) const
+void Board::RebuildBombIndex()
+{
+    // iterate backwards, so the first bomb wins if there are duplicates
+    for(int i = bombs.count - 1; i >= 0; i--)
+    {
+        const Bomb b = bombs[i];
+        bombSlots[BMB_POS_X(b) + BOARD_SIZE * BMB_POS_Y(b)] = (bombs.index + i) % MAX_BOMBS;
+    }
+}
+
+inline void _moveFlame(Board& board, int from, int to)
+{
+    Flame& f = board.flames[to];
+    f = board.flames[from];
+    board.flameSlots[f.position.x + BOARD_SIZE * f.position.y] = (board.flames.index + to) % (BOARD_SIZE * BOARD_SIZE);
+}
+
+void Board::RemoveFlame(int index)
 {
-    for(int i = 0; i < bombs.count; i++)
+    // find the bucket of the flame
+    int bucket = 0, start = 0, prevTime = 0;
+    while(index >= start + flameBuckets[bucket])
     {
-        if(BMB_POS_X(bombs[i]) == x && BMB_POS_Y(bombs[i]) == y)
+        if(flameBuckets[bucket] > 0)
+            prevTime = bucket + 1;
+
+        start += flameBuckets[bucket];
+        bucket++;
+    }
+
+    // fill the gap with the last flame of the bucket, the new gap is
+    // closed by the last flame of the next bucket and so on
+    int hole = index;
+    int pos = start;
+    for(int b = bucket; b < FLAME_LIFETIME; b++)
+    {
+        const int size = flameBuckets[b];
+        if(size == 0)
+            continue;
+
+        const int last = pos + size - 1;
+        if(last != hole)
+        {
+            _moveFlame(*this, last, hole);
+        }
+
+        // only the first flame of a bucket stores the time difference
+        if(b == bucket)
         {
-            return (Bomb*)&bombs[i];
+            if(size > 1)
+            {
+                flames[start].timeLeft = b + 1 - prevTime;
+                prevTime = b + 1;
+            }
         }
+        else
+        {
+            flames[pos - 1].timeLeft = b + 1 - prevTime;
+            if(size > 1)
+            {
+                flames[pos].timeLeft = 0;
+            }
+            prevTime = b + 1;
+        }
+
+        hole = last;
+        pos += size;
     }
-    return nullptr;
+
+    flameBuckets[bucket]--;
+    flames.count--;
+    currentFlameTime = prevTime;
 }
 
-int Board::GetBombIndex(int x, int y) const
+void Board::RebuildFlameIndex()
 {
-    for(int i = 0; i < bombs.count; i++)
+    std::fill_n(flameBuckets, FLAME_LIFETIME, 0);
+
+    int cumulativeTime = 0;
+    for(int i = 0; i < flames.count; i++)
     {
-        if(BMB_POS_X(bombs[i]) == x && BMB_POS_Y(bombs[i]) == y)
+        const Flame& f = flames[i];
+        cumulativeTime += f.timeLeft;
+        if(cumulativeTime < 1 || cumulativeTime > FLAME_LIFETIME)
         {
-            return i;
+            throw std::runtime_error("Invalid flame lifetime " + std::to_string(cumulativeTime));
         }
+
+        flameBuckets[cumulativeTime - 1]++;
+        flameSlots[f.position.x + BOARD_SIZE * f.position.y] = (flames.index + i) % (BOARD_SIZE * BOARD_SIZE);
     }
-    return -1;
 }
 
 Item Board::FlagItem(int pwp)
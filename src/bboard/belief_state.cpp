@@ -0,0 +1,246 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "belief_state.hpp"
+#include "step_utility.hpp"
+
+namespace bboard
+{
+
+// the powerup of this cell has not been sampled yet
+const uint8_t UNDECIDED_POWERUP = 0xFF;
+
+// the number of tries to place a hidden agent on a random cell
+const int PLACEMENT_TRIES = 64;
+
+BeliefState::BeliefState(int particleCount, int sampleCount, long seed)
+    : uniform(0.0f, 1.0f), choosePowerup(1, 3)
+{
+    if(particleCount <= 0 || sampleCount <= 0)
+    {
+        throw std::runtime_error("BeliefState requires at least one particle and sample");
+    }
+
+    particles.resize(particleCount);
+    samples.resize(sampleCount);
+    powerups = std::make_unique<uint8_t[]>((size_t)particleCount * CELL_COUNT);
+    reference = std::make_unique<State>();
+    consistent.reserve(particleCount);
+    rng.seed(seed);
+}
+
+void BeliefState::_computePriors(const Observation& obs)
+{
+    int fog = 0, rigid = 0, wood = 0;
+    for(int i = 0; i < CELL_COUNT; i++)
+    {
+        const int item = (&reference->items[0][0])[i];
+        fog += item == Item::FOG;
+        rigid += item == Item::RIGID;
+        wood += IS_WOOD(item);
+    }
+
+    // distribute the remaining blocks of the board generation over the unseen cells
+    pRigid = fog == 0 ? 0 : std::clamp(float(DEFAULT_NUM_RIGID - rigid) / fog, 0.0f, 1.0f);
+    pWood = fog == 0 ? 0 : std::clamp(float(DEFAULT_NUM_WOOD - wood) / fog, 0.0f, 1.0f - pRigid);
+    pPowerup = obs.params.exposePowerUps ? 0 : float(DEFAULT_NUM_POWERUPS) / DEFAULT_NUM_WOOD;
+}
+
+void BeliefState::_assignPowerups(int p, const Observation& obs)
+{
+    if(obs.params.exposePowerUps)
+        return;
+
+    State& s = particles[p];
+    int* items = &s.items[0][0];
+    uint8_t* flags = &powerups[(size_t)p * CELL_COUNT];
+    for(int i = 0; i < CELL_COUNT; i++)
+    {
+        // observed wood has no powerup flag, restore the flag of this particle
+        if(items[i] == Item::WOOD)
+        {
+            if(flags[i] == UNDECIDED_POWERUP)
+            {
+                flags[i] = uniform(rng) < pPowerup ? choosePowerup(rng) : 0;
+            }
+            items[i] += flags[i];
+        }
+    }
+}
+
+void BeliefState::_determinize(int p, const Observation& obs)
+{
+    State& s = particles[p];
+    s = *reference;
+    std::fill_n(&powerups[(size_t)p * CELL_COUNT], CELL_COUNT, UNDECIDED_POWERUP);
+
+    // sample the cells which have never been seen
+    int* items = &s.items[0][0];
+    for(int i = 0; i < CELL_COUNT; i++)
+    {
+        if(items[i] == Item::FOG)
+        {
+            const float r = uniform(rng);
+            items[i] = r < pRigid ? Item::RIGID : (r < pRigid + pWood ? Item::WOOD : Item::PASSAGE);
+        }
+    }
+    _assignPowerups(p, obs);
+
+    // place the agents we lost track of on free cells outside of the view
+    std::uniform_int_distribution<int> chooseCell(0, CELL_COUNT - 1);
+    for(int i = 0; i < AGENT_COUNT; i++)
+    {
+        AgentInfo& a = s.agents[i];
+        if(a.dead || a.visible)
+            continue;
+
+        for(int t = 0; t < PLACEMENT_TRIES; t++)
+        {
+            const int cell = chooseCell(rng);
+            const int x = cell % BOARD_SIZE, y = cell / BOARD_SIZE;
+            if(s.items[y][x] == Item::PASSAGE && obs.items[y][x] == Item::FOG)
+            {
+                a.x = x;
+                a.y = y;
+                a.visible = true;
+                s.items[y][x] = Item::AGENT0 + i;
+                break;
+            }
+        }
+    }
+
+    s.RecomputeHash();
+}
+
+void BeliefState::_moveHiddenAgents(State& s, const Observation& obs)
+{
+    for(int i = 0; i < AGENT_COUNT; i++)
+    {
+        AgentInfo& a = s.agents[i];
+        if(a.dead || !a.visible || obs.agents[i].visible || util::IsOutOfBounds(a.x, a.y))
+            continue;
+
+        const Position dest = util::DesiredPosition(a.x, a.y, Move(rng() % 5));
+        if(util::IsOutOfBounds(dest) || !IS_WALKABLE(s.items[dest.y][dest.x]) || obs.items[dest.y][dest.x] != Item::FOG)
+            continue;
+
+        if(s.items[a.y][a.x] == Item::AGENT0 + i)
+        {
+            s.items[a.y][a.x] = s.HasBomb(a.x, a.y) ? Item::BOMB : Item::PASSAGE;
+        }
+        a.x = dest.x;
+        a.y = dest.y;
+        s.items[a.y][a.x] = Item::AGENT0 + i;
+    }
+}
+
+void BeliefState::Reset(const Observation& obs)
+{
+    agentID = obs.agentID;
+    *reference = State();
+    obs.ToState(*reference);
+
+    _computePriors(obs);
+    for(int p = 0; p < (int)particles.size(); p++)
+    {
+        _determinize(p, obs);
+    }
+    resampleCount = (int)particles.size();
+}
+
+void BeliefState::Update(const Observation& obs)
+{
+    if(agentID < 0 || obs.agentID != agentID)
+    {
+        Reset(obs);
+        return;
+    }
+
+    obs.VirtualStep(*reference, true, true);
+    _computePriors(obs);
+
+    consistent.clear();
+    for(int p = 0; p < (int)particles.size(); p++)
+    {
+        State& s = particles[p];
+        _moveHiddenAgents(s, obs);
+        obs.VirtualStep(s, true, true);
+
+        // VirtualStep removes hidden agents which should have been visible,
+        // reconstructed bombs might kill agents which are still alive
+        bool valid = true;
+        for(int i = 0; i < AGENT_COUNT; i++)
+        {
+            const AgentInfo& a = s.agents[i];
+            valid = valid && a.dead == obs.agents[i].dead && (a.dead || a.visible);
+        }
+
+        if(valid)
+        {
+            _assignPowerups(p, obs);
+            s.RecomputeHash();
+            consistent.push_back(p);
+        }
+    }
+
+    // replace all inconsistent particles
+    resampleCount = (int)particles.size() - (int)consistent.size();
+    if(consistent.empty())
+    {
+        for(int p = 0; p < (int)particles.size(); p++)
+        {
+            _determinize(p, obs);
+        }
+        return;
+    }
+
+    std::uniform_int_distribution<int> chooseParticle(0, (int)consistent.size() - 1);
+    for(int p = 0, k = 0; p < (int)particles.size(); p++)
+    {
+        if(k < (int)consistent.size() && consistent[k] == p)
+        {
+            k++;
+            continue;
+        }
+
+        const int q = consistent[chooseParticle(rng)];
+        particles[p] = particles[q];
+        std::copy_n(&powerups[(size_t)q * CELL_COUNT], CELL_COUNT, &powerups[(size_t)p * CELL_COUNT]);
+    }
+}
+
+State& BeliefState::Sample()
+{
+    State& s = samples[nextSample];
+    nextSample = (nextSample + 1) % (int)samples.size();
+    Sample(s);
+    return s;
+}
+
+void BeliefState::Sample(State& state)
+{
+    std::uniform_int_distribution<int> chooseParticle(0, (int)particles.size() - 1);
+    state = particles[chooseParticle(rng)];
+}
+
+int BeliefState::GetParticleCount() const
+{
+    return (int)particles.size();
+}
+
+const State& BeliefState::GetParticle(int i) const
+{
+    return particles[i];
+}
+
+const State& BeliefState::GetReference() const
+{
+    return *reference;
+}
+
+int BeliefState::GetResampleCount() const
+{
+    return resampleCount;
+}
+
+}
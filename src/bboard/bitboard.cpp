@@ -0,0 +1,359 @@
+#include <stdexcept>
+
+#include "bboard.hpp"
+#include "bitboard.hpp"
+#include "step_utility.hpp"
+
+namespace bboard
+{
+
+const Direction _rayDirections[4] = {Direction::RIGHT, Direction::LEFT, Direction::DOWN, Direction::UP};
+
+void BitBoard::FromBoard(const Board& board)
+{
+    rigid = wood = bombItems = woodFlames = burning = BitPlane();
+    std::fill_n(powerUps, 3, BitPlane());
+    std::fill_n(flames, FLAME_LIFETIME, BitPlane());
+    std::fill_n(agentItems, AGENT_COUNT, BitPlane());
+
+    for(int y = 0; y < BOARD_SIZE; y++)
+    {
+        for(int x = 0; x < BOARD_SIZE; x++)
+        {
+            int item = board.items[y][x];
+            if(IS_FLAME(item))
+            {
+                // the lifetime is read from the flame queue
+                if(FLAME_POWFLAG(item) != 0)
+                    powerUps[FLAME_POWFLAG(item) - 1].Set(x, y);
+            }
+            else if(item == Item::FOG)
+            {
+                throw std::runtime_error("BitBoard does not support fog.");
+            }
+            else
+            {
+                SetItem(x, y, item);
+            }
+        }
+    }
+
+    // flames are stored with absolute or additive (optimized) lifetimes
+    int cumulativeTime = 0;
+    for(int i = 0; i < board.flames.count; i++)
+    {
+        const Flame& f = board.flames[i];
+        cumulativeTime += f.timeLeft;
+        int timeLeft = board.currentFlameTime == -1 ? f.timeLeft : cumulativeTime;
+        if(timeLeft < 1 || timeLeft > FLAME_LIFETIME)
+        {
+            throw std::runtime_error("Invalid flame lifetime " + std::to_string(timeLeft));
+        }
+
+        flames[timeLeft - 1].Set(f.position.x, f.position.y);
+        burning.Set(f.position.x, f.position.y);
+        if(f.destroyedWoodAtTimeStep != -1)
+        {
+            woodFlames.Set(f.position.x, f.position.y);
+        }
+    }
+
+    std::copy_n(board.agents, AGENT_COUNT, agents);
+    std::fill_n(agentMasks, CELL_COUNT, 0);
+    for(int i = 0; i < AGENT_COUNT; i++)
+    {
+        _toggleAgentMask(i);
+    }
+
+    bombs = board.bombs;
+    std::fill_n(bombCounts, CELL_COUNT, 0);
+    for(int i = 0; i < bombs.count; i++)
+    {
+        bombCounts[BitPlane::Index(BMB_POS_X(bombs[i]), BMB_POS_Y(bombs[i]))]++;
+    }
+
+    timeStep = board.timeStep;
+}
+
+void BitBoard::FromState(const State& state)
+{
+    FromBoard(state);
+    finished = state.finished;
+    isDraw = state.isDraw;
+    winningTeam = state.winningTeam;
+    winningAgent = state.winningAgent;
+    aliveAgents = state.aliveAgents;
+}
+
+void BitBoard::ToBoard(Board& board) const
+{
+    for(int y = 0; y < BOARD_SIZE; y++)
+    {
+        for(int x = 0; x < BOARD_SIZE; x++)
+        {
+            board.items[y][x] = GetItem(x, y);
+        }
+    }
+
+    // create an optimized flame queue (additive lifetimes)
+    board.flames.index = 0;
+    board.flames.count = 0;
+    int lastTime = 0;
+    for(int t = 0; t < FLAME_LIFETIME; t++)
+    {
+        flames[t].ForEach([&](int x, int y)
+        {
+            Flame& f = board.flames.NextPos();
+            f.position = {x, y};
+            f.timeLeft = t + 1 - lastTime;
+            lastTime = t + 1;
+
+            // flames which burn for t + 1 more steps have been spawned at
+            // timestep timeStep - 1 - (FLAME_LIFETIME - (t + 1))
+            f.destroyedWoodAtTimeStep = woodFlames.Test(x, y) ? timeStep - FLAME_LIFETIME + t : -1;
+
+            board.items[y][x] += (board.flames.count << 3);
+            board.flames.count++;
+        });
+    }
+    board.currentFlameTime = lastTime;
+    board.RebuildFlameIndex();
+
+    std::copy_n(agents, AGENT_COUNT, board.agents);
+    board.bombs = bombs;
+    board.RebuildBombIndex();
+    board.timeStep = timeStep;
+}
+
+void BitBoard::ToState(State& state) const
+{
+    ToBoard(state);
+    state.finished = finished;
+    state.isDraw = isDraw;
+    state.winningTeam = winningTeam;
+    state.winningAgent = winningAgent;
+    state.aliveAgents = aliveAgents;
+    state.RecomputeHash();
+}
+
+void BitBoard::Step(const Move* moves)
+{
+    // do not execute step on terminal states
+    if(finished)
+        return;
+
+    int aliveAgentsBefore = aliveAgents;
+
+    TickFlames();
+
+    // the movement of agents and bombs is shared with State::Step
+
+    Position oldPos[AGENT_COUNT];
+    Position originalDestPos[AGENT_COUNT];
+    Position destPos[AGENT_COUNT];
+    bool dead[AGENT_COUNT];
+
+    util::FillPositions(this, oldPos);
+    util::FillDestPos(this, moves, originalDestPos);
+    std::copy_n(originalDestPos, AGENT_COUNT, destPos);
+    util::FillAgentDead(this, dead);
+
+    util::FixDestPos<true>(oldPos, destPos, AGENT_COUNT, dead);
+
+    util::MoveAgents(this, moves, destPos);
+
+    Position bombDestinations[MAX_BOMBS];
+    util::FillBombDestPos(this, bombDestinations);
+    util::ResolveBombMovement(this, oldPos, originalDestPos, bombDestinations);
+
+    util::ApplyAgentMovement(this);
+    util::MoveBombs(this, bombDestinations);
+
+    util::TickBombs(this);
+    util::ExplodeBombs(this);
+
+    timeStep++;
+
+    if(aliveAgentsBefore != aliveAgents)
+    {
+        util::CheckTerminalState(*this);
+    }
+}
+
+void BitBoard::TickFlames()
+{
+    // powerups below burnt out flames become visible again
+    const BitPlane notBurntOut = ~flames[0];
+    woodFlames &= notBurntOut;
+    burning &= notBurntOut;
+    for(int t = 0; t < FLAME_LIFETIME - 1; t++)
+    {
+        flames[t] = flames[t + 1];
+    }
+    flames[FLAME_LIFETIME - 1] = BitPlane();
+}
+
+void BitBoard::_spawnFlames(const BitPlane& blast)
+{
+    BitPlane& fresh = flames[FLAME_LIFETIME - 1];
+
+    // cells which already burn since this step keep their flame
+    const BitPlane cells = blast & ~fresh;
+    const BitPlane burntWood = cells & wood;
+    const BitPlane notWood = ~burntWood;
+
+    // powerups survive below destroyed wood, all other powerups burn
+    const BitPlane keep = ~cells | burntWood;
+    for(int f = 0; f < 3; f++)
+        powerUps[f] &= keep;
+
+    const BitPlane notCells = ~cells;
+    for(int t = 0; t < FLAME_LIFETIME - 1; t++)
+        flames[t] &= notCells;
+    fresh |= cells;
+    burning |= cells;
+
+    wood &= notWood;
+    woodFlames = (woodFlames & notCells) | burntWood;
+    bombItems &= notCells;
+    for(int i = 0; i < AGENT_COUNT; i++)
+        agentItems[i] &= notCells;
+}
+
+void BitBoard::ExplodeBombAt(int index)
+{
+    // bombs which explode at the same time, chained bombs explode in the next wave
+    Bomb wave[MAX_BOMBS];
+    int waveSize = 1;
+    wave[0] = bombs[index];
+    RemoveBomb(index);
+
+    while(waveSize > 0)
+    {
+        // rays stop at rigid blocks (excluded) and at wood (included). Wood
+        // which has been destroyed in this step still stops the rays.
+        const BitPlane stop = wood | (flames[FLAME_LIFETIME - 1] & woodFlames);
+        const BitPlane notRigid = ~rigid;
+
+        BitPlane centers, rays;
+        bool done[MAX_BOMBS] = {};
+        for(int i = 0; i < waveSize; i++)
+        {
+            if(done[i]) continue;
+
+            // spread the rays of all bombs with the same strength at once
+            const int strength = BMB_STRENGTH(wave[i]);
+            BitPlane sources;
+            for(int j = i; j < waveSize; j++)
+            {
+                if(!done[j] && BMB_STRENGTH(wave[j]) == strength)
+                {
+                    done[j] = true;
+                    sources.Set(BMB_POS_X(wave[j]), BMB_POS_Y(wave[j]));
+                }
+            }
+            centers |= sources;
+
+            for(Direction d : _rayDirections)
+            {
+                BitPlane front = sources;
+                for(int k = 0; k < strength && front.Any(); k++)
+                {
+                    front = Shift(front, d) & notRigid;
+                    rays |= front;
+                    front &= ~stop;
+                }
+            }
+        }
+
+        // bombs hit by a ray explode as well (also when they are hidden below agents)
+        BitPlane chained = bombItems;
+        for(int i = 0; i < AGENT_COUNT; i++)
+            chained |= agentItems[i];
+        chained &= rays;
+
+        const BitPlane blast = centers | rays;
+        for(int i = 0; i < AGENT_COUNT; i++)
+        {
+            if((agentItems[i] & blast).Any())
+                Kill(i);
+        }
+
+        _spawnFlames(blast);
+
+        for(int i = 0; i < waveSize; i++)
+        {
+            EventBombExploded(wave[i]);
+        }
+
+        waveSize = 0;
+        if(!chained.Any()) continue;
+
+        for(int i = 0; i < bombs.count; i++)
+        {
+            if(chained.Test(BMB_POS_X(bombs[i]), BMB_POS_Y(bombs[i])))
+            {
+                wave[waveSize++] = bombs[i];
+                RemoveBomb(i);
+                i--;
+            }
+        }
+    }
+}
+
+void BitBoard::Kill(int agentID)
+{
+    if(!agents[agentID].dead)
+    {
+        _toggleAgentMask(agentID);
+        agents[agentID].dead = true;
+        aliveAgents--;
+    }
+}
+
+void BitBoard::EventBombExploded(Bomb b)
+{
+    int id = BMB_ID(b);
+    if (id >= 0 && id < AGENT_COUNT && agents[id].statsVisible)
+    {
+        agents[BMB_ID(b)].bombCount--;
+    }
+}
+
+bool _agentsEqual(const AgentInfo& a, const AgentInfo& b)
+{
+    return a.team == b.team && a.dead == b.dead && a.visible == b.visible
+            && a.x == b.x && a.y == b.y && a.statsVisible == b.statsVisible
+            && a.bombCount == b.bombCount && a.maxBombCount == b.maxBombCount
+            && a.bombStrength == b.bombStrength && a.canKick == b.canKick;
+}
+
+bool operator==(const BitBoard& a, const BitBoard& b)
+{
+    if(a.rigid != b.rigid || a.wood != b.wood || a.bombItems != b.bombItems || a.woodFlames != b.woodFlames)
+        return false;
+    if(!std::equal(a.powerUps, a.powerUps + 3, b.powerUps)
+            || !std::equal(a.flames, a.flames + FLAME_LIFETIME, b.flames)
+            || !std::equal(a.agentItems, a.agentItems + AGENT_COUNT, b.agentItems))
+        return false;
+
+    for(int i = 0; i < AGENT_COUNT; i++)
+    {
+        if(!_agentsEqual(a.agents[i], b.agents[i]))
+            return false;
+    }
+
+    if(a.bombs.count != b.bombs.count)
+        return false;
+    for(int i = 0; i < a.bombs.count; i++)
+    {
+        if(a.bombs[i] != b.bombs[i])
+            return false;
+    }
+
+    return a.timeStep == b.timeStep && a.finished == b.finished && a.isDraw == b.isDraw
+            && a.winningTeam == b.winningTeam && a.winningAgent == b.winningAgent
+            && a.aliveAgents == b.aliveAgents;
+}
+
+}
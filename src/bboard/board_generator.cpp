@@ -0,0 +1,223 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <tuple>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "bboard.hpp"
+#include "board_generator.hpp"
+
+namespace bboard
+{
+
+inline auto _tie(const BoardKey& k)
+{
+    return std::tie(k.boardSeed, k.numRigid, k.numWood, k.numPowerUps, k.padding, k.breathingRoomSize);
+}
+
+bool operator<(const BoardKey& a, const BoardKey& b)
+{
+    return _tie(a) < _tie(b);
+}
+
+bool operator==(const BoardKey& a, const BoardKey& b)
+{
+    return _tie(a) == _tie(b);
+}
+
+/**
+ * @brief The header of a cache file.
+ */
+struct _BoardCacheHeader
+{
+    char magic[8];
+    int32_t version;
+    int32_t boardSize;
+    int64_t count;
+};
+
+static const char _BOARD_CACHE_MAGIC[8] = {'P', 'O', 'M', 'B', 'O', 'A', 'R', 'D'};
+static const int32_t _BOARD_CACHE_VERSION = 1;
+
+BoardCache::BoardCache(std::vector<CachedBoard> boards) : owned(std::move(boards))
+{
+    std::sort(owned.begin(), owned.end(), [](const CachedBoard& a, const CachedBoard& b) { return a.key < b.key; });
+    owned.erase(std::unique(owned.begin(), owned.end(), [](const CachedBoard& a, const CachedBoard& b) { return a.key == b.key; }), owned.end());
+
+    this->boards = owned.data();
+    count = (int)owned.size();
+}
+
+BoardCache::~BoardCache()
+{
+    _release();
+}
+
+BoardCache::BoardCache(BoardCache&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+BoardCache& BoardCache::operator=(BoardCache&& other) noexcept
+{
+    if(this == &other)
+        return *this;
+
+    _release();
+    owned = std::move(other.owned);
+    boards = other.boards;
+    count = other.count;
+    mapping = other.mapping;
+    mappingSize = other.mappingSize;
+
+    other.owned.clear();
+    other.boards = nullptr;
+    other.count = 0;
+    other.mapping = nullptr;
+    other.mappingSize = 0;
+    return *this;
+}
+
+void BoardCache::_release()
+{
+    if(mapping != nullptr)
+    {
+        munmap(mapping, mappingSize);
+        mapping = nullptr;
+        mappingSize = 0;
+    }
+    owned.clear();
+    boards = nullptr;
+    count = 0;
+}
+
+int BoardCache::Size() const
+{
+    return count;
+}
+
+const CachedBoard* BoardCache::Boards() const
+{
+    return boards;
+}
+
+const CachedBoard* BoardCache::Find(const BoardKey& key) const
+{
+    const CachedBoard* end = boards + count;
+    const CachedBoard* it = std::lower_bound(boards, end, key, [](const CachedBoard& b, const BoardKey& k) { return b.key < k; });
+    if(it == end || !(it->key == key))
+        return nullptr;
+
+    return it;
+}
+
+bool BoardCache::Init(State& state, GameMode gameMode, const BoardKey& key, long agentPositionSeed) const
+{
+    const CachedBoard* board = Find(key);
+    if(board == nullptr)
+    {
+        state.Init(gameMode, key.boardSeed, agentPositionSeed, key.numRigid, key.numWood, key.numPowerUps, key.padding, key.breathingRoomSize);
+        return false;
+    }
+
+    state.InitFromBoard(gameMode, board->items, agentPositionSeed, key.padding);
+    return true;
+}
+
+void BoardCache::Save(const std::string& path) const
+{
+    std::ofstream file(path, std::ios::binary);
+    if(!file)
+    {
+        throw std::runtime_error("Could not open board cache file " + path);
+    }
+
+    _BoardCacheHeader header;
+    std::copy_n(_BOARD_CACHE_MAGIC, 8, header.magic);
+    header.version = _BOARD_CACHE_VERSION;
+    header.boardSize = BOARD_SIZE;
+    header.count = count;
+
+    file.write((const char*)&header, sizeof(header));
+    file.write((const char*)boards, sizeof(CachedBoard) * count);
+    if(!file)
+    {
+        throw std::runtime_error("Could not write board cache file " + path);
+    }
+}
+
+BoardCache BoardCache::Load(const std::string& path)
+{
+    const int fd = open(path.c_str(), O_RDONLY);
+    if(fd == -1)
+    {
+        throw std::runtime_error("Could not open board cache file " + path);
+    }
+
+    struct stat info;
+    if(fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(_BoardCacheHeader))
+    {
+        close(fd);
+        throw std::runtime_error("Invalid board cache file " + path);
+    }
+
+    const size_t size = (size_t)info.st_size;
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(mapping == MAP_FAILED)
+    {
+        throw std::runtime_error("Could not map board cache file " + path);
+    }
+
+    const _BoardCacheHeader* header = (const _BoardCacheHeader*)mapping;
+    if(std::memcmp(header->magic, _BOARD_CACHE_MAGIC, 8) != 0 || header->version != _BOARD_CACHE_VERSION
+            || header->boardSize != BOARD_SIZE || header->count < 0
+            || size != sizeof(_BoardCacheHeader) + sizeof(CachedBoard) * header->count)
+    {
+        munmap(mapping, size);
+        throw std::runtime_error("Invalid board cache file " + path + " (expected board size " + std::to_string(BOARD_SIZE) + ")");
+    }
+
+    BoardCache cache;
+    cache.mapping = mapping;
+    cache.mappingSize = size;
+    cache.boards = (const CachedBoard*)((const char*)mapping + sizeof(_BoardCacheHeader));
+    cache.count = (int)header->count;
+    return cache;
+}
+
+BoardGenerator::BoardGenerator(int threadCount) : pool(threadCount) {}
+
+int BoardGenerator::GetThreadCount() const
+{
+    return pool.GetThreadCount();
+}
+
+BoardCache BoardGenerator::Generate(const std::vector<BoardKey>& keys)
+{
+    std::vector<CachedBoard> boards(keys.size());
+    pool.ParallelFor((int)keys.size(), [&](int i, int)
+    {
+        const BoardKey& k = keys[i];
+        boards[i].key = k;
+        GenerateBoard(boards[i].items, k.boardSeed, k.numRigid, k.numWood, k.numPowerUps, k.padding, k.breathingRoomSize);
+    });
+    return BoardCache(std::move(boards));
+}
+
+BoardCache BoardGenerator::Generate(long firstSeed, int count, const BoardKey& parameters)
+{
+    std::vector<BoardKey> keys(std::max(count, 0), parameters);
+    for(int i = 0; i < count; i++)
+    {
+        keys[i].boardSeed = firstSeed + i;
+    }
+    return Generate(keys);
+}
+
+}
@@ -0,0 +1,398 @@
+#include <stdexcept>
+
+#include "bboard.hpp"
+#include "compact_state.hpp"
+#include "step_utility.hpp"
+
+namespace bboard
+{
+
+inline void _toCompactAgent(const AgentInfo& info, CompactAgentInfo& compact)
+{
+    compact.x = info.x;
+    compact.y = info.y;
+    compact.bombCount = info.bombCount;
+    compact.maxBombCount = info.maxBombCount;
+    compact.bombStrength = info.bombStrength;
+    compact.team = info.team;
+    compact.dead = info.dead;
+    compact.visible = info.visible;
+    compact.statsVisible = info.statsVisible;
+    compact.canKick = info.canKick;
+}
+
+inline void _fromCompactAgent(const CompactAgentInfo& compact, AgentInfo& info)
+{
+    info.x = compact.x;
+    info.y = compact.y;
+    info.bombCount = compact.bombCount;
+    info.maxBombCount = compact.maxBombCount;
+    info.bombStrength = compact.bombStrength;
+    info.team = compact.team;
+    info.dead = compact.dead;
+    info.visible = compact.visible;
+    info.statsVisible = compact.statsVisible;
+    info.canKick = compact.canKick;
+}
+
+void CompactState::FromBoard(const Board& board)
+{
+    for(int y = 0; y < BOARD_SIZE; y++)
+    {
+        for(int x = 0; x < BOARD_SIZE; x++)
+        {
+            int item = board.items[y][x];
+            if(IS_FLAME(item))
+            {
+                // the lifetime is read from the flame queue
+                const int powFlag = FLAME_POWFLAG(item);
+                cells[x + BOARD_SIZE * y] = powFlag == 0 ? cell::PASSAGE : cell::POWERUP + powFlag;
+            }
+            else
+            {
+                cells[x + BOARD_SIZE * y] = cell::FromItem(item);
+            }
+        }
+    }
+
+    // flames are stored with absolute or additive (optimized) lifetimes
+    int cumulativeTime = 0;
+    for(int i = 0; i < board.flames.count; i++)
+    {
+        const Flame& f = board.flames[i];
+        cumulativeTime += f.timeLeft;
+        int timeLeft = board.currentFlameTime == -1 ? f.timeLeft : cumulativeTime;
+        if(timeLeft < 1 || timeLeft > FLAME_LIFETIME)
+        {
+            throw std::runtime_error("Invalid flame lifetime " + std::to_string(timeLeft));
+        }
+
+        uint8_t& c = cells[f.position.x + BOARD_SIZE * f.position.y];
+        c |= timeLeft << cell::FLAME_SHIFT;
+        if(f.destroyedWoodAtTimeStep != -1)
+        {
+            c |= cell::WOOD_FLAME;
+        }
+    }
+
+    for(int i = 0; i < AGENT_COUNT; i++)
+    {
+        _toCompactAgent(board.agents[i], agents[i]);
+    }
+    bombs = board.bombs;
+    timeStep = board.timeStep;
+}
+
+void CompactState::FromState(const State& state)
+{
+    FromBoard(state);
+    finished = state.finished;
+    isDraw = state.isDraw;
+    winningTeam = state.winningTeam;
+    winningAgent = state.winningAgent;
+    aliveAgents = state.aliveAgents;
+}
+
+void CompactState::ToBoard(Board& board) const
+{
+    for(int y = 0; y < BOARD_SIZE; y++)
+    {
+        for(int x = 0; x < BOARD_SIZE; x++)
+        {
+            board.items[y][x] = GetItem(x, y);
+        }
+    }
+
+    // create an optimized flame queue (additive lifetimes)
+    board.flames.index = 0;
+    board.flames.count = 0;
+    int lastTime = 0;
+    for(int t = 1; t <= FLAME_LIFETIME; t++)
+    {
+        for(int i = 0; i < BOARD_SIZE * BOARD_SIZE; i++)
+        {
+            const uint8_t c = cells[i];
+            if(((c & cell::FLAME_MASK) >> cell::FLAME_SHIFT) != t)
+                continue;
+
+            const int x = i % BOARD_SIZE;
+            const int y = i / BOARD_SIZE;
+
+            Flame& f = board.flames.NextPos();
+            f.position = {x, y};
+            f.timeLeft = t - lastTime;
+            lastTime = t;
+
+            // flames which burn for t more steps have been spawned at
+            // timestep timeStep - 1 - (FLAME_LIFETIME - t)
+            f.destroyedWoodAtTimeStep = (c & cell::WOOD_FLAME) ? timeStep - 1 - FLAME_LIFETIME + t : -1;
+
+            board.items[y][x] += (board.flames.count << 3);
+            board.flames.count++;
+        }
+    }
+    board.currentFlameTime = lastTime;
+    board.RebuildFlameIndex();
+
+    for(int i = 0; i < AGENT_COUNT; i++)
+    {
+        _fromCompactAgent(agents[i], board.agents[i]);
+    }
+    board.bombs = bombs;
+    board.RebuildBombIndex();
+    board.timeStep = timeStep;
+}
+
+void CompactState::ToState(State& state) const
+{
+    ToBoard(state);
+    state.finished = finished;
+    state.isDraw = isDraw;
+    state.winningTeam = winningTeam;
+    state.winningAgent = winningAgent;
+    state.aliveAgents = aliveAgents;
+    state.RecomputeHash();
+}
+
+void CompactState::Step(const Move* moves)
+{
+    // do not execute step on terminal states
+    if(finished)
+        return;
+
+    int aliveAgentsBefore = aliveAgents;
+
+    TickFlames();
+    MoveAgentsAndBombs(moves);
+
+    util::TickBombs(this);
+    util::ExplodeBombs(this);
+
+    timeStep++;
+
+    if(aliveAgentsBefore != aliveAgents)
+    {
+        util::CheckTerminalState(*this);
+    }
+}
+
+void CompactState::MoveAgentsAndBombs(const Move* moves)
+{
+    // the movement of agents and bombs is shared with State::Step
+
+    Position oldPos[AGENT_COUNT];
+    Position originalDestPos[AGENT_COUNT];
+    Position destPos[AGENT_COUNT];
+    bool dead[AGENT_COUNT];
+
+    util::FillPositions(this, oldPos);
+    util::FillDestPos(this, moves, originalDestPos);
+    std::copy_n(originalDestPos, AGENT_COUNT, destPos);
+    util::FillAgentDead(this, dead);
+
+    util::FixDestPos<true>(oldPos, destPos, AGENT_COUNT, dead);
+
+    util::MoveAgents(this, moves, destPos);
+
+    Position bombDestinations[MAX_BOMBS];
+    util::FillBombDestPos(this, bombDestinations);
+    util::ResolveBombMovement(this, oldPos, originalDestPos, bombDestinations);
+
+    util::ApplyAgentMovement(this);
+    util::MoveBombs(this, bombDestinations);
+}
+
+int CompactState::GetAgent(int x, int y) const
+{
+    for(int i = 0; i < AGENT_COUNT; i++)
+    {
+        if(!agents[i].dead && agents[i].x == x && agents[i].y == y)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool CompactState::HasBomb(int x, int y) const
+{
+    for(int i = 0; i < bombs.count; i++)
+    {
+        if(BMB_POS_X(bombs[i]) == x && BMB_POS_Y(bombs[i]) == y)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void CompactState::TickFlames()
+{
+    for(uint8_t& c : cells)
+    {
+        if(c & cell::FLAME_MASK)
+        {
+            c -= 1 << cell::FLAME_SHIFT;
+            if(!(c & cell::FLAME_MASK))
+            {
+                // the powerup below the flame becomes visible again
+                c &= cell::KIND_MASK;
+            }
+        }
+    }
+}
+
+void CompactState::ExplodeBombAt(int index)
+{
+    Bomb b = bombs[index];
+
+    // remove the bomb
+    RemoveBomb(index);
+
+    // spawn flames, this may trigger other explosions
+    _spawnFlames(BMB_POS_X(b), BMB_POS_Y(b), BMB_STRENGTH(b));
+
+    EventBombExploded(b);
+}
+
+bool CompactState::_spawnFlameItem(int x, int y, bool isCenterFlame)
+{
+    uint8_t& c = cells[x + BOARD_SIZE * y];
+    const int kind = c & cell::KIND_MASK;
+    const int flameTime = (c & cell::FLAME_MASK) >> cell::FLAME_SHIFT;
+
+    // stop at rigid blocks
+    if(kind == cell::RIGID)
+        return false;
+
+    const bool isAgent = flameTime == 0 && kind >= cell::AGENT0;
+    if(isAgent)
+    {
+        Kill(kind - cell::AGENT0);
+    }
+
+    if(!isCenterFlame && flameTime == 0 && (kind == cell::BOMB || isAgent))
+    {
+        // chain explosions (do not chain self)
+        // note: bombs can also be "hidden" below agents
+        for(int i = 0; i < bombs.count; i++)
+        {
+            if(BMB_POS_X(bombs[i]) == x && BMB_POS_Y(bombs[i]) == y)
+            {
+                ExplodeBombAt(i);
+                return true;
+            }
+        }
+    }
+
+    if(flameTime == FLAME_LIFETIME)
+    {
+        // the existing flame has been spawned in this step, stop
+        // if it destroyed a wooden box, otherwise skip this cell
+        return (c & cell::WOOD_FLAME) == 0;
+    }
+
+    // spawn a new flame (replaces older flames and burns powerups)
+    const uint8_t fresh = FLAME_LIFETIME << cell::FLAME_SHIFT;
+    if(flameTime == 0 && kind >= cell::WOOD && kind <= cell::WOOD + 3)
+    {
+        // keep the powerup below the wood and stop here
+        const int powFlag = kind - cell::WOOD;
+        c = (powFlag == 0 ? cell::PASSAGE : cell::POWERUP + powFlag) | fresh | cell::WOOD_FLAME;
+        return false;
+    }
+
+    c = cell::PASSAGE | fresh;
+    return true;
+}
+
+void CompactState::_spawnFlames(int x, int y, int strength)
+{
+    // spawn flame in center
+    if(!_spawnFlameItem(x, y, true))
+    {
+        return;
+    }
+
+    // spawn subflames in the same order as State::SpawnFlames
+
+    // right
+    for(int i = 1; i <= strength && x + i < BOARD_SIZE; i++)
+    {
+        if(!_spawnFlameItem(x + i, y, false))
+            break;
+    }
+
+    // left
+    for(int i = 1; i <= strength && x - i >= 0; i++)
+    {
+        if(!_spawnFlameItem(x - i, y, false))
+            break;
+    }
+
+    // top
+    for(int i = 1; i <= strength && y + i < BOARD_SIZE; i++)
+    {
+        if(!_spawnFlameItem(x, y + i, false))
+            break;
+    }
+
+    // bottom
+    for(int i = 1; i <= strength && y - i >= 0; i++)
+    {
+        if(!_spawnFlameItem(x, y - i, false))
+            break;
+    }
+}
+
+void CompactState::Kill(int agentID)
+{
+    if(!agents[agentID].dead)
+    {
+        agents[agentID].dead = true;
+        aliveAgents--;
+    }
+}
+
+void CompactState::EventBombExploded(Bomb b)
+{
+    int id = BMB_ID(b);
+    if (id >= 0 && id < AGENT_COUNT && agents[id].statsVisible)
+    {
+        agents[BMB_ID(b)].bombCount--;
+    }
+}
+
+bool _agentsEqual(const CompactAgentInfo& a, const CompactAgentInfo& b)
+{
+    return a.team == b.team && a.dead == b.dead && a.visible == b.visible
+            && a.x == b.x && a.y == b.y && a.statsVisible == b.statsVisible
+            && a.bombCount == b.bombCount && a.maxBombCount == b.maxBombCount
+            && a.bombStrength == b.bombStrength && a.canKick == b.canKick;
+}
+
+bool operator==(const CompactState& a, const CompactState& b)
+{
+    if(!std::equal(a.cells, a.cells + BOARD_SIZE * BOARD_SIZE, b.cells))
+        return false;
+
+    for(int i = 0; i < AGENT_COUNT; i++)
+    {
+        if(!_agentsEqual(a.agents[i], b.agents[i]))
+            return false;
+    }
+
+    if(a.bombs.count != b.bombs.count)
+        return false;
+    for(int i = 0; i < a.bombs.count; i++)
+    {
+        if(a.bombs[i] != b.bombs[i])
+            return false;
+    }
+
+    return a.timeStep == b.timeStep && a.finished == b.finished && a.isDraw == b.isDraw
+            && a.winningTeam == b.winningTeam && a.winningAgent == b.winningAgent
+            && a.aliveAgents == b.aliveAgents;
+}
+
+}
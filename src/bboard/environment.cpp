@@ -5,6 +5,7 @@
 #include <random>
 
 #include "bboard.hpp"
+#include "profile.hpp"
 
 namespace bboard
 {
@@ -98,6 +99,12 @@ void Environment::MakeGame(std::array<Agent*, AGENT_COUNT> a, GameMode gameMode,
 void Environment::SetObservationParameters(ObservationParameters parameters)
 {
     observationParameters = parameters;
+
+    // the next observations have to be created from scratch
+    for(Observation& obs : observations)
+    {
+        obs.agentID = -1;
+    }
 }
 
 void Environment::RunGame(int steps, bool asyncAct, bool render, bool renderClear, bool renderInteractive, int renderWaitMs)
@@ -134,12 +141,13 @@ void Environment::RunGame(int steps, bool asyncAct, bool render, bool renderClea
     }
 }
 
-void ProxyAct(Move& writeBack, Agent& agent, Environment& e)
+void ProxyAct(Move& writeBack, Agent& agent, const Observation* obs)
 {
-    writeBack = agent.act(e.GetObservation(agent.id));
+    POMCPP_PROFILE_ACT(agent.id);
+    writeBack = agent.act(obs);
 }
 
-void CollectMovesAsync(Move m[AGENT_COUNT], Environment& e)
+void CollectMovesAsync(Move m[AGENT_COUNT], Environment& e, const Observation observations[AGENT_COUNT])
 {
     std::thread threads[AGENT_COUNT];
     for(uint i = 0; i < AGENT_COUNT; i++)
@@ -149,7 +157,7 @@ void CollectMovesAsync(Move m[AGENT_COUNT], Environment& e)
             threads[i] = std::thread(ProxyAct,
                                      std::ref(m[i]),
                                      std::ref(*e.GetAgent(i)),
-                                     std::ref(e));
+                                     &observations[i]);
         }
     }
 
@@ -201,9 +209,14 @@ void Environment::Step(bool asyncAct)
 
     Move m[AGENT_COUNT];
 
+    // create the observations of all agents at once. This is faster than
+    // an incremental Update for every agent (see "Observation Update
+    // Function"), which only pays off for single observations.
+    Observation::GetAll(*state.get(), observationParameters, observations.data());
+
     if(asyncAct)
     {
-        CollectMovesAsync(m, *this);
+        CollectMovesAsync(m, *this, observations.data());
     }
     else
     {
@@ -211,7 +224,8 @@ void Environment::Step(bool asyncAct)
         {
             if(!state->agents[i].dead)
             {
-                m[i] = agents[i]->act(GetObservation(i));
+                POMCPP_PROFILE_ACT(i);
+                m[i] = agents[i]->act(&observations[i]);
                 lastMoves[i] = m[i];
                 hasActed[i] = true;
             }
@@ -244,7 +258,15 @@ GameMode Environment::GetGameMode() const
 const Observation* Environment::GetObservation(uint agentID)
 {
     Observation& agentObs = observations[agentID];
-    Observation::Get(*state.get(), agentID, observationParameters, agentObs);
+    if(agentObs.agentID == (int)agentID)
+    {
+        // only patch the cells which changed since the last observation
+        agentObs.Update(*state.get());
+    }
+    else
+    {
+        Observation::Get(*state.get(), agentID, observationParameters, agentObs);
+    }
     return &agentObs;
 }
 
@@ -48,11 +48,193 @@ inline bool _agentVisibleInObservation(int x1, int y1, const AgentInfo& agent, c
     return agent.visible && (!obsParams.agentPartialMapView || InViewRange(x1, y1, agent.x, agent.y, obsParams.agentViewSize));
 }
 
+/**
+ * @brief _observeAgents Adds the agent observations (used by Get and Update).
+ */
+inline void _observeAgents(const State& state, const uint agentID, const ObservationParameters& obsParams, Observation& observation)
+{
+    const AgentInfo& self = state.agents[agentID];
+
+    // always observe self
+    observation.agents[agentID] = self;
+
+    // add others if visible
+    for(uint i = 0; i < AGENT_COUNT; i++)
+    {
+        if(i == agentID) continue;
+
+        const AgentInfo& other = state.agents[i];
+        AgentInfo& otherObservation = observation.agents[i];
+
+        if(_agentVisibleInObservation(self.x, self.y, other, obsParams))
+        {
+            // other agent is visible
+            switch (obsParams.agentInfoVisibility)
+            {
+            case bboard::AgentInfoVisibility::OnlySelf:
+                // add visibility information but no stats
+                otherObservation.visible = true;
+                otherObservation.x = other.x;
+                otherObservation.y = other.y;
+                otherObservation.statsVisible = false;
+                break;
+            case bboard::AgentInfoVisibility::InView:
+            case bboard::AgentInfoVisibility::All:
+                // also add complete stats
+                otherObservation = other;
+                break;
+            }
+        }
+        else
+        {
+            // other agent is not visible in state or not in view range
+
+            if (obsParams.agentInfoVisibility == bboard::AgentInfoVisibility::All)
+            {
+                // stats are visible, initialize default
+                otherObservation = other;
+            }
+            else
+            {
+                otherObservation.statsVisible = false;
+            }
+
+            // ..but the agent itself is not visible!
+            otherObservation.visible = false;
+
+            // we don't know much about this agent and want to ignore it
+            // use unique positions out of bounds to be compatible with the destination checks
+            otherObservation.x = -i;
+            otherObservation.y = -1;
+        }
+
+        // however, we always know whether this agent is alive and in which team it is
+        otherObservation.dead = other.dead;
+        otherObservation.team = other.team;
+    }
+}
+
+/**
+ * @brief _observeItem Returns the observation of the item at (x, y) for
+ * cells inside the view of the agent (same filter as Observation::Get).
+ */
+inline int _observeItem(const State& state, int x, int y, const ObservationParameters& obsParams)
+{
+    int item = state.items[y][x];
+    if(obsParams.exposePowerUps)
+    {
+        return item;
+    }
+
+    // erase the powerup information from wood (and flames in partial views)
+    if(IS_WOOD(item))
+    {
+        return Item::WOOD;
+    }
+    else if(obsParams.agentPartialMapView && IS_FLAME(item))
+    {
+        return CLEAR_POWFLAG(item);
+    }
+    return item;
+}
+
+/**
+ * @brief _filterBombs Adds the bombs in the view of the agent at pos.
+ */
+inline void _filterBombs(const State& state, Observation& obs, Position pos, int viewRange)
+{
+    obs.bombs.count = 0;
+    for(int i = 0; i < state.bombs.count; i++)
+    {
+        int b = state.bombs[i];
+
+        if(InViewRange(pos.x, pos.y, BMB_POS_X(b), BMB_POS_Y(b), viewRange))
+        {
+            obs.bombs.AddElem(b);
+        }
+    }
+    obs.RebuildBombIndex();
+}
+
+/**
+ * @brief _copyObjects Copies the bombs and flames of the given board.
+ * Unlike Board::CopyFrom, only the active flames are copied.
+ */
+inline void _copyObjects(const Board& board, Board& obs)
+{
+    obs.bombs = board.bombs;
+    std::copy_n(board.bombSlots, BOARD_SIZE * BOARD_SIZE, obs.bombSlots);
+    obs.flames.CopyActiveFrom(board.flames);
+    std::copy_n(board.flameBuckets, FLAME_LIFETIME, obs.flameBuckets);
+    std::copy_n(board.flameSlots, BOARD_SIZE * BOARD_SIZE, obs.flameSlots);
+    obs.currentFlameTime = board.currentFlameTime;
+}
+
+/**
+ * @brief _observeView Copies the rows of the given items which are in the
+ * view around center and fills all other cells with fog.
+ */
+inline void _observeView(const int items[][BOARD_SIZE], Position center, int viewSize, Observation& obs)
+{
+    const int leftFogCount = std::max(0, center.x - viewSize);
+    const int rightFogBegin = std::min(BOARD_SIZE, center.x + viewSize + 1);
+
+    for(int y = 0; y < BOARD_SIZE; y++)
+    {
+        if(std::abs(y - center.y) > viewSize)
+        {
+            std::fill_n(&obs.items[y][0], BOARD_SIZE, Item::FOG);
+        }
+        else
+        {
+            std::fill_n(&obs.items[y][0], leftFogCount, Item::FOG);
+            std::copy_n(&items[y][leftFogCount], rightFogBegin - leftFogCount, &obs.items[y][leftFogCount]);
+            std::fill_n(&obs.items[y][rightFogBegin], BOARD_SIZE - rightFogBegin, Item::FOG);
+        }
+    }
+}
+
+/**
+ * @brief _patchViewDifference Updates the cells which are in the view
+ * around a but not in the view around b. The cells are either observed
+ * (visible) or hidden in fog.
+ */
+inline void _patchViewDifference(const State& state, Observation& obs, Position a, Position b, bool visible)
+{
+    const ObservationParameters params = obs.params;
+    const int v = params.agentViewSize;
+    const int minX = std::max(0, a.x - v), maxX = std::min(BOARD_SIZE - 1, a.x + v);
+    const int minY = std::max(0, a.y - v), maxY = std::min(BOARD_SIZE - 1, a.y + v);
+
+    auto patchRange = [&](int y, int begin, int end)
+    {
+        for(int x = begin; x <= end; x++)
+        {
+            obs.items[y][x] = visible ? _observeItem(state, x, y, params) : Item::FOG;
+        }
+    };
+
+    for(int y = minY; y <= maxY; y++)
+    {
+        if(std::abs(y - b.y) > v)
+        {
+            patchRange(y, minX, maxX);
+        }
+        else
+        {
+            // skip the cells in the view around b
+            patchRange(y, minX, std::min(maxX, b.x - v - 1));
+            patchRange(y, std::max(minX, b.x + v + 1), maxX);
+        }
+    }
+}
+
 void Observation::Get(const State& state, const uint agentID, const ObservationParameters obsParams, Observation& observation)
 {
     observation.agentID = agentID;
     observation.params = obsParams;
     observation.timeStep = state.timeStep;
+    observation.sourceHash = state.hash;
 
     // fully observable environment
     if(obsParams.exposePowerUps && !obsParams.agentPartialMapView && obsParams.agentInfoVisibility == AgentInfoVisibility::All)
@@ -119,16 +301,7 @@ void Observation::Get(const State& state, const uint agentID, const ObservationP
         }
 
         // filter bomb objects
-        observation.bombs.count = 0;
-        for(int i = 0; i < state.bombs.count; i++)
-        {
-            int b = state.bombs[i];
-
-            if(InViewRange(info.x, info.y, BMB_POS_X(b), BMB_POS_Y(b), obsParams.agentViewSize))
-            {
-                observation.bombs.AddElem(b);
-            }
-        }
+        _filterBombs(state, observation, info.GetPos(), obsParams.agentViewSize);
 
         // and flames
         _filterFlames(state, observation, info.GetPos(), obsParams.agentViewSize);
@@ -155,66 +328,213 @@ void Observation::Get(const State& state, const uint agentID, const ObservationP
         }
     }
 
-    // agent observations
-    const AgentInfo& self = state.agents[agentID];
-    
-    // always observe self
-    observation.agents[agentID] = self;
+    _observeAgents(state, agentID, obsParams, observation);
+}
 
-    // add others if visible
+void Observation::GetAll(const State& state, const ObservationParameters obsParams, Observation observations[AGENT_COUNT])
+{
     for(uint i = 0; i < AGENT_COUNT; i++)
     {
-        if(i == agentID) continue;
+        Observation& obs = observations[i];
+        obs.agentID = i;
+        obs.params = obsParams;
+        obs.timeStep = state.timeStep;
+        obs.sourceHash = state.hash;
+    }
 
-        const AgentInfo& other = state.agents[i];
-        AgentInfo& otherObservation = observation.agents[i];
+    if(!obsParams.agentPartialMapView)
+    {
+        // all agents observe the same board, only create it once
+        Get(state, 0, obsParams, observations[0]);
+        for(uint i = 1; i < AGENT_COUNT; i++)
+        {
+            Observation& obs = observations[i];
+            std::copy_n(&observations[0].items[0][0], BOARD_SIZE * BOARD_SIZE, &obs.items[0][0]);
+            _copyObjects(observations[0], obs);
 
-        if(_agentVisibleInObservation(self.x, self.y, other, obsParams))
+            if(obsParams.exposePowerUps && obsParams.agentInfoVisibility == AgentInfoVisibility::All)
+            {
+                _copyAgentInfos(state, obs);
+            }
+            else
+            {
+                _observeAgents(state, i, obsParams, obs);
+            }
+        }
+        return;
+    }
+
+    const int v = obsParams.agentViewSize;
+
+    // erase the powerup information once for all agents
+    int filteredItems[BOARD_SIZE][BOARD_SIZE];
+    const int (*items)[BOARD_SIZE] = state.items;
+    if(!obsParams.exposePowerUps)
+    {
+        for(int y = 0; y < BOARD_SIZE; y++)
         {
-            // other agent is visible
-            switch (obsParams.agentInfoVisibility)
+            for(int x = 0; x < BOARD_SIZE; x++)
             {
-            case bboard::AgentInfoVisibility::OnlySelf:
-                // add visibility information but no stats
-                otherObservation.visible = true;
-                otherObservation.x = other.x;
-                otherObservation.y = other.y;
-                otherObservation.statsVisible = false;
-                break;
-            case bboard::AgentInfoVisibility::InView:
-            case bboard::AgentInfoVisibility::All:
-                // also add complete stats
-                otherObservation = other;
-                break;
+                filteredItems[y][x] = _observeItem(state, x, y, obsParams);
             }
         }
-        else
+        items = filteredItems;
+    }
+
+    // the bits of the agents which see the rows and columns, a cell is in
+    // the view of all agents in rowMask[y] & columnMask[x]
+    uint8_t rowMask[BOARD_SIZE] = {};
+    uint8_t columnMask[BOARD_SIZE] = {};
+    for(uint i = 0; i < AGENT_COUNT; i++)
+    {
+        const AgentInfo& info = state.agents[i];
+        for(int k = std::max(0, info.y - v); k <= std::min(BOARD_SIZE - 1, info.y + v); k++)
         {
-            // other agent is not visible in state or not in view range
+            rowMask[k] |= 1 << i;
+        }
+        for(int k = std::max(0, info.x - v); k <= std::min(BOARD_SIZE - 1, info.x + v); k++)
+        {
+            columnMask[k] |= 1 << i;
+        }
 
-            if (obsParams.agentInfoVisibility == bboard::AgentInfoVisibility::All)
+        Observation& obs = observations[i];
+        _observeView(items, info.GetPos(), v, obs);
+        obs.bombs.count = 0;
+        obs.flames.count = 0;
+        obs.flames.index = 0;
+    }
+
+    // filter bomb objects
+    for(int i = 0; i < state.bombs.count; i++)
+    {
+        const Bomb b = state.bombs[i];
+        for(uint mask = rowMask[BMB_POS_Y(b)] & columnMask[BMB_POS_X(b)]; mask != 0; mask &= mask - 1)
+        {
+            observations[CountTrailingZeros(mask)].bombs.AddElem(b);
+        }
+    }
+
+    // and flames (see _filterFlames)
+    assert(state.currentFlameTime != -1);
+    int cumulativeTimeLeft = 0;
+    for(int i = 0; i < state.flames.count; i++)
+    {
+        Flame f = state.flames[i];
+        cumulativeTimeLeft += f.timeLeft;
+        f.timeLeft = cumulativeTimeLeft;
+
+        for(uint mask = rowMask[f.position.y] & columnMask[f.position.x]; mask != 0; mask &= mask - 1)
+        {
+            observations[CountTrailingZeros(mask)].flames.AddElem(f);
+        }
+    }
+
+    for(uint i = 0; i < AGENT_COUNT; i++)
+    {
+        Observation& obs = observations[i];
+        obs.RebuildBombIndex();
+
+        // the cumulative lifetimes are already sorted, so this is the same
+        // as util::OptimizeFlameQueue without sorting the flames again
+        int timeLeft = 0;
+        for(int j = 0; j < obs.flames.count; j++)
+        {
+            Flame& f = obs.flames[j];
+            const int cumulative = std::clamp(f.timeLeft, 1, FLAME_LIFETIME);
+            f.timeLeft = cumulative - timeLeft;
+            timeLeft = cumulative;
+
+            obs.items[f.position.y][f.position.x] += (j << 3);
+        }
+        obs.RebuildFlameIndex();
+        obs.currentFlameTime = timeLeft;
+
+        _observeAgents(state, i, obsParams, obs);
+    }
+}
+
+void Observation::Update(const State& state)
+{
+    if(agentID < 0 || agentID >= AGENT_COUNT)
+    {
+        throw std::runtime_error("Observation::Update requires an observation created with Observation::Get");
+    }
+
+    // the dirty cells are only known if we observed the state before its last step
+    if(state.dirtyBaseHash != sourceHash || state.timeStep != timeStep + 1)
+    {
+        Get(state, agentID, params, *this);
+        return;
+    }
+
+    timeStep = state.timeStep;
+    sourceHash = state.hash;
+
+    // fully observable environment
+    if(params.exposePowerUps && !params.agentPartialMapView && params.agentInfoVisibility == AgentInfoVisibility::All)
+    {
+        state.dirtyCells.ForEachIndex([&](int i)
+        {
+            (&items[0][0])[i] = (&state.items[0][0])[i];
+        });
+
+        _copyObjects(state, *this);
+        _copyAgentInfos(state, *this);
+        return;
+    }
+
+    // board observations
+
+    if(params.agentPartialMapView)
+    {
+        const Position oldCenter = agents[agentID].GetPos();
+        const Position center = state.agents[agentID].GetPos();
+        const int v = params.agentViewSize;
+
+        if(oldCenter != center)
+        {
+            // update the cells which entered or left the view
+            _patchViewDifference(state, *this, center, oldCenter, true);
+            _patchViewDifference(state, *this, oldCenter, center, false);
+        }
+
+        // only visit the dirty cells in the rows of the view
+        const int firstCell = std::max(0, center.y - v) * BOARD_SIZE;
+        const int lastCell = std::min(BOARD_SIZE - 1, center.y + v) * BOARD_SIZE + BOARD_SIZE - 1;
+        state.dirtyCells.ForEachIndex([&](int i)
+        {
+            const int x = i % BOARD_SIZE, y = i / BOARD_SIZE;
+            if(std::abs(x - center.x) <= v)
             {
-                // stats are visible, initialize default
-                otherObservation = other;
+                items[y][x] = _observeItem(state, x, y, params);
             }
-            else
+        }, firstCell, lastCell);
+
+        // the flame ids of the observation depend on the visible flames,
+        // _filterFlames adds them to the observed flame items
+        for(int i = 0; i < state.flames.count; i++)
+        {
+            const Position& p = state.flames[i].position;
+            if(InViewRange(center, p, v))
             {
-                otherObservation.statsVisible = false;
+                items[p.y][p.x] = _observeItem(state, p.x, p.y, params);
             }
-
-            // ..but the agent itself is not visible!
-            otherObservation.visible = false;
-
-            // we don't know much about this agent and want to ignore it
-            // use unique positions out of bounds to be compatible with the destination checks
-            otherObservation.x = -i;
-            otherObservation.y = -1;
         }
 
-        // however, we always know whether this agent is alive and in which team it is
-        otherObservation.dead = other.dead;
-        otherObservation.team = other.team;
+        _filterBombs(state, *this, center, v);
+        _filterFlames(state, *this, center, v);
+    }
+    else
+    {
+        state.dirtyCells.ForEachIndex([&](int i)
+        {
+            (&items[0][0])[i] = _observeItem(state, i % BOARD_SIZE, i / BOARD_SIZE, params);
+        });
+
+        _copyObjects(state, *this);
     }
+
+    _observeAgents(state, agentID, params, *this);
 }
 
 void Observation::ToState(State& state) const
@@ -252,6 +572,7 @@ void Observation::ToState(State& state) const
     state.aliveAgents = aliveAgents;
 
     util::CheckTerminalState(state);
+    state.RecomputeHash();
 }
 
 void _addBomb(Board& board, Bomb bomb)
@@ -282,16 +603,18 @@ void _addBombsFromObservation(State& state, const Observation& obs)
     if(!obs.params.agentPartialMapView)
     {
         state.bombs = obs.bombs;
+        state.RebuildBombIndex();
         return;
     }
 
     Position center = obs.agents[obs.agentID].GetPos();
-    std::unordered_set<Position> positions(obs.bombs.count);
+    BitPlane positions;
 
     // remember the positions of all currently existing bombs
     for(int i = 0; i < obs.bombs.count; i++)
     {
-        positions.insert(BMB_POS(obs.bombs[i]));
+        const Bomb b = obs.bombs[i];
+        positions.Set(BMB_POS_X(b), BMB_POS_Y(b));
     }
 
     auto oldBombs = state.bombs;
@@ -311,8 +634,7 @@ void _addBombsFromObservation(State& state, const Observation& obs)
             continue;
         }
 
-        auto res = positions.find(bPos);
-        if(res != positions.end())
+        if(positions.Test(bPos.x, bPos.y))
         {
             // there is already a bomb at this position
             continue;
@@ -325,6 +647,8 @@ void _addBombsFromObservation(State& state, const Observation& obs)
 
         _addBomb(state, b);
     }
+
+    state.RebuildBombIndex();
 }
 
 void _convertToAbsoluteFlameTimes(Board& board)
@@ -347,16 +671,18 @@ void _addFlamesFromObservation(State& state, const Observation& obs)
     {
         state.flames = obs.flames;
         state.currentFlameTime = obs.currentFlameTime;
+        state.RebuildFlameIndex();
         return;
     }
 
     Position center = obs.agents[obs.agentID].GetPos();
-    std::unordered_set<Position> knownFlamePositions(state.flames.count);
+    BitPlane knownFlamePositions;
 
     // remember the positions of all old flames
     for(int i = 0; i < state.flames.count; i++)
     {
-        knownFlamePositions.insert(state.flames[i].position);
+        const Position& p = state.flames[i].position;
+        knownFlamePositions.Set(p.x, p.y);
     }
 
     // temporarily convert flame times
@@ -370,7 +696,7 @@ void _addFlamesFromObservation(State& state, const Observation& obs)
         cumulativeFlameTime += f.timeLeft;
 
         // only add new flames with absolute time
-        if(knownFlamePositions.find(f.position) != knownFlamePositions.end())
+        if(!knownFlamePositions.Test(f.position.x, f.position.y))
         {
             f.timeLeft = cumulativeFlameTime;
             state.flames.AddElem(f);
@@ -516,126 +842,156 @@ void Observation::VirtualStep(State& state, bool keepAgents, bool keepBombs, int
     else
     {
         state.bombs = bombs;
+        state.RebuildBombIndex();
     }
 
     _addFlamesFromObservation(state, *this);
     util::CheckTerminalState(state);
+    state.RecomputeHash();
 }
 
 /**
- * @brief Checks if there was a bomb at checkPosition in the (old) board or if an agent in newObs has kicked this bomb.
- * 
- * @param board the (old) board
- * @param newObs the (new) observation, one step after the board
- * @param checkPosition the position the bomb should have passed
- * @param checkDirection the direction the bomb took after being at checkPosition
- * @param checkTime the time of the bomb that we are looking for
- * @param checkRange the range of the bomb that we are looking for
- * @param recursionDepth temporary variable to avoid infinite loops
- * @return int the old index of the bomb (on the board, not the observation) or -1 if the bomb could not be found
+ * @brief Lookup tables to find the bombs of a new observation in the old
+ * board (one step earlier). The tables are built once per TrackStats call.
  */
-int _backtrack_bomb_id(const bboard::Board* board, const bboard::Observation* newObs, bboard::Position checkPosition, bboard::Direction checkDirection, int checkTime, int checkRange, int recursionDepth=0)
+struct _BombBacktracker
 {
-    // avoid infinite loops
-    if (recursionDepth >= AGENT_COUNT || bboard::util::IsOutOfBounds(checkPosition)) {
-        return -1;
+    const Board& board;
+    const Observation& newObs;
+
+    // the index of the bomb at each cell of the old board (-1 if there is none)
+    int oldBombAt[BOARD_SIZE * BOARD_SIZE];
+
+    // for each cell of an agent in the new observation, the bits of all
+    // directions in which the agent could have moved to this cell
+    uint8_t agentMoves[BOARD_SIZE * BOARD_SIZE];
+
+    _BombBacktracker(const Board& board, const Observation& newObs);
+
+    /**
+     * @brief Find Tries to find the bomb b of the new observation in the old board.
+     * @return The old index of the bomb (on the board, not the observation)
+     * or -1 if the bomb could not be found
+     */
+    int Find(Bomb b) const;
+};
+
+_BombBacktracker::_BombBacktracker(const Board& board, const Observation& newObs) : board(board), newObs(newObs)
+{
+    std::fill_n(oldBombAt, BOARD_SIZE * BOARD_SIZE, -1);
+    // iterate backwards, so the first bomb wins if there are duplicates
+    for(int i = board.bombs.count - 1; i >= 0; i--)
+    {
+        const Bomb b = board.bombs[i];
+        oldBombAt[BMB_POS_X(b) + BOARD_SIZE * BMB_POS_Y(b)] = i;
     }
 
-    // std::cout << "Checking " << checkPosition << std::endl;
-    int stateItem = board->items[checkPosition.y][checkPosition.x];
-    if (stateItem == bboard::Item::BOMB)
+    std::fill_n(agentMoves, BOARD_SIZE * BOARD_SIZE, 0);
+    for(int i = 0; i < AGENT_COUNT; i++)
     {
-        // is this the bomb we are looking for?
-        int candidateBombIndex = board->GetBombIndex(checkPosition.x, checkPosition.y);
-        const bboard::Bomb& candidateBomb = board->bombs[candidateBombIndex];
-        // std::cout << "Checking bomb at state position " << checkPosition << std::endl;
-        if (bboard::BMB_STRENGTH(candidateBomb) == checkRange && bboard::BMB_TIME(candidateBomb) == checkTime && bboard::BMB_DIR(candidateBomb) == (int)checkDirection) {
-            return candidateBombIndex;
-        }
-        else {
-            return -1;
-        }
-    }
-
-    int obsItem = newObs->items[checkPosition.y][checkPosition.x];
-    if (bboard::IS_AGENT(obsItem))
-    {
-        // std::cout << "Found agent in new observation at " << checkPosition << std::endl;
-        // this agent could have kicked the bomb
-        // example:
-        // step 0: 0   b (bomb moves left, agent moves right => kick)
-        // step 1:   0 b (bomb moves right)
-        // we want to find the original position of the bomb in step 0, which is not `current position - movement`
-        // note that there could be chains, i.e. a bomb can be kicked multiple times in one step by different agents
-
-        // first check if the agent moved in the correct direction
-        bboard::Position oldCandidatePosition = bboard::util::OriginPosition(checkPosition.x, checkPosition.y, bboard::Move(checkDirection));
-        // std::cout << "Checking old candidate position " << oldCandidatePosition << std::endl;
-        int oldCandidateStateItem = board->items[oldCandidatePosition.y][oldCandidatePosition.x];
-        if (oldCandidateStateItem == obsItem) {
-            // std::cout << "Agent was at old position!" << std::endl;
-            // this is the same agent, hence it has kicked the bomb that arrived at this position (checkPosition) from any direction => search for it!
-            for (bboard::Direction newCheckDirection : {bboard::Direction::UP, bboard::Direction::DOWN, bboard::Direction::LEFT, bboard::Direction::RIGHT}) {
-                if (newCheckDirection == checkDirection) {
-                    // this is where the agent came from, we don't have to check this.
-                    continue;
-                }
+        const AgentInfo& info = newObs.agents[i];
+        if(info.dead || !info.visible || util::IsOutOfBounds(info.GetPos()) || newObs.items[info.y][info.x] != Item::AGENT0 + i)
+            continue;
 
-                // move back one field and look for the bomb
-                bboard::Position newCheckPosition = bboard::util::OriginPosition(checkPosition.x, checkPosition.y, bboard::Move(newCheckDirection));
-                int res = _backtrack_bomb_id(board, newObs, newCheckPosition, newCheckDirection, checkTime, checkRange, recursionDepth + 1);
-                if (res != -1) {
-                    return res;
-                }
+        // the agent was at the origin of the movement in the old board
+        uint8_t moves = 0;
+        for(int d = (int)Direction::IDLE; d <= (int)Direction::RIGHT; d++)
+        {
+            const Position origin = util::OriginPosition(info.x, info.y, Move(d));
+            if(!util::IsOutOfBounds(origin) && board.items[origin.y][origin.x] == Item::AGENT0 + i)
+            {
+                moves |= 1 << d;
             }
         }
+        agentMoves[info.x + BOARD_SIZE * info.y] = moves;
     }
-
-    return -1;
 }
 
-int trackStatsErrorCounter = 3;
-/**
- * @brief Tries to find a bomb from newObs in the given board.
- * 
- * @param board the (old) board
- * @param newObs the (new) observation, one step after the board
- * @return int the old index of the bomb (on the board, not the observation) or -1 if the bomb could not be found
- */
-int _backtrack_bomb_id(const bboard::Board* board, const bboard::Observation* newObs, Bomb b)
+int _BombBacktracker::Find(Bomb b) const
 {
-    bboard::Position bombPos = bboard::BMB_POS(b);
-    int bombMovement = bboard::BMB_DIR(b);
+    const Position bombPos = BMB_POS(b);
+    const int bombMovement = BMB_DIR(b);
 
     // check if there is a bomb at the previous position according to the bomb's movement
-    bboard::Position bombOrigin = bboard::util::OriginPosition(bombPos.x, bombPos.y, bboard::Move(bombMovement));
-    int oldOriginBombIndex = board->GetBombIndex(bombOrigin.x, bombOrigin.y);
-    
-    if (oldOriginBombIndex != -1) {
+    const Position bombOrigin = util::OriginPosition(bombPos.x, bombPos.y, Move(bombMovement));
+    if(util::IsOutOfBounds(bombOrigin))
+    {
+        return -1;
+    }
+    const int originIndex = oldBombAt[bombOrigin.x + BOARD_SIZE * bombOrigin.y];
+    if(originIndex != -1)
+    {
         // simple case: we found the bomb (e.g. no or simple movement)
-        return oldOriginBombIndex;
+        return originIndex;
     }
 
-    // the bomb is not where it's supposed to be => it was kicked while moving. We have to backtrack it
-    int bombId = _backtrack_bomb_id(board, newObs, bombOrigin, bboard::Direction(bombMovement), bboard::BMB_TIME(b) + 1, bboard::BMB_STRENGTH(b));
+    // the bomb is not where it's supposed to be => it was kicked while moving.
+    // Search for the bomb behind the agents which could have kicked it.
+    // Example:
+    // step 0: 0   b (bomb moves left, agent moves right => kick)
+    // step 1:   0 b (bomb moves right)
+    // we want to find the original position of the bomb in step 0, which is not
+    // `current position - movement`. Note that there could be chains, i.e. a bomb
+    // can be kicked multiple times in one step by different agents.
+    const int checkTime = BMB_TIME(b) + 1;
+    const int checkRange = BMB_STRENGTH(b);
+
+    struct Candidate
+    {
+        Position position;
+        Direction direction;
+        int depth;
+    };
+
+    // depth-first search (every agent adds at most 4 candidates)
+    Candidate stack[4 * AGENT_COUNT];
+    int stackSize = 0;
+    stack[stackSize++] = {bombOrigin, Direction(bombMovement), 0};
+
+    while(stackSize > 0)
+    {
+        const Candidate c = stack[--stackSize];
+
+        // avoid infinite loops
+        if(c.depth >= AGENT_COUNT || util::IsOutOfBounds(c.position))
+            continue;
 
-    // print warning when backtracking failed (e.g. partial observability)
-    if (bombId == -1 && trackStatsErrorCounter > 0) {
-        trackStatsErrorCounter--;
-        std::cout << "Warning: could not find owner of bomb at " << bombPos << " (previous position according to movement: " << bombOrigin 
-                << ") with the TrackStats heuristic. Maybe the board is not fully visible? This message will only be repeated " << trackStatsErrorCounter << " more times." << std::endl;
-        std::cout << "Previous board:" << std::endl;
-        board->Print();
-        std::cout << "Previous bomb positions: ";
-        for (int k = 0; k < board->bombs.count; k++) {
-            std::cout << bboard::BMB_POS(board->bombs[k]) << " ";
+        const int cell = c.position.x + BOARD_SIZE * c.position.y;
+        if(board.items[c.position.y][c.position.x] == Item::BOMB)
+        {
+            // is this the bomb we are looking for?
+            const int candidateIndex = oldBombAt[cell];
+            if(candidateIndex != -1)
+            {
+                const Bomb candidate = board.bombs[candidateIndex];
+                if(BMB_STRENGTH(candidate) == checkRange && BMB_TIME(candidate) == checkTime && BMB_DIR(candidate) == (int)c.direction)
+                {
+                    return candidateIndex;
+                }
+            }
+            continue;
+        }
+
+        // an agent which moved in the direction of the bomb could have kicked it,
+        // the bomb arrived at its position from any other direction
+        if((agentMoves[cell] & (1 << (int)c.direction)) == 0)
+            continue;
+
+        // push in reverse order to check the directions in their natural order
+        for(int d = (int)Direction::RIGHT; d >= (int)Direction::UP; d--)
+        {
+            if(d == (int)c.direction)
+            {
+                // this is where the agent came from, we don't have to check this.
+                continue;
+            }
+
+            // move back one field and look for the bomb
+            stack[stackSize++] = {util::OriginPosition(c.position.x, c.position.y, Move(d)), Direction(d), c.depth + 1};
         }
-        std::cout << std::endl;
-        std::cout << "Observation:" << std::endl;
-        newObs->Print();
     }
 
-    return bombId;
+    return -1;
 }
 
 void _count_bomb_if_stats_invisible(AgentInfo& info)
@@ -652,8 +1008,11 @@ void _count_bomb_if_stats_invisible(AgentInfo& info)
     }
 }
 
-bool _has_kicked_bomb(const bboard::Board* board, const bboard::Observation* newObs, int agentID)
+bool _has_kicked_bomb(const _BombBacktracker& tracker, int agentID)
 {
+    const bboard::Board* board = &tracker.board;
+    const bboard::Observation* newObs = &tracker.newObs;
+
     const bboard::AgentInfo& info = newObs->agents[agentID];
     const bboard::AgentInfo& oldInfo = board->agents[agentID];
 
@@ -686,7 +1045,7 @@ bool _has_kicked_bomb(const bboard::Board* board, const bboard::Observation* new
     if (!bomb) {
         return false;
     }
-    int oldBombId = _backtrack_bomb_id(board, newObs, *bomb);
+    int oldBombId = tracker.Find(*bomb);
     if (oldBombId == -1) {
         return false;
     }
@@ -701,7 +1060,7 @@ bool _has_kicked_bomb(const bboard::Board* board, const bboard::Observation* new
     return true;
 }
 
-void Observation::TrackStats(const Board& oldBoard)
+void Observation::TrackStats(const Board& oldBoard, int* backtrackingErrors)
 {
     bool allStatsAreVisible = true;
     for (int i = 0; i < bboard::AGENT_COUNT; i++) {
@@ -714,6 +1073,8 @@ void Observation::TrackStats(const Board& oldBoard)
         return;
     }
 
+    const _BombBacktracker tracker(oldBoard, *this);
+
     for (int i = 0; i < bboard::AGENT_COUNT; i++) {
         bboard::AgentInfo& info = agents[i];
         const bboard::AgentInfo& oldInfo = oldBoard.agents[i];
@@ -760,7 +1121,7 @@ void Observation::TrackStats(const Board& oldBoard)
                 }
 
                 // if we see the agent kicking, then we missed a kick powerup item
-                if (!info.canKick && _has_kicked_bomb(&oldBoard, this, i))
+                if (!info.canKick && _has_kicked_bomb(tracker, i))
                 {
                     info.canKick = true;
                 } 
@@ -790,10 +1151,14 @@ void Observation::TrackStats(const Board& oldBoard)
         }
         else {
             // bomb owner is not known yet, try to find it in the old board
-            int oldBombId = _backtrack_bomb_id(&oldBoard, this, b);
+            int oldBombId = tracker.Find(b);
             if (oldBombId != -1) {
                 bombOwner = BMB_ID(oldBoard.bombs[oldBombId]);
             }
+            else if (backtrackingErrors != nullptr) {
+                // e.g. partial observability
+                (*backtrackingErrors)++;
+            }
             bool foundAgent = bombOwner >= 0 && bombOwner < bboard::AGENT_COUNT;
             if (foundAgent) {
                 bboard::SetBombID(b, bombOwner);
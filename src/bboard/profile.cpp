@@ -0,0 +1,145 @@
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+
+#include "profile.hpp"
+
+namespace bboard::profile
+{
+
+std::string SlotName(int slot)
+{
+    static const char* phaseNames[PHASE_COUNT] = {
+        "TickFlames", "FixDestPos", "ResolveDependencies", "MoveAgent", "ApplyAgentMovement",
+        "ResolveBombMovement", "MoveBombs", "TickBombs", "ExplodeBombs"
+    };
+
+    if(slot < PHASE_COUNT)
+    {
+        return phaseNames[slot];
+    }
+    return "Agent" + std::to_string(slot - PHASE_COUNT) + "::act";
+}
+
+#ifdef POMCPP_PROFILE
+
+bool Enabled()
+{
+    return true;
+}
+
+// the counters of all threads (also of finished threads)
+static std::mutex registryMutex;
+static std::vector<std::unique_ptr<ThreadCounters>> registry;
+
+ThreadCounters* RegisterThread()
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    registry.push_back(std::make_unique<ThreadCounters>());
+    return registry.back().get();
+}
+
+Counters Collect()
+{
+    Counters result;
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for(const auto& c : registry)
+    {
+        for(int i = 0; i < SLOT_COUNT; i++)
+        {
+            result.cycles[i] += c->cycles[i].load(std::memory_order_relaxed);
+            result.calls[i] += c->calls[i].load(std::memory_order_relaxed);
+        }
+    }
+    return result;
+}
+
+void Reset()
+{
+    // only reliable if no other thread is profiling right now
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for(const auto& c : registry)
+    {
+        for(int i = 0; i < SLOT_COUNT; i++)
+        {
+            c->cycles[i].store(0, std::memory_order_relaxed);
+            c->calls[i].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+#else
+
+bool Enabled()
+{
+    return false;
+}
+
+Counters Collect()
+{
+    return Counters();
+}
+
+void Reset() {}
+
+#endif // POMCPP_PROFILE
+
+void Report(std::ostream& out)
+{
+    if(!Enabled())
+    {
+        out << "Profiling is disabled (build with -DPOMCPP_PROFILE=ON)." << std::endl;
+        return;
+    }
+
+    const Counters c = Collect();
+    uint64_t stepCycles = 0;
+    for(int i = 0; i < PHASE_COUNT; i++)
+    {
+        stepCycles += c.cycles[i];
+    }
+
+    const std::ios_base::fmtflags flags = out.flags();
+    const char fill = out.fill(' ');
+
+    out << std::left << std::setw(22) << "Slot"
+        << std::right << std::setw(16) << "Cycles"
+        << std::setw(12) << "Calls"
+        << std::setw(14) << "Cycles/Call"
+        << std::setw(9) << "Step %" << std::endl;
+
+    for(int i = 0; i < SLOT_COUNT; i++)
+    {
+        out << std::left << std::setw(22) << SlotName(i)
+            << std::right << std::setw(16) << c.cycles[i]
+            << std::setw(12) << c.calls[i]
+            << std::setw(14) << std::fixed << std::setprecision(1)
+            << (c.calls[i] == 0 ? 0.0 : double(c.cycles[i]) / c.calls[i]);
+
+        if(i < PHASE_COUNT)
+        {
+            out << std::setw(9) << (stepCycles == 0 ? 0.0 : 100.0 * c.cycles[i] / stepCycles);
+        }
+        out << std::endl;
+    }
+
+    out.flags(flags);
+    out.fill(fill);
+}
+
+std::string ReportJSON()
+{
+    const Counters c = Collect();
+    nlohmann::json j;
+    j["enabled"] = Enabled();
+    for(int i = 0; i < SLOT_COUNT; i++)
+    {
+        j["slots"][SlotName(i)] = {{"cycles", c.cycles[i]}, {"calls", c.calls[i]}};
+    }
+    return j.dump();
+}
+
+}
@@ -0,0 +1,254 @@
+#include <algorithm>
+
+#include "bboard.hpp"
+#include "rollout_engine.hpp"
+#include "profile.hpp"
+
+namespace bboard
+{
+
+WorkStealingPool::WorkStealingPool(int threadCount)
+{
+    if(threadCount <= 0)
+    {
+        threadCount = std::max(1, (int)std::thread::hardware_concurrency());
+    }
+
+    ranges = std::make_unique<WorkerRange[]>(threadCount);
+    threads.reserve(threadCount);
+    for(int i = 0; i < threadCount; i++)
+    {
+        threads.emplace_back(&WorkStealingPool::_workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    wake.notify_all();
+
+    for(std::thread& t : threads)
+    {
+        t.join();
+    }
+}
+
+int WorkStealingPool::GetThreadCount() const
+{
+    return (int)threads.size();
+}
+
+void WorkStealingPool::ParallelFor(int count, const std::function<void(int, int)>& f)
+{
+    if(count <= 0)
+        return;
+
+    const int threadCount = GetThreadCount();
+    auto allParked = [this, threadCount]{ return remaining == 0 && parked == threadCount; };
+
+    // the ranges must not be modified while a worker is still searching for work
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, allParked);
+
+    job = &f;
+    error = nullptr;
+    remaining = count;
+
+    // one contiguous block per worker
+    for(int i = 0; i < threadCount; i++)
+    {
+        std::lock_guard<std::mutex> rangeLock(ranges[i].mutex);
+        ranges[i].begin = (int)((long)count * i / threadCount);
+        ranges[i].end = (int)((long)count * (i + 1) / threadCount);
+    }
+
+    generation++;
+    wake.notify_all();
+    done.wait(lock, allParked);
+
+    job = nullptr;
+    if(error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+bool WorkStealingPool::_nextIndex(int worker, int& index)
+{
+    WorkerRange& own = ranges[worker];
+    {
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if(own.begin < own.end)
+        {
+            index = own.begin++;
+            return true;
+        }
+    }
+
+    // steal the back half of the block of another worker
+    const int threadCount = GetThreadCount();
+    for(int i = 1; i < threadCount; i++)
+    {
+        WorkerRange& victim = ranges[(worker + i) % threadCount];
+        int begin, end;
+        {
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if(victim.begin >= victim.end)
+                continue;
+
+            begin = victim.begin + (victim.end - victim.begin) / 2;
+            end = victim.end;
+            victim.end = begin;
+        }
+
+        std::lock_guard<std::mutex> lock(own.mutex);
+        index = begin;
+        own.begin = begin + 1;
+        own.end = end;
+        return true;
+    }
+
+    return false;
+}
+
+void WorkStealingPool::_workerLoop(int worker)
+{
+    uint64_t seenGeneration = 0;
+    while(true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            parked++;
+            done.notify_all();
+            wake.wait(lock, [this, seenGeneration]{ return stop || generation != seenGeneration; });
+            parked--;
+            if(stop)
+                return;
+            seenGeneration = generation;
+        }
+
+        int index;
+        while(_nextIndex(worker, index))
+        {
+            try
+            {
+                (*job)(index, worker);
+            }
+            catch(...)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if(!error)
+                {
+                    error = std::current_exception();
+                }
+            }
+            remaining--;
+        }
+    }
+}
+
+/**
+ * @brief _mixSeed Derives independent seeds (splitmix64 finalizer).
+ */
+inline long _mixSeed(long seed, long index)
+{
+    uint64_t z = (uint64_t)seed + (uint64_t)(index + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return (long)((z ^ (z >> 31)) >> 1);
+}
+
+/**
+ * @brief The outcome of a single rollout.
+ */
+struct _RolloutOutcome
+{
+    bool finished;
+    bool isDraw;
+    bool winner[AGENT_COUNT];
+    int steps;
+};
+
+RolloutEngine::RolloutEngine(int threadCount) : pool(threadCount) {}
+
+int RolloutEngine::GetThreadCount() const
+{
+    return pool.GetThreadCount();
+}
+
+RolloutResult RolloutEngine::Run(const State& root, const AgentFactory& policy, int rollouts, long seed,
+                                 int maxSteps, const ObservationParameters& obsParams)
+{
+    // outcomes are stored per rollout, the result does not depend on the schedule
+    std::vector<_RolloutOutcome> outcomes(std::max(rollouts, 0));
+
+    pool.ParallelFor(rollouts, [&](int r, int)
+    {
+        std::unique_ptr<Agent> agents[AGENT_COUNT];
+        for(int i = 0; i < AGENT_COUNT; i++)
+        {
+            agents[i] = policy(i, _mixSeed(seed, (long)r * AGENT_COUNT + i));
+            agents[i]->id = i;
+            agents[i]->reset();
+        }
+
+        auto state = std::make_unique<State>(root);
+        Observation obs;
+        Move moves[AGENT_COUNT];
+
+        int steps = 0;
+        for(; steps < maxSteps && !state->finished; steps++)
+        {
+            for(int i = 0; i < AGENT_COUNT; i++)
+            {
+                if(state->agents[i].dead)
+                {
+                    moves[i] = Move::IDLE;
+                    continue;
+                }
+
+                Observation::Get(*state, i, obsParams, obs);
+                POMCPP_PROFILE_ACT(i);
+                moves[i] = agents[i]->act(&obs);
+            }
+            state->Step(moves);
+        }
+
+        _RolloutOutcome& o = outcomes[r];
+        o.finished = state->finished;
+        o.isDraw = state->isDraw;
+        o.steps = steps;
+        for(int i = 0; i < AGENT_COUNT; i++)
+        {
+            o.winner[i] = state->IsWinner(i);
+        }
+    });
+
+    RolloutResult result;
+    for(const _RolloutOutcome& o : outcomes)
+    {
+        result.rollouts++;
+        result.steps += o.steps;
+        if(!o.finished)
+        {
+            result.unfinished++;
+            continue;
+        }
+
+        if(o.isDraw)
+        {
+            result.draws++;
+        }
+        for(int i = 0; i < AGENT_COUNT; i++)
+        {
+            result.wins[i] += o.winner[i];
+            result.returns[i] += o.winner[i] ? 1 : -1;
+        }
+    }
+    return result;
+}
+
+}
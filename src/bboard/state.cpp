@@ -1,7 +1,9 @@
 #include <iostream>
+#include <stdexcept>
 
 #include "bboard.hpp"
 #include "step_utility.hpp"
+#include "profile.hpp"
 
 using namespace bboard;
 
@@ -49,34 +51,19 @@ inline T _selectRandomInPlace(T* arr, int count, RNG& rng)
     return b;
 }
 
-void State::Init(GameMode gameMode, long boardSeed, long agentPositionSeed, int numRigid, int numWood, int numPowerUps, int padding, int breathingRoomSize)
+void bboard::GenerateBoard(int items[BOARD_SIZE][BOARD_SIZE], long boardSeed, int numRigid, int numWood, int numPowerUps, int padding, int breathingRoomSize)
 {
-    std::mt19937 rng;
+    std::mt19937 rng(boardSeed);
 
     // initialize everything as passages
     std::fill_n(&items[0][0], BOARD_SIZE * BOARD_SIZE, (int)Item::PASSAGE);
 
-    // insert agents at their respective positions
-    std::array<int, 4> f = {0, 1, 2, 3};
-    if(agentPositionSeed != -1)
-    {
-        rng.seed(agentPositionSeed);
-        std::shuffle(f.begin(), f.end(), rng);
-    }
-    PutAgentsInCorners(f[0], f[1], f[2], f[3], padding);
+    // the coordinates are stored on the stack (there are at most BOARD_SIZE^2)
+    Position woodCoordinates[BOARD_SIZE * BOARD_SIZE];
+    int woodCount = 0;
 
-    // init teams
-    SetTeams(agents, gameMode);
-
-    // create the board
-
-    rng.seed(boardSeed);
-
-    std::vector<Position> woodCoordinates;
-    woodCoordinates.reserve(numWood);
-
-    std::vector<Position> coordinates;
-    coordinates.reserve(BOARD_SIZE * (BOARD_SIZE - 4) + 8 * padding + 4);
+    Position coordinates[BOARD_SIZE * BOARD_SIZE];
+    int coordinateCount = 0;
 
     // create a "breathing room" around agents of length freeSpaceUntil
     // and place wooden boxes to form passages between them.
@@ -112,14 +99,14 @@ void State::Init(GameMode gameMode, long boardSeed, long agentPositionSeed, int
                 else if (tmpNorm > padding) {
                     tmpNorm = -1;
                     items[i][j] = Item::WOOD;
-                    woodCoordinates.push_back((Position) {i, j});
+                    woodCoordinates[woodCount++] = (Position) {i, j};
                     numWood--;
                     continue;
                 }
             }
 
             // remember this coordinate, we can randomly add stuff later
-            coordinates.push_back((Position) {i, j});
+            coordinates[coordinateCount++] = (Position) {i, j};
         }
     }
 
@@ -127,7 +114,7 @@ void State::Init(GameMode gameMode, long boardSeed, long agentPositionSeed, int
     // create rigid walls
     while (numRigid > 0) {
         // select random coordinate
-        Position coord = _selectRandomInPlace<false>(coordinates.data() + i, coordinates.size() - i, rng);
+        Position coord = _selectRandomInPlace<false>(coordinates + i, coordinateCount - i, rng);
         i++;
 
         // create wall
@@ -137,11 +124,11 @@ void State::Init(GameMode gameMode, long boardSeed, long agentPositionSeed, int
 
     // create wooden blocks (keep index)
     while (numWood > 0) {
-        Position coord = _selectRandomInPlace<false>(coordinates.data() + i, coordinates.size() - i, rng);
+        Position coord = _selectRandomInPlace<false>(coordinates + i, coordinateCount - i, rng);
         i++;
 
         items[coord.y][coord.x] = Item::WOOD;
-        woodCoordinates.push_back(coord);
+        woodCoordinates[woodCount++] = coord;
         numWood--;
     }
 
@@ -149,125 +136,458 @@ void State::Init(GameMode gameMode, long boardSeed, long agentPositionSeed, int
     std::uniform_int_distribution<int> choosePwp(1, 3);
     // insert items
     while (numPowerUps > 0) {
-        Position coord = _selectRandomInPlace<false>(woodCoordinates.data() + i, woodCoordinates.size() - i, rng);
+        Position coord = _selectRandomInPlace<false>(woodCoordinates + i, woodCount - i, rng);
         i++;
 
         items[coord.y][coord.x] = Item::WOOD + choosePwp(rng);
         numPowerUps--;
     }
+}
+
+void State::Init(GameMode gameMode, long boardSeed, long agentPositionSeed, int numRigid, int numWood, int numPowerUps, int padding, int breathingRoomSize)
+{
+    GenerateBoard(items, boardSeed, numRigid, numWood, numPowerUps, padding, breathingRoomSize);
+    _initAgents(gameMode, agentPositionSeed, padding);
+}
+
+void State::InitFromBoard(GameMode gameMode, const int board[BOARD_SIZE][BOARD_SIZE], long agentPositionSeed, int padding)
+{
+    std::copy_n(&board[0][0], BOARD_SIZE * BOARD_SIZE, &items[0][0]);
+    _initAgents(gameMode, agentPositionSeed, padding);
+}
+
+void State::_initAgents(GameMode gameMode, long agentPositionSeed, int padding)
+{
+    // insert agents at their respective positions
+    std::array<int, 4> f = {0, 1, 2, 3};
+    if(agentPositionSeed != -1)
+    {
+        std::mt19937 rng(agentPositionSeed);
+        std::shuffle(f.begin(), f.end(), rng);
+    }
+    // the board generation may put blocks on the agents if the breathing
+    // room is smaller than the padding, these blocks hide the agents
+    const int min = padding;
+    const int max = BOARD_SIZE - (1 + padding);
+    const int corners[4] = {items[min][min], items[min][max], items[max][max], items[max][min]};
+    PutAgentsInCorners(f[0], f[1], f[2], f[3], padding);
+    if(corners[0] != Item::PASSAGE) items[min][min] = corners[0];
+    if(corners[1] != Item::PASSAGE) items[min][max] = corners[1];
+    if(corners[2] != Item::PASSAGE) items[max][max] = corners[2];
+    if(corners[3] != Item::PASSAGE) items[max][min] = corners[3];
+
+    // init teams
+    SetTeams(agents, gameMode);
 
     // this is the initial state
     timeStep = 0;
     currentFlameTime = 0;
+
+    RecomputeHash();
+    ResetDirtyCells();
 }
 
 void State::Step(Move* moves)
+{
+    StepT<DefaultRules>(moves);
+}
+
+template<typename Rules>
+void State::StepT(Move* moves)
 {
     // do not execute step on terminal states
     if(finished)
         return;
 
-    int aliveAgentsBefore = aliveAgents;
+#ifdef DEBUG_STATE_HASH
+    // the state could have been modified directly, start with a valid hash
+    RecomputeHash();
+#endif
+
+    ResetDirtyCells();
 
     // tick flames (they might disappear)
-    util::TickFlames(this);
+    {
+        POMCPP_PROFILE_SCOPE(profile::TICK_FLAMES);
+        util::TickFlames(this);
+    }
+
+    StepAfterFlameTick<Rules>(moves);
+}
+
+template<typename Rules>
+void State::StepAfterFlameTick(Move* moves)
+{
+    if(finished)
+        return;
+
+    int aliveAgentsBefore = aliveAgents;
 
     // resolve collisions in player movement
 
     Position oldPos[AGENT_COUNT];
     Position originalDestPos[AGENT_COUNT];
-    Position destPos[AGENT_COUNT];
-    bool dead[AGENT_COUNT];
 
     util::FillPositions(this, oldPos);
     util::FillDestPos(this, moves, originalDestPos);
-    std::copy_n(originalDestPos, AGENT_COUNT, destPos);
-    util::FillAgentDead(this, dead);
 
-    const bool agentMoveCollision = util::FixDestPos<true>(oldPos, destPos, AGENT_COUNT, dead);
+    if(util::IsCollisionFreeStep<Rules>(this, oldPos, originalDestPos))
+    {
+        // fast path: all agents can be moved independently and no bomb moves
+        {
+            POMCPP_PROFILE_SCOPE(profile::MOVE_AGENT);
+            for(int i = 0; i < AGENT_COUNT; i++)
+            {
+                util::MoveAgent<Rules>(this, i, moves[i], originalDestPos[i], false);
+            }
+        }
+        {
+            POMCPP_PROFILE_SCOPE(profile::APPLY_AGENT_MOVEMENT);
+            util::ApplyAgentMovement<Rules>(this);
+        }
+        if(Rules::Kick)
+        {
+            POMCPP_PROFILE_SCOPE(profile::MOVE_BOMBS);
+            util::ResetBombFlags(this);
+        }
+    }
+    else
+    {
+        Position destPos[AGENT_COUNT];
+        bool dead[AGENT_COUNT];
+        std::copy_n(originalDestPos, AGENT_COUNT, destPos);
+        util::FillAgentDead(this, dead);
 
-    // calculate dependencies in the player movement
+        {
+            POMCPP_PROFILE_SCOPE(profile::FIX_DEST_POS);
+            util::FixDestPos<true>(oldPos, destPos, AGENT_COUNT, dead);
+        }
 
-    int dependency[AGENT_COUNT];
-    std::fill_n(dependency, AGENT_COUNT, -1);
-    int roots[AGENT_COUNT];
-    std::fill_n(roots, AGENT_COUNT, -1);
+        // first update the player positions
+        util::MoveAgents<Rules>(this, moves, destPos);
 
-    // the amount of chain roots
-    const int rootNumber = util::ResolveDependencies(this, destPos, dependency, roots);
+        // then update the bomb positions
 
-    int rootIdx = 0;
-    int i = rootNumber == 0 ? 0 : roots[0]; // no roots -> start from 0
+        // resolve conflicting bomb destinations (and reset affected agents)
+        Position bombDestinations[MAX_BOMBS];
+        {
+            POMCPP_PROFILE_SCOPE(profile::RESOLVE_BOMB_MOVEMENT);
+            util::FillBombDestPos(this, bombDestinations);
+            util::ResolveBombMovement<Rules>(this, oldPos, originalDestPos, bombDestinations);
+        }
 
-    // ouroboros: every agent wants to move to the current position of a different agent
-    // A > B
-    // ^   v
-    // D < C
-    bool ouroboros = rootNumber == 0;
+        // apply agent movement
+        {
+            POMCPP_PROFILE_SCOPE(profile::APPLY_AGENT_MOVEMENT);
+            util::ApplyAgentMovement<Rules>(this);
+        }
 
-    // first update the player positions
+        // move the bombs (bombs can also explode if they move into flames)
+        {
+            POMCPP_PROFILE_SCOPE(profile::MOVE_BOMBS);
+            util::MoveBombs<Rules>(this, bombDestinations);
+        }
+    }
 
-    // apply the moves in the correct order
-    // iterates 4 times but the index i jumps around the dependencies
-    for(int _ = 0; _ < AGENT_COUNT; _++, i = dependency[i])
+    // let bombs explode
     {
-        if(i == -1)
+        POMCPP_PROFILE_SCOPE(profile::TICK_BOMBS);
+        util::TickBombs(this);
+    }
+    {
+        POMCPP_PROFILE_SCOPE(profile::EXPLODE_BOMBS);
+        util::ExplodeBombs(this);
+    }
+
+    // advance timestep
+    timeStep++;
+
+    if(aliveAgentsBefore != aliveAgents)
+    {
+        // the number of agents has changed, check if some agent(s) won the game
+        util::CheckTerminalState<Rules>(*this);
+    }
+
+    RehashAgentsAndBombs();
+
+#ifdef DEBUG_STATE_HASH
+    if(hash != ComputeHash())
+    {
+        throw std::runtime_error("Incremental state hash does not match the recomputed hash after timestep " + std::to_string(timeStep));
+    }
+#endif
+}
+
+template void State::StepT<StepRules<true, true, true>>(Move*);
+template void State::StepT<StepRules<true, true, false>>(Move*);
+template void State::StepT<StepRules<true, false, true>>(Move*);
+template void State::StepT<StepRules<true, false, false>>(Move*);
+template void State::StepT<StepRules<false, true, true>>(Move*);
+template void State::StepT<StepRules<false, true, false>>(Move*);
+template void State::StepT<StepRules<false, false, true>>(Move*);
+template void State::StepT<StepRules<false, false, false>>(Move*);
+template void State::StepAfterFlameTick<StepRules<true, true, true>>(Move*);
+template void State::StepAfterFlameTick<StepRules<true, true, false>>(Move*);
+template void State::StepAfterFlameTick<StepRules<true, false, true>>(Move*);
+template void State::StepAfterFlameTick<StepRules<true, false, false>>(Move*);
+template void State::StepAfterFlameTick<StepRules<false, true, true>>(Move*);
+template void State::StepAfterFlameTick<StepRules<false, true, false>>(Move*);
+template void State::StepAfterFlameTick<StepRules<false, false, true>>(Move*);
+template void State::StepAfterFlameTick<StepRules<false, false, false>>(Move*);
+
+void State::StepRecorded(Move* moves, StepJournal& journal)
+{
+    journal.touched.Reset();
+    journal.cellCount = 0;
+    journal.agentMask = 0;
+    journal.agentCount = 0;
+    journal.bombSlotsTouched.Reset();
+    journal.bombSlotCount = 0;
+    journal.flamesTouched.Reset();
+    journal.flameRecordCount = 0;
+    journal.flameSlotsTouched.Reset();
+    journal.flameSlotCount = 0;
+
+    journal.bombIndex = bombs.index;
+    journal.bombCount = bombs.count;
+    bombs.CopyTo(journal.bombs);
+
+    journal.flameIndex = flames.index;
+    journal.flameCount = flames.count;
+    std::copy_n(flameBuckets, FLAME_LIFETIME, journal.flameBuckets);
+
+    journal.timeStep = timeStep;
+    journal.currentFlameTime = currentFlameTime;
+    journal.finished = finished;
+    journal.isDraw = isDraw;
+    journal.winningTeam = winningTeam;
+    journal.winningAgent = winningAgent;
+    journal.aliveAgents = aliveAgents;
+
+    journal.hash = hash;
+    std::copy_n(flameGroupKeys, FLAME_LIFETIME, journal.flameGroupKeys);
+    std::copy_n(agentKeys, AGENT_COUNT, journal.agentKeys);
+    journal.bombKeys = bombKeys;
+
+    // all other modifications are recorded when they happen
+    activeJournal = &journal;
+    Step(moves);
+    activeJournal = nullptr;
+}
+
+void State::Undo(const StepJournal& journal)
+{
+    for(int i = 0; i < journal.cellCount; i++)
+    {
+        const int cell = journal.cells[i];
+        items[cell / BOARD_SIZE][cell % BOARD_SIZE] = journal.oldItems[i];
+    }
+
+    for(int i = 0; i < journal.agentCount; i++)
+    {
+        agents[journal.agentIDs[i]] = journal.oldAgents[i];
+    }
+
+    // restore the alive bombs at their original slots in the queue
+    const int firstBombPartition = std::min(journal.bombCount, MAX_BOMBS - journal.bombIndex);
+    std::copy_n(journal.bombs, firstBombPartition, &bombs.queue[journal.bombIndex]);
+    std::copy_n(journal.bombs + firstBombPartition, journal.bombCount - firstBombPartition, &bombs.queue[0]);
+    bombs.index = journal.bombIndex;
+    bombs.count = journal.bombCount;
+    for(int i = 0; i < journal.bombSlotCount; i++)
+    {
+        bombSlots[journal.bombSlotCells[i]] = journal.oldBombSlots[i];
+    }
+
+    for(int i = 0; i < journal.flameRecordCount; i++)
+    {
+        flames.queue[journal.flameQueueSlots[i]] = journal.oldFlames[i];
+    }
+    flames.index = journal.flameIndex;
+    flames.count = journal.flameCount;
+    std::copy_n(journal.flameBuckets, FLAME_LIFETIME, flameBuckets);
+    for(int i = 0; i < journal.flameSlotCount; i++)
+    {
+        flameSlots[journal.flameSlotCells[i]] = journal.oldFlameSlots[i];
+    }
+
+    timeStep = journal.timeStep;
+    currentFlameTime = journal.currentFlameTime;
+    finished = journal.finished;
+    isDraw = journal.isDraw;
+    winningTeam = journal.winningTeam;
+    winningAgent = journal.winningAgent;
+    aliveAgents = journal.aliveAgents;
+
+    hash = journal.hash;
+    std::copy_n(journal.flameGroupKeys, FLAME_LIFETIME, flameGroupKeys);
+    std::copy_n(journal.agentKeys, AGENT_COUNT, agentKeys);
+    bombKeys = journal.bombKeys;
+}
+
+/**
+ * @brief _toggleFlameKey Adds (or removes) the key of a flame at (x, y)
+ * with the given remaining lifetime to the hash of the state.
+ */
+inline void _toggleFlameKey(State& state, int x, int y, int timeLeft)
+{
+    const uint64_t key = zobrist::keys.flameKeys[x + BOARD_SIZE * y];
+    state.hash ^= zobrist::FlameKey(key, timeLeft);
+    state.flameGroupKeys[timeLeft - 1] ^= key;
+}
+
+/**
+ * @brief _computeHash Computes the hash of the given state from scratch.
+ * The partial keys are returned in the remaining arguments.
+ */
+uint64_t _computeHash(const State& state, uint64_t flameGroupKeys[FLAME_LIFETIME], uint64_t agentKeys[AGENT_COUNT], uint64_t& bombKeys)
+{
+    uint64_t hash = 0;
+    for(int y = 0; y < BOARD_SIZE; y++)
+    {
+        for(int x = 0; x < BOARD_SIZE; x++)
         {
-            rootIdx++;
-            i = roots[rootIdx];
+            hash ^= zobrist::ItemKey(x, y, state.items[y][x]);
         }
+    }
 
-        util::MoveAgent(this, i, moves[i], destPos[i], ouroboros);
+    // flames are stored with absolute or additive (optimized) lifetimes
+    std::fill_n(flameGroupKeys, FLAME_LIFETIME, 0);
+    int cumulativeTime = 0;
+    for(int i = 0; i < state.flames.count; i++)
+    {
+        const Flame& f = state.flames[i];
+        cumulativeTime += f.timeLeft;
+        int timeLeft = state.currentFlameTime == -1 ? f.timeLeft : cumulativeTime;
+        timeLeft = std::clamp(timeLeft, 1, FLAME_LIFETIME);
+        flameGroupKeys[timeLeft - 1] ^= zobrist::keys.flameKeys[f.position.x + BOARD_SIZE * f.position.y];
+    }
+    for(int t = 0; t < FLAME_LIFETIME; t++)
+    {
+        hash ^= zobrist::FlameKey(flameGroupKeys[t], t + 1);
     }
 
-    // then update the bomb positions
+    for(int i = 0; i < AGENT_COUNT; i++)
+    {
+        agentKeys[i] = zobrist::AgentKey(i, state.agents[i]);
+        hash ^= agentKeys[i];
+    }
 
-    // resolve conflicting bomb destinations (and reset affected agents)
-    Position bombDestinations[bombs.count];
-    util::FillBombDestPos(this, bombDestinations);
-    util::ResolveBombMovement(this, oldPos, originalDestPos, bombDestinations);
+    bombKeys = 0;
+    for(int i = 0; i < state.bombs.count; i++)
+    {
+        bombKeys ^= zobrist::BombKey(state.bombs[i]);
+    }
+    hash ^= bombKeys;
 
-    // apply agent movement
+    return hash;
+}
+
+uint64_t State::ComputeHash() const
+{
+    uint64_t groups[FLAME_LIFETIME], agentKeys[AGENT_COUNT], bombKeys;
+    return _computeHash(*this, groups, agentKeys, bombKeys);
+}
+
+void State::RecomputeHash()
+{
+    hash = _computeHash(*this, flameGroupKeys, agentKeys, bombKeys);
+}
+
+void State::RehashAgentsAndBombs()
+{
     for(int i = 0; i < AGENT_COUNT; i++)
     {
-        const AgentInfo& info = agents[i];
+        RehashAgent(i);
+    }
 
-        if(!info.visible || info.dead) continue;
+    uint64_t newBombKeys = 0;
+    for(int i = 0; i < bombs.count; i++)
+    {
+        newBombKeys ^= zobrist::BombKey(bombs[i]);
+    }
+    hash ^= bombKeys ^ newBombKeys;
+    bombKeys = newBombKeys;
+}
 
-        Position pos = agents[i].GetPos();
-        int itemOnDestination = items[pos.y][pos.x];
-        
-        // agent moved into flame
-        if(IS_FLAME(itemOnDestination))
-        {
-            Kill(i);
-            continue;
-        }
-        // collect power-ups
-        else if(IS_POWERUP(itemOnDestination))
-        {
-            util::ConsumePowerup(agents[i], itemOnDestination);
-        }
+void State::PutBomb(int x, int y, int agentID, int strength, int lifeTime, bool setItem)
+{
+    if(setItem)
+    {
+        if(activeJournal != nullptr)
+            activeJournal->RecordCell(x, y, items[y][x]);
 
-        // update new agent position
-        items[pos.y][pos.x] = Item::AGENT0 + i;
+        dirtyCells.Set(x + BOARD_SIZE * y);
+        hash ^= zobrist::ItemKey(x, y, items[y][x]) ^ zobrist::ItemKey(x, y, Item::BOMB);
     }
 
-    // move the bombs (bombs can also explode if they move into flames)
-    util::MoveBombs(this, bombDestinations);
+    if(activeJournal != nullptr)
+    {
+        const int cell = x + BOARD_SIZE * y;
+        activeJournal->RecordBombSlot(cell, bombSlots[cell]);
+        activeJournal->RecordAgent(agentID, agents[agentID]);
+    }
 
-    // let bombs explode
-    util::TickBombs(this);
-    util::ExplodeBombs(this);
+    Board::PutBomb(x, y, agentID, strength, lifeTime, setItem);
 
-    // advance timestep
-    timeStep++;
+    const uint64_t key = zobrist::BombKey(bombs[bombs.count - 1]);
+    hash ^= key;
+    bombKeys ^= key;
+    RehashAgent(agentID);
+}
 
-    if(aliveAgentsBefore != aliveAgents)
+void State::MoveBomb(int index, Position pos)
+{
+    if(activeJournal != nullptr)
     {
-        // the number of agents has changed, check if some agent(s) won the game
-        util::CheckTerminalState(*this);
+        const int cell = pos.x + BOARD_SIZE * pos.y;
+        activeJournal->RecordBombSlot(cell, bombSlots[cell]);
+    }
+
+    Board::MoveBomb(index, pos);
+}
+
+void State::RemoveBomb(int index)
+{
+    if(activeJournal != nullptr)
+    {
+        // the following bombs are shifted, which updates their slots
+        for(int i = index + 1; index > 0 && i < bombs.count; i++)
+        {
+            const Bomb b = bombs[i];
+            const int cell = BMB_POS_X(b) + BOARD_SIZE * BMB_POS_Y(b);
+            activeJournal->RecordBombSlot(cell, bombSlots[cell]);
+        }
+    }
+
+    Board::RemoveBomb(index);
+}
+
+void State::RemoveFlame(int index)
+{
+    if(activeJournal != nullptr)
+    {
+        // the removal modifies the flames from the start of the bucket of
+        // the removed flame to the end of the queue
+        int start = 0;
+        for(int b = 0; start + flameBuckets[b] <= index; b++)
+        {
+            start += flameBuckets[b];
+        }
+
+        for(int i = start; i < flames.count; i++)
+        {
+            RecordFlame(i);
+            if(i > index)
+            {
+                const Position& p = flames[i].position;
+                const int cell = p.x + BOARD_SIZE * p.y;
+                activeJournal->RecordFlameSlot(cell, flameSlots[cell]);
+            }
+        }
     }
+
+    Board::RemoveFlame(index);
 }
 
 void State::ExplodeBombAt(int i)
@@ -275,20 +595,29 @@ void State::ExplodeBombAt(int i)
     Bomb b = bombs[i];
 
     // remove the bomb
-    if (i == 0)
+    const uint64_t key = zobrist::BombKey(b);
+    hash ^= key;
+    bombKeys ^= key;
+    RemoveBomb(i);
+
+    // spawn flames, this may trigger other explosions
+    int x = BMB_POS_X(b);
+    int y = BMB_POS_Y(b);
+    if(activeEvents != nullptr)
     {
-        bombs.PopElem();
+        RecordEvent(StepEventType::BombExploded, BMB_ID(b), -1, 0, {x, y});
+
+        // attribute kills and destroyed wood to the owner of this bomb
+        const int previousOwner = activeEvents->explodingBombOwner;
+        activeEvents->explodingBombOwner = BMB_ID(b);
+        SpawnFlames(x, y, BMB_STRENGTH(b));
+        activeEvents->explodingBombOwner = previousOwner;
     }
     else
     {
-        bombs.RemoveAt(i);
+        SpawnFlames(x, y, BMB_STRENGTH(b));
     }
 
-    // spawn flames, this may trigger other explosions
-    int x = BMB_POS_X(b);
-    int y = BMB_POS_Y(b);
-    SpawnFlames(x, y, BMB_STRENGTH(b));
-
     EventBombExploded(b);
 }
 
@@ -296,74 +625,53 @@ void State::ExplodeBombAt(int i)
  * @brief _cleanFlameSpawnPosition Checks whether a flame can be spawned at the specified position (x, y).
  * If there exists a flame object at (x, y) with a different timeLeft, the existing flame is removed.
  *
- * @param flames The flames of the state
+ * @param board The state
  * @param boardItem The board item at (x, y)
  * @param x The x coordinate
  * @param y The y coordinate
  * @param timeStep The current timestep
  * @param outSpawnFlame Returns whether we can spawn a new flame at (x, y)
  * @param outContinueFlameSpawn Returns whether the flame spawning can be continued (abort when encountering a destroyed wood block)
+ * @param outRemovedTimeLeft Returns the remaining lifetime of the removed flame (0 if no flame has been removed)
  */
-template <int count>
-void _cleanFlameSpawnPosition(FixedQueue<Flame, count>& flames, const int boardItem, const int x, const int y, const int timeStep, bool& outSpawnFlame, bool& outContinueFlameSpawn)
+inline void _cleanFlameSpawnPosition(State& board, const int boardItem, const int x, const int y, const int timeStep, bool& outSpawnFlame, bool& outContinueFlameSpawn, int& outRemovedTimeLeft)
 {
-    if(IS_FLAME(boardItem))
-    {
-        // find the old flame object for this position
-        int flameId = bboard::FLAME_ID(boardItem);
-        // start from the back to save time finding the correct index
-        int cumulativeFlameTime = 0;
-        for(int i = 0; i < flames.count; i++)
-        {
-            Flame& f = flames[i];
-            cumulativeFlameTime += f.timeLeft;
-            if(f.position.x == x && f.position.y == y)
-            {
-                // we found the correct flame object
-                if(timeStep == f.destroyedWoodAtTimeStep)
-                {
-                    // the existing flame destroyed some wood block at this timestep, stop here
-                    outContinueFlameSpawn = false;
-                    outSpawnFlame = false;
-                    return;
-                }
+    outRemovedTimeLeft = 0;
+    outContinueFlameSpawn = true;
+    outSpawnFlame = true;
 
-                if(cumulativeFlameTime == FLAME_LIFETIME)
-                {
-                    // skip this flame, there already is a flame with the same lifetime
-                    outContinueFlameSpawn = true;
-                    outSpawnFlame = false;
-                    return;
-                }
+    if(!IS_FLAME(boardItem))
+    {
+        // simply continue spawning flames
+        return;
+    }
 
-                // the lifetime changes. Due to the ordering, we have to remove the old flame
-                int remainingTimeLeft = f.timeLeft;
-                if(i == 0)
-                {
-                    flames.PopElem();
-                }
-                else
-                {
-                    flames.RemoveAt(i);
-                }
+    // find the old flame object for this position
+    const int i = board.GetFlameIndex(x, y);
+    if(i == -1)
+    {
+        return;
+    }
 
-                // warning: flames array has been modified
-                if(i < flames.count)
-                {
-                    // the next flame in the queue (if it exists) has to get the time of the frame
-                    flames[i].timeLeft += remainingTimeLeft;
-                }
+    if(timeStep == board.flames[i].destroyedWoodAtTimeStep)
+    {
+        // the existing flame destroyed some wood block at this timestep, stop here
+        outContinueFlameSpawn = false;
+        outSpawnFlame = false;
+        return;
+    }
 
-                outContinueFlameSpawn = true;
-                outSpawnFlame = true;
-                return;
-            }
-        }
+    const int lifetime = board.GetFlameLifetime(i);
+    if(lifetime == FLAME_LIFETIME)
+    {
+        // skip this flame, there already is a flame with the same lifetime
+        outSpawnFlame = false;
+        return;
     }
 
-    // simply continue spawning flames
-    outContinueFlameSpawn = true;
-    outSpawnFlame = true;
+    // the lifetime changes. The new flame belongs to another bucket, remove the old flame
+    outRemovedTimeLeft = lifetime;
+    board.RemoveFlame(i);
 }
 
 bool State::SpawnFlameItem(int x, int y, bool isCenterFlame)
@@ -383,28 +691,38 @@ bool State::SpawnFlameItem(int x, int y, bool isCenterFlame)
     {
         // chain explosions (do not chain self)
         // note: bombs can also be "hidden" below agents
-        for(int i = 0; i < bombs.count; i++)
+        int i = GetBombIndex(x, y);
+        if(i != -1)
         {
-            Position bPos = BMB_POS(bombs[i]);
-            if(bPos.x == x && bPos.y == y)
-            {
-                ExplodeBombAt(i);
-                return true;
-            }
+            ExplodeBombAt(i);
+            return true;
         }
     }
 
     bool spawnFlame = false, continueSpawn = false;
-    _cleanFlameSpawnPosition(flames, boardItem, x, y, timeStep, spawnFlame, continueSpawn);
+    int removedTimeLeft = 0;
+    _cleanFlameSpawnPosition(*this, boardItem, x, y, timeStep, spawnFlame, continueSpawn, removedTimeLeft);
+    if(removedTimeLeft > 0)
+    {
+        _toggleFlameKey(*this, x, y, removedTimeLeft);
+    }
 
     if(spawnFlame)
     {
+        if(activeJournal != nullptr)
+        {
+            const int cell = x + BOARD_SIZE * y;
+            activeJournal->RecordFlameSlot(cell, flameSlots[cell]);
+            RecordFlame(flames.count);
+        }
+
         Flame& newFlame = flames.NextPos();
         newFlame.position.x = x;
         newFlame.position.y = y;
 
-        // optimization: additive timeLeft in flame queue
-        if(isCenterFlame)
+        // optimization: additive timeLeft in flame queue, only the first
+        // flame of the newest bucket stores the time difference
+        if(flameBuckets[FLAME_LIFETIME - 1] == 0)
         {
             if(flames.count == 0)
             {
@@ -421,16 +739,21 @@ bool State::SpawnFlameItem(int x, int y, bool isCenterFlame)
         {
             newFlame.timeLeft = 0;
         }
+        flameBuckets[FLAME_LIFETIME - 1]++;
+        flameSlots[x + BOARD_SIZE * y] = (flames.index + flames.count) % (BOARD_SIZE * BOARD_SIZE);
 
-        // update the board
-        items[y][x] = Item::FLAME + (flames.count << 3);
+        // update the board (wood keeps its powerup flag)
+        SetItem(x, y, Item::FLAME + (flames.count << 3) + (IS_WOOD(boardItem) ? WOOD_POWFLAG(boardItem) : 0));
+        _toggleFlameKey(*this, x, y, FLAME_LIFETIME);
 
         flames.count++;
 
         if(IS_WOOD(boardItem))
         {
-            // set the powerup flag
-            items[y][x] += WOOD_POWFLAG(boardItem);
+            if(activeEvents != nullptr)
+                RecordEvent(StepEventType::WoodDestroyed, activeEvents->explodingBombOwner, -1,
+                            FlagItem(WOOD_POWFLAG(boardItem)), {x, y});
+
             // remember that we destroyed wood here
             newFlame.destroyedWoodAtTimeStep = timeStep;
             // stop here, we found wood
@@ -506,8 +829,8 @@ void State::PopFlames()
         Flame& f = flames[0];
         // get the item behind the flame (can be 0 for passage)
         Item newItem = FlagItem(FLAME_POWFLAG(items[f.position.y][f.position.x]));
-        // remove the flame
-        items[f.position.y][f.position.x] = newItem;
+        // remove the flame (its key has already been removed by util::TickFlames)
+        SetItem(f.position.x, f.position.y, newItem);
         flames.PopElem();
     }
 }
@@ -525,8 +848,15 @@ void State::Kill(int agentID)
 {
     if(!agents[agentID].dead)
     {
+        if(activeJournal != nullptr)
+            activeJournal->RecordAgent(agentID, agents[agentID]);
+
         agents[agentID].dead = true;
         aliveAgents--;
+        RehashAgent(agentID);
+
+        if(activeEvents != nullptr)
+            RecordEvent(StepEventType::AgentKilled, agentID, activeEvents->explodingBombOwner, 0, agents[agentID].GetPos());
     }
 }
 
@@ -537,7 +867,11 @@ void State::EventBombExploded(Bomb b)
     int id = BMB_ID(b);
     if (id >= 0 && id < AGENT_COUNT && agents[id].statsVisible)
     {
+        if(activeJournal != nullptr)
+            activeJournal->RecordAgent(id, agents[id]);
+
         agents[BMB_ID(b)].bombCount--;
+        RehashAgent(id);
     }
 }
 
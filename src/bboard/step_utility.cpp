@@ -1,7 +1,11 @@
+#include <algorithm>
 #include <iostream>
 
 #include "bboard.hpp"
 #include "step_utility.hpp"
+#include "bitboard.hpp"
+#include "compact_state.hpp"
+#include "profile.hpp"
 
 namespace bboard::util
 {
@@ -59,33 +63,32 @@ Position DesiredPosition(const Bomb b)
     return DesiredPosition(BMB_POS_X(b), BMB_POS_Y(b), Move(BMB_DIR(b)));
 }
 
-Position AgentBombChainReversion(State* state, const Position oldAgentPos[AGENT_COUNT],
+template<typename Rules, typename S>
+Position AgentBombChainReversion(S* state, const Position oldAgentPos[AGENT_COUNT],
                                  Position destBombs[MAX_BOMBS], int agentID)
 {
     // scenario: An agent shares its position with a bomb
     // -> we have to reset the agent to its original position (could be staying on a bomb)
     //    and check whether resetting the agent affects any additional agents or bombs
 
-    AgentInfo& agent = state->agents[agentID];
     Position origin = oldAgentPos[agentID];
 
     // is there an agent at the old origin?
     int indexOriginAgent = state->GetAgent(origin.x, origin.y);
 
     // reset agent to its original position
-    agent.x = origin.x;
-    agent.y = origin.y;
+    state->SetAgentPosition(agentID, origin.x, origin.y);
 
     int bombDestIndex = -1;
     if(indexOriginAgent != -1)
     {
         // we also have to move back the agent which moved to our origin position
-        AgentBombChainReversion(state, oldAgentPos, destBombs, indexOriginAgent);
+        AgentBombChainReversion<Rules>(state, oldAgentPos, destBombs, indexOriginAgent);
 
         // is there a bomb which has been kicked by this agent just in this step?
         // if that's the case, undo the kick
-        const AgentInfo& originAgent = state->agents[indexOriginAgent];
-        if(originAgent.canKick)
+        const auto& originAgent = state->agents[indexOriginAgent];
+        if(Rules::Kick && originAgent.canKick)
         {
             for(int i = 0; i < state->bombs.count; i++)
             {
@@ -145,12 +148,12 @@ Position AgentBombChainReversion(State* state, const Position oldAgentPos[AGENT_
 
         // otherwise, bPos is either empty or occupied by some different agent.
         // as we'll move back the other agent, we can already set the bomb item
-        state->items[bPos.y][bPos.x] = Item::BOMB;
+        state->SetItem(bPos.x, bPos.y, Item::BOMB);
 
         if(hasAgent != -1)
         {
             // if there is an agent, move it back as well
-            return AgentBombChainReversion(state, oldAgentPos, destBombs, hasAgent);
+            return AgentBombChainReversion<Rules>(state, oldAgentPos, destBombs, hasAgent);
         }
         else
         {
@@ -161,7 +164,8 @@ Position AgentBombChainReversion(State* state, const Position oldAgentPos[AGENT_
     return origin;
 }
 
-void FillPositions(const State* state, Position p[AGENT_COUNT])
+template<typename S>
+void FillPositions(const S* state, Position p[AGENT_COUNT])
 {
     for(int i = 0; i < AGENT_COUNT; i++)
     {
@@ -169,7 +173,8 @@ void FillPositions(const State* state, Position p[AGENT_COUNT])
     }
 }
 
-void FillDestPos(const State* state, Move m[AGENT_COUNT], Position p[AGENT_COUNT])
+template<typename S>
+void FillDestPos(const S* state, const Move m[AGENT_COUNT], Position p[AGENT_COUNT])
 {
     for(int i = 0; i < AGENT_COUNT; i++)
     {
@@ -177,7 +182,8 @@ void FillDestPos(const State* state, Move m[AGENT_COUNT], Position p[AGENT_COUNT
     }
 }
 
-void FillBombPositions(const Board* board, Position p[])
+template<typename S>
+void FillBombPositions(const S* board, Position p[])
 {
     for(int i = 0; i < board->bombs.count; i++)
     {
@@ -185,7 +191,8 @@ void FillBombPositions(const Board* board, Position p[])
     }
 }
 
-void FillBombDestPos(const Board* board, Position p[MAX_BOMBS])
+template<typename S>
+void FillBombDestPos(const S* board, Position p[MAX_BOMBS])
 {
     for(int i = 0; i < board->bombs.count; i++)
     {
@@ -193,7 +200,8 @@ void FillBombDestPos(const Board* board, Position p[MAX_BOMBS])
     }
 }
 
-void FillAgentDead(const State* state, bool dead[AGENT_COUNT])
+template<typename S>
+void FillAgentDead(const S* state, bool dead[AGENT_COUNT])
 {
     for(int i = 0; i < AGENT_COUNT; i++)
     {
@@ -210,16 +218,17 @@ void _printDest(Position destPos[AGENT_COUNT])
     std::cout << destPos[AGENT_COUNT - 1] << std::endl;
 }
 
-int ResolveDependencies(const State* state, Position des[AGENT_COUNT],
+template<typename Rules, typename S>
+int ResolveDependencies(const S* state, Position des[AGENT_COUNT],
                         int dependency[AGENT_COUNT], int chain[AGENT_COUNT])
 {
     int rootCount = 0;
     for(int i = 0; i < AGENT_COUNT; i++)
     {
-        const AgentInfo& a1 = state->agents[i];
+        const auto& a1 = state->agents[i];
 
         // dead and not visible agents are handled as roots
-        if(a1.dead || !a1.visible)
+        if(a1.dead || (Rules::PartialObservability && !a1.visible))
         {
             chain[rootCount] = i;
             rootCount++;
@@ -229,9 +238,9 @@ int ResolveDependencies(const State* state, Position des[AGENT_COUNT],
         bool isChainRoot = true;
         for(int j = 0; j < AGENT_COUNT; j++)
         {
-            const AgentInfo& a2 = state->agents[j];
+            const auto& a2 = state->agents[j];
 
-            if(i == j || a2.dead || !a2.visible) continue;
+            if(i == j || a2.dead || (Rules::PartialObservability && !a2.visible)) continue;
 
             if(des[i].x == a2.x && des[i].y == a2.y)
             {
@@ -261,7 +270,23 @@ void TickFlames(State* state)
         throw std::runtime_error("TickFlames only supports optimized flame queues.");
     }
 
+    // the remaining lifetime of all flames decreases, which changes their keys
+    uint64_t* groups = state->flameGroupKeys;
+    state->hash ^= zobrist::FlameKey(groups[0], 1);
+    for(int t = 1; t < FLAME_LIFETIME; t++)
+    {
+        state->hash ^= zobrist::FlameKey(groups[t], t + 1) ^ zobrist::FlameKey(groups[t], t);
+        groups[t - 1] = groups[t];
+    }
+    groups[FLAME_LIFETIME - 1] = 0;
+
+    // the same holds for the buckets, the flames of the first bucket burn out
+    int* buckets = state->flameBuckets;
+    std::copy(buckets + 1, buckets + FLAME_LIFETIME, buckets);
+    buckets[FLAME_LIFETIME - 1] = 0;
+
     state->currentFlameTime--;
+    state->RecordFlame(0);
     state->flames[0].timeLeft--;
     if(state->flames[0].timeLeft <= 0)
     {
@@ -269,7 +294,8 @@ void TickFlames(State* state)
     }
 }
 
-void TickBombs(State* state)
+template<typename S>
+void TickBombs(S* state)
 {
     // reduce timer of every bomb
     for(int i = 0; i < state->bombs.count; i++)
@@ -278,7 +304,8 @@ void TickBombs(State* state)
     }
 }
 
-void ExplodeBombs(State* state)
+template<typename S>
+void ExplodeBombs(S* state)
 {
     // always check the current top bomb
     while (state->bombs.count > 0 && BMB_TIME(state->bombs[0]) <= 0)
@@ -287,22 +314,6 @@ void ExplodeBombs(State* state)
     }
 }
 
-void ConsumePowerup(AgentInfo& info, int powerUp)
-{
-    if(powerUp == Item::EXTRABOMB)
-    {
-        info.maxBombCount++;
-    }
-    else if(powerUp == Item::INCRRANGE)
-    {
-        info.bombStrength++;
-    }
-    else if(powerUp == Item::KICK)
-    {
-        info.canKick = true;
-    }
-}
-
 bool HasDPCollision(const State* state, Position dp[AGENT_COUNT], int agentID)
 {
     for(int i = 0; i < AGENT_COUNT; i++)
@@ -318,7 +329,8 @@ bool HasDPCollision(const State* state, Position dp[AGENT_COUNT], int agentID)
     return false;
 }
 
-void ResetBombFlags(Board* board)
+template<typename S>
+void ResetBombFlags(S* board)
 {
     for(int i = 0; i < board->bombs.count; i++)
     {
@@ -353,7 +365,21 @@ inline Direction _toDirection(Position difference)
     return Direction::IDLE;
 }
 
-void ResolveBombMovement(State* state, const Position oldAgentPos[AGENT_COUNT], const Position originalAgentDestination[AGENT_COUNT], Position bombDestinations[])
+/**
+ * @brief _recordEvent Adds an event to the active events of a State (the
+ * other state representations do not record events).
+ */
+template<typename S>
+inline void _recordEvent(S* state, StepEventType type, int agent, int source, int value, Position position)
+{
+    if constexpr(std::is_same<S, State>::value)
+    {
+        state->RecordEvent(type, agent, source, value, position);
+    }
+}
+
+template<typename Rules, typename S>
+void ResolveBombMovement(S* state, const Position oldAgentPos[AGENT_COUNT], const Position originalAgentDestination[AGENT_COUNT], Position bombDestinations[])
 {
     // Fill array of desired positions
     const int bombCount = state->bombs.count;
@@ -368,6 +394,10 @@ void ResolveBombMovement(State* state, const Position oldAgentPos[AGENT_COUNT],
     std::fill_n(agentCollisions, AGENT_COUNT, false);
     bool foundAgentCollision = false;
 
+    // the agents which kicked the bombs in this step (-1 if not kicked)
+    int kickedBy[bombCount];
+    std::fill_n(kickedBy, bombCount, -1);
+
     // agent-bomb collisions
     for(int i = 0; i < state->bombs.count; i++)
     {
@@ -378,7 +408,7 @@ void ResolveBombMovement(State* state, const Position oldAgentPos[AGENT_COUNT],
             // if bomb movement is blocked statically, directly stop moving and adjust the destination
             // this allows agents to still kick the bomb from its current position
             if(bombDestination != bombPositions[i] 
-                && (IsOutOfBounds(bombDestination) || IS_STATIC_MOV_BLOCK(state->items[bombDestination.y][bombDestination.x])))
+                && (IsOutOfBounds(bombDestination) || IS_STATIC_MOV_BLOCK(state->GetItem(bombDestination.x, bombDestination.y))))
             {
                 bombDestination = bombPositions[i];
                 bombDestinations[i] = bombDestination;
@@ -391,9 +421,9 @@ void ResolveBombMovement(State* state, const Position oldAgentPos[AGENT_COUNT],
             if(agentid != -1)
             {
                 // there is an agent at the destination
-                const AgentInfo &info = state->agents[agentid];
+                const auto& info = state->agents[agentid];
 
-                if(info.canKick)
+                if(Rules::Kick && info.canKick)
                 {
                     // the bomb collides with an agent that can kick => can we kick the bomb?
                     const Position diff = info.GetPos() - oldAgentPos[agentid];
@@ -457,6 +487,7 @@ void ResolveBombMovement(State* state, const Position oldAgentPos[AGENT_COUNT],
                             stoppingBombs[i] = false;
                             SetBombDirection(state->bombs[i], _toDirection(diff));
                             bombDestinations[i] = newDestination;
+                            kickedBy[i] = agentid;
                             continue;
                         }
                         // note that this is treated as a collision if kicking is not allowed
@@ -510,7 +541,7 @@ void ResolveBombMovement(State* state, const Position oldAgentPos[AGENT_COUNT],
             // only revert agents that moved
             if(agentCollisions[i] && oldAgentPos[i] != p)
             {
-                util::AgentBombChainReversion(state, oldAgentPos, bombDestinations, i);
+                util::AgentBombChainReversion<Rules>(state, oldAgentPos, bombDestinations, i);
             }
         }
     }
@@ -535,53 +566,69 @@ void ResolveBombMovement(State* state, const Position oldAgentPos[AGENT_COUNT],
                     && state->agents[indexAgent].GetPos() != oldAgentPos[indexAgent])
             {
                 // bounce back the moving agent to its origin
-                util::AgentBombChainReversion(state, oldAgentPos, bombDestinations, indexAgent);
+                util::AgentBombChainReversion<Rules>(state, oldAgentPos, bombDestinations, indexAgent);
                 if(state->GetAgent(bPos.x, bPos.y) == -1)
                 {
                     // this position is now occupied by the bomb
-                    state->items[bPos.y][bPos.x] = Item::BOMB;
+                    state->SetItem(bPos.x, bPos.y, Item::BOMB);
                 }
             }
         }
     }
+
+    // report the kicks which have not been reverted
+    for(int i = 0; i < bombCount; i++)
+    {
+        const Bomb b = state->bombs[i];
+        if(kickedBy[i] != -1 && BMB_DIR(b) != int(Direction::IDLE) && bombDestinations[i] != bombPositions[i])
+        {
+            _recordEvent(state, StepEventType::BombKicked, kickedBy[i], BMB_ID(b), BMB_DIR(b), bombPositions[i]);
+        }
+    }
 }
 
-inline void _resetBoardAgentGone(Board* board, const int x, const int y, const int i)
+template<typename S>
+inline void _resetBoardAgentGone(S* board, const int x, const int y, const int i)
 {
-    if(board->items[y][x] == Item::AGENT0 + i)
+    // dead or invisible agents of observations are placed out of bounds
+    if(IsOutOfBounds(x, y))
+        return;
+
+    if(board->GetItem(x, y) == Item::AGENT0 + i)
     {
         if(board->HasBomb(x, y))
         {
-            board->items[y][x] = Item::BOMB;
+            board->SetItem(x, y, Item::BOMB);
         }
         else
         {
-            board->items[y][x] = Item::PASSAGE;
+            board->SetItem(x, y, Item::PASSAGE);
         }
     }
 }
 
-inline void _setAgentPos(State* state, const int x, const int y, const int i)
+template<typename S>
+inline void _setAgentPos(S* state, const int x, const int y, const int i)
 {
-    state->agents[i].x = x;
-    state->agents[i].y = y;
+    state->SetAgentPosition(i, x, y);
 }
 
-void MoveAgent(State* state, const int i, const Move m, const Position fixedDest, const bool ouroboros)
+template<typename Rules, typename S>
+void MoveAgent(S* state, const int i, const Move m, const Position fixedDest, const bool ouroboros)
 {
-    AgentInfo& a = state->agents[i];
+    auto& a = state->agents[i];
 
     // hide agent from board and assume he does not move
     _resetBoardAgentGone(state, a.x, a.y, i);
     _setAgentPos(state, a.x, a.y, i);
 
-    if(a.dead || !a.visible)
+    if(a.dead || (Rules::PartialObservability && !a.visible))
     {
         return;
     }
     else if(m == Move::BOMB)
     {
-        state->TryPutBomb<true>(i);
+        TryPutBomb<true>(state, i);
         return;
     }
     else if(m == Move::IDLE || fixedDest == a.GetPos())
@@ -591,10 +638,15 @@ void MoveAgent(State* state, const int i, const Move m, const Position fixedDest
     }
 
     // the agent wants to move
-    int itemOnDestination = state->items[fixedDest.y][fixedDest.x];
-    if(util::IsOutOfBounds(fixedDest) || IS_WOOD(itemOnDestination) || itemOnDestination == Item::RIGID)
+    if(util::IsOutOfBounds(fixedDest))
     {
-        // cannot walk out of bounds, on wooden and rigid boxes
+        // cannot walk out of bounds
+        return;
+    }
+    int itemOnDestination = state->GetItem(fixedDest.x, fixedDest.y);
+    if(IS_WOOD(itemOnDestination) || itemOnDestination == Item::RIGID)
+    {
+        // cannot walk on wooden and rigid boxes
         return;
     }
     if(!ouroboros && state->GetAgent(fixedDest.x, fixedDest.y) != -1)
@@ -611,8 +663,123 @@ void MoveAgent(State* state, const int i, const Move m, const Position fixedDest
     //}
 }
 
-void MoveBombs(State* state, const Position bombDestinations[])
+template<typename Rules, typename S>
+bool IsCollisionFreeStep(const S* state, const Position oldPos[AGENT_COUNT], const Position destPos[AGENT_COUNT])
+{
+    // moving bombs can collide with agents and other bombs
+    for(int i = 0; i < state->bombs.count; i++)
+    {
+        if(BMB_DIR(state->bombs[i]) != int(Direction::IDLE))
+            return false;
+    }
+
+    for(int i = 0; i < AGENT_COUNT; i++)
+    {
+        const auto& a = state->agents[i];
+        if(a.dead)
+            continue;
+        if(Rules::PartialObservability && !a.visible)
+            return false;
+
+        // the destinations out of the board are unique
+        const Position& dest = destPos[i];
+        if(dest == oldPos[i] || IsOutOfBounds(dest))
+            continue;
+
+        if(state->GetAgent(dest.x, dest.y) != -1 || state->HasBomb(dest.x, dest.y))
+            return false;
+
+        for(int j = 0; j < i; j++)
+        {
+            if(!state->agents[j].dead && destPos[j] == dest)
+                return false;
+        }
+    }
+    return true;
+}
+
+template<typename Rules, typename S>
+void MoveAgents(S* state, const Move moves[AGENT_COUNT], Position destPos[AGENT_COUNT])
+{
+    // calculate dependencies in the player movement
+
+    int dependency[AGENT_COUNT];
+    std::fill_n(dependency, AGENT_COUNT, -1);
+    int roots[AGENT_COUNT];
+    std::fill_n(roots, AGENT_COUNT, -1);
+
+    // the amount of chain roots
+    int rootNumber;
+    {
+        POMCPP_PROFILE_SCOPE(profile::RESOLVE_DEPENDENCIES);
+        rootNumber = util::ResolveDependencies<Rules>(state, destPos, dependency, roots);
+    }
+
+    int rootIdx = 0;
+    int i = rootNumber == 0 ? 0 : roots[0]; // no roots -> start from 0
+
+    // ouroboros: every agent wants to move to the current position of a different agent
+    // A > B
+    // ^   v
+    // D < C
+    bool ouroboros = rootNumber == 0;
+
+    POMCPP_PROFILE_SCOPE(profile::MOVE_AGENT);
+
+    // apply the moves in the correct order
+    // iterates 4 times but the index i jumps around the dependencies
+    for(int _ = 0; _ < AGENT_COUNT; _++, i = dependency[i])
+    {
+        if(i == -1)
+        {
+            rootIdx++;
+            i = roots[rootIdx];
+        }
+
+        util::MoveAgent<Rules>(state, i, moves[i], destPos[i], ouroboros);
+    }
+}
+
+template<typename Rules, typename S>
+void ApplyAgentMovement(S* state)
+{
+    for(int i = 0; i < AGENT_COUNT; i++)
+    {
+        const auto& info = state->agents[i];
+
+        if((Rules::PartialObservability && !info.visible) || info.dead) continue;
+
+        Position pos = info.GetPos();
+        int itemOnDestination = state->GetItem(pos.x, pos.y);
+
+        // agent moved into flame
+        if(IS_FLAME(itemOnDestination))
+        {
+            state->Kill(i);
+            continue;
+        }
+        // collect power-ups
+        else if(IS_POWERUP(itemOnDestination))
+        {
+            // the agent moved, so the journal of a State already recorded it
+            util::ConsumePowerup(state->agents[i], itemOnDestination);
+            _recordEvent(state, StepEventType::PowerupCollected, i, -1, itemOnDestination, pos);
+        }
+
+        // update new agent position
+        state->SetItem(pos.x, pos.y, Item::AGENT0 + i);
+    }
+}
+
+template<typename Rules, typename S>
+void MoveBombs(S* state, const Position bombDestinations[])
 {
+    if constexpr(!Rules::Kick)
+    {
+        // bombs can only move when they have been kicked
+        return;
+    }
+
     // Reset bomb exploded flags
     util::ResetBombFlags(state);
 
@@ -630,37 +797,44 @@ void MoveBombs(State* state, const Position bombDestinations[])
             continue;
         }
 
-        int& oItem = state->items[pos.y][pos.x];
-        int& tItem = state->items[dest.y][dest.x];
+        if(util::IsOutOfBounds(dest))
+        {
+            // stop moving the bomb
+            SetBombDirection(b, Direction::IDLE);
+            continue;
+        }
+
+        const int oItem = state->GetItem(pos.x, pos.y);
+        const int tItem = state->GetItem(dest.x, dest.y);
 
-        if(util::IsOutOfBounds(dest) || IS_STATIC_MOV_BLOCK(tItem))
+        if(IS_STATIC_MOV_BLOCK(tItem))
         {
             // stop moving the bomb
             SetBombDirection(b, Direction::IDLE);
         }
-        else if(tItem == Item::FOG)
+        else if(Rules::PartialObservability && tItem == Item::FOG)
         {
             // the bomb just disappears when it moves out of range
             if(oItem == Item::BOMB)
             {
-                oItem = Item::PASSAGE;
+                state->SetItem(pos.x, pos.y, Item::PASSAGE);
             }
-            state->bombs.RemoveAt(i);
+            state->RemoveBomb(i);
             i--;
         }
         else
         {
             // move bomb
-            SetBombPosition(b, dest.x, dest.y);
+            state->MoveBomb(i, dest);
 
             if(!state->HasBomb(pos.x, pos.y) && oItem == Item::BOMB)
             {
-                oItem = Item::PASSAGE;
+                state->SetItem(pos.x, pos.y, Item::PASSAGE);
             }
 
             if(IS_WALKABLE(tItem))
             {
-                tItem = Item::BOMB;
+                state->SetItem(dest.x, dest.y, Item::BOMB);
             }
             else if(IS_FLAME(tItem))
             {
@@ -718,7 +892,8 @@ void PrintDependencyChain(int dependency[AGENT_COUNT], int chain[AGENT_COUNT])
     }
 }
 
-int GetWinningTeam(const State& state)
+template<typename S>
+int GetWinningTeam(const S& state)
 {
     // no team has won when there are no agents left
     if(state.aliveAgents == 0)
@@ -730,7 +905,7 @@ int GetWinningTeam(const State& state)
 
     for(int i = 0; i < AGENT_COUNT; i++)
     {
-        AgentInfo info = state.agents[i];
+        const auto& info = state.agents[i];
         if (!info.dead)
         {
             if (state.aliveAgents == 1)
@@ -766,7 +941,8 @@ int GetWinningTeam(const State& state)
     return winningTeamCandidate;
 }
 
-void CheckTerminalState(State& state)
+template<typename Rules, typename S>
+void CheckTerminalState(S& state)
 {
     state.finished = false;
     state.isDraw = false;
@@ -788,11 +964,14 @@ void CheckTerminalState(State& state)
 
         for(int i = 0; i < AGENT_COUNT; i++)
         {
-            AgentInfo& info = state.agents[i];
+            auto& info = state.agents[i];
             if (!info.dead)
             {
                 // the agent might be in some team
-                state.winningTeam = info.team;
+                if(Rules::Teams)
+                {
+                    state.winningTeam = info.team;
+                }
                 // if not, that is the winning agent
                 if(state.winningTeam == 0)
                 {
@@ -803,7 +982,7 @@ void CheckTerminalState(State& state)
             }
         }
     }
-    else
+    else if(Rules::Teams)
     {
         // there are >= 2 agents alive, check if there
         // is a winning team
@@ -818,11 +997,6 @@ void CheckTerminalState(State& state)
     }
 }
 
-bool CompareTimeLeft(const Flame& lhs, const Flame& rhs)
-{
-    return lhs.timeLeft < rhs.timeLeft;
-}
-
 int OptimizeFlameQueue(Board& board)
 {
     if(board.currentFlameTime != -1)
@@ -830,10 +1004,26 @@ int OptimizeFlameQueue(Board& board)
         return board.currentFlameTime;
     }
 
-    // sort flames
-    Flame flames[board.flames.count];
-    board.flames.CopyTo(flames);
-    std::sort(flames, flames + board.flames.count, CompareTimeLeft);
+    // sort flames by their lifetime (stable counting sort). Flames without
+    // remaining lifetime burn out with the next tick.
+    int bucketStart[FLAME_LIFETIME + 1] = {};
+    for(int i = 0; i < board.flames.count; i++)
+    {
+        Flame& f = board.flames[i];
+        f.timeLeft = std::clamp(f.timeLeft, 1, FLAME_LIFETIME);
+        bucketStart[f.timeLeft]++;
+    }
+    for(int t = 1; t <= FLAME_LIFETIME; t++)
+    {
+        bucketStart[t] += bucketStart[t - 1];
+    }
+
+    Flame flames[BOARD_SIZE * BOARD_SIZE];
+    for(int i = 0; i < board.flames.count; i++)
+    {
+        const Flame& f = board.flames[i];
+        flames[bucketStart[f.timeLeft - 1]++] = f;
+    }
     board.flames.CopyFrom(flames, board.flames.count);
 
     // modify timeLeft (additive)
@@ -848,9 +1038,48 @@ int OptimizeFlameQueue(Board& board)
         // set flame ids to allow for faster lookup
         board.items[f.position.y][f.position.x] += (i << 3);
     }
+    board.RebuildFlameIndex();
 
     // return total time left
     return timeLeft;
 }
 
+// explicit instantiations of the step pipeline for all state representations
+
+#define INSTANTIATE_STEP_RULES(S, ...) \
+    template Position AgentBombChainReversion<__VA_ARGS__, S>(S*, const Position[AGENT_COUNT], Position[MAX_BOMBS], int); \
+    template int ResolveDependencies<__VA_ARGS__, S>(const S*, Position[AGENT_COUNT], int[AGENT_COUNT], int[AGENT_COUNT]); \
+    template void ResolveBombMovement<__VA_ARGS__, S>(S*, const Position[AGENT_COUNT], const Position[AGENT_COUNT], Position[]); \
+    template void MoveAgent<__VA_ARGS__, S>(S*, const int, const Move, const Position, const bool); \
+    template bool IsCollisionFreeStep<__VA_ARGS__, S>(const S*, const Position[AGENT_COUNT], const Position[AGENT_COUNT]); \
+    template void MoveAgents<__VA_ARGS__, S>(S*, const Move[AGENT_COUNT], Position[AGENT_COUNT]); \
+    template void ApplyAgentMovement<__VA_ARGS__, S>(S*); \
+    template void MoveBombs<__VA_ARGS__, S>(S*, const Position[]); \
+    template void CheckTerminalState<__VA_ARGS__, S>(S&);
+
+#define INSTANTIATE_STEP_PIPELINE(S) \
+    INSTANTIATE_STEP_RULES(S, DefaultRules) \
+    template void FillPositions<S>(const S*, Position[AGENT_COUNT]); \
+    template void FillDestPos<S>(const S*, const Move[AGENT_COUNT], Position[AGENT_COUNT]); \
+    template void FillBombPositions<S>(const S*, Position[]); \
+    template void FillBombDestPos<S>(const S*, Position[MAX_BOMBS]); \
+    template void FillAgentDead<S>(const S*, bool[AGENT_COUNT]); \
+    template void TickBombs<S>(S*); \
+    template void ExplodeBombs<S>(S*); \
+    template void ResetBombFlags<S>(S*); \
+    template int GetWinningTeam<S>(const S&);
+
+INSTANTIATE_STEP_PIPELINE(State)
+INSTANTIATE_STEP_PIPELINE(BitBoard)
+INSTANTIATE_STEP_PIPELINE(CompactState)
+
+// all other rule sets of State::StepT
+INSTANTIATE_STEP_RULES(State, StepRules<true, true, false>)
+INSTANTIATE_STEP_RULES(State, StepRules<true, false, true>)
+INSTANTIATE_STEP_RULES(State, StepRules<true, false, false>)
+INSTANTIATE_STEP_RULES(State, StepRules<false, true, true>)
+INSTANTIATE_STEP_RULES(State, StepRules<false, true, false>)
+INSTANTIATE_STEP_RULES(State, StepRules<false, false, true>)
+INSTANTIATE_STEP_RULES(State, StepRules<false, false, false>)
+
 }
@@ -2,6 +2,10 @@
 #include <algorithm>
 #include <unordered_set>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include "bboard.hpp"
 #include "colors.hpp"
 #include "strategy.hpp"
@@ -93,11 +97,254 @@ void FillRMap(const Board& b, RMap& r, int agentID)
     r.info = result;
 }
 
+/**
+ * @brief _neighbourRank Returns the rank of the neighbour "to" of the cell
+ * "from" in the order in which FillRMap tries to add neighbours (down, up,
+ * right, left).
+ */
+inline int _neighbourRank(int from, int to)
+{
+    const int diff = to - from;
+    return diff == BOARD_SIZE ? 0 : (diff == -BOARD_SIZE ? 1 : (diff == 1 ? 2 : 3));
+}
+
+/**
+ * @brief _isVisitedBefore Returns true if FillRMap pops the cell a before
+ * the cell b (both cells have the same distance). Cells are queued in the
+ * order of their predecessors, neighbours of the same predecessor are
+ * queued in the order of _neighbourRank.
+ */
+bool _isVisitedBefore(const MultiRMap& r, int agentID, int a, int b)
+{
+    while(true)
+    {
+        const int pa = r.GetPredecessor(agentID, a % BOARD_SIZE, a / BOARD_SIZE);
+        const int pb = r.GetPredecessor(agentID, b % BOARD_SIZE, b / BOARD_SIZE);
+        if(pa == pb)
+        {
+            return _neighbourRank(pa, a) < _neighbourRank(pb, b);
+        }
+        a = pa;
+        b = pb;
+    }
+}
+
+int MultiRMap::GetPredecessor(int agentID, int x, int y) const
+{
+    const int index = x + BOARD_SIZE * y;
+    const int dist = distance[agentID][index];
+    if(dist == 0)
+        return 0;
+    if(dist == 1)
+        return source[agentID].x + BOARD_SIZE * source[agentID].y;
+    if((resolved[agentID][y] >> x) & 1)
+        return predecessor[agentID][index];
+
+    // the predecessor is the first neighbour in the previous layer
+    // which has been popped from the queue
+    int best = -1;
+    const int dx[4] = {0, 0, 1, -1};
+    const int dy[4] = {1, -1, 0, 0};
+    for(int k = 0; k < 4; k++)
+    {
+        const int nx = x + dx[k], ny = y + dy[k];
+        if(util::IsOutOfBounds(nx, ny))
+            continue;
+
+        const int n = nx + BOARD_SIZE * ny;
+        if(distance[agentID][n] != dist - 1 || ((walkable[ny] >> nx) & 1) == 0)
+            continue;
+
+        if(best == -1 || _isVisitedBefore(*this, agentID, n, best))
+        {
+            best = n;
+        }
+    }
+
+    predecessor[agentID][index] = (Cell)best;
+    resolved[agentID][y] |= Row(1) << x;
+    return best;
+}
+
+const int _CELL_WORDS = (BOARD_SIZE * BOARD_SIZE + 63) / 64;
+
+/**
+ * @brief _findWalkableAndAgents Sets bit x + BOARD_SIZE * y of the masks
+ * if the cell (x, y) is walkable or an agent (4 cells at once if SSE2 is
+ * available).
+ */
+inline void _findWalkableAndAgents(const int* items, uint64_t walkable[_CELL_WORDS], uint64_t agents[_CELL_WORDS])
+{
+    std::fill_n(walkable, _CELL_WORDS, 0);
+    std::fill_n(agents, _CELL_WORDS, 0);
+
+    int i = 0;
+#ifdef __SSE2__
+    const __m128i passage = _mm_set1_epi32(Item::PASSAGE);
+    const __m128i beforePowerup = _mm_set1_epi32(Item::EXTRABOMB - 1);
+    const __m128i afterPowerup = _mm_set1_epi32(Item::KICK + 1);
+    const __m128i beforeAgent = _mm_set1_epi32(Item::AGENT0 - 1);
+    for(; i + 4 <= BOARD_SIZE * BOARD_SIZE; i += 4)
+    {
+        const __m128i x = _mm_loadu_si128((const __m128i*)(items + i));
+        const __m128i powerup = _mm_and_si128(_mm_cmpgt_epi32(x, beforePowerup), _mm_cmplt_epi32(x, afterPowerup));
+        const __m128i w = _mm_or_si128(_mm_cmpeq_epi32(x, passage), powerup);
+        const __m128i a = _mm_cmpgt_epi32(x, beforeAgent);
+
+        // i is a multiple of 4, the 4 bits never cross a word boundary
+        walkable[i >> 6] |= uint64_t(_mm_movemask_ps(_mm_castsi128_ps(w))) << (i & 63);
+        agents[i >> 6] |= uint64_t(_mm_movemask_ps(_mm_castsi128_ps(a))) << (i & 63);
+    }
+#endif
+    for(; i < BOARD_SIZE * BOARD_SIZE; i++)
+    {
+        walkable[i >> 6] |= uint64_t(IS_WALKABLE(items[i])) << (i & 63);
+        agents[i >> 6] |= uint64_t(IS_AGENT(items[i])) << (i & 63);
+    }
+}
+
+/**
+ * @brief _getRow Returns the bits of row y of a cell mask.
+ */
+inline uint64_t _getRow(const uint64_t cells[_CELL_WORDS], int y)
+{
+    const int offset = BOARD_SIZE * y;
+    const int word = offset >> 6, shift = offset & 63;
+    uint64_t row = cells[word] >> shift;
+    if(shift + BOARD_SIZE > 64)
+    {
+        row |= cells[word + 1] << (64 - shift);
+    }
+    return row & ((uint64_t(1) << BOARD_SIZE) - 1);
+}
+
+/**
+ * @brief _fillLanes Runs the bit-parallel BFS for the agents of the lanes
+ * which start at firstAgent.
+ */
+void _fillLanes(const Board& b, MultiRMap& r, int agentMask, int firstAgent,
+                const uint64_t walkableRows[BOARD_SIZE], const uint64_t agentRows[BOARD_SIZE])
+{
+    const int laneBits = MultiRMap::LANE_BITS;
+    const int lastAgent = std::min(AGENT_COUNT, firstAgent + MultiRMap::LANES);
+
+    // broadcasts a row to the lanes of all agents
+    uint64_t allLanes = 0;
+    for(int i = firstAgent; i < lastAgent; i++)
+    {
+        allLanes |= uint64_t(1) << (laneBits * (i - firstAgent));
+    }
+
+    uint64_t visited[BOARD_SIZE + 2] = {};
+    uint64_t frontier[BOARD_SIZE + 2] = {};
+    uint64_t laneMask = 0;
+
+    for(int i = firstAgent; i < lastAgent; i++)
+    {
+        const AgentInfo& a = b.agents[i];
+        r.source[i] = {a.x, a.y};
+        r.info[i] = 0;
+        std::fill_n(r.resolved[i], BOARD_SIZE, 0);
+        std::fill_n(r.distance[i], BOARD_SIZE * BOARD_SIZE, 0);
+
+        if((agentMask & (1 << i)) == 0 || a.dead || !a.visible || util::IsOutOfBounds(a.x, a.y))
+            continue;
+
+        // the source is always in range of the own bombs
+        const int lane = laneBits * (i - firstAgent);
+        r.info[i] = 0b1;
+        r.agentMask |= 1 << i;
+        laneMask |= ((uint64_t(1) << laneBits) - 1) << lane;
+
+        // rows are shifted by one to avoid bound checks
+        visited[a.y + 1] |= uint64_t(1) << (a.x + lane);
+        frontier[a.y + 1] = visited[a.y + 1];
+    }
+
+    if(laneMask == 0)
+        return;
+
+    // agents can be reached, but don't continue the search
+    uint64_t reachable[BOARD_SIZE + 2] = {};
+    uint64_t walkable[BOARD_SIZE + 2] = {};
+    for(int y = 0; y < BOARD_SIZE; y++)
+    {
+        walkable[y + 1] = walkableRows[y] * allLanes & laneMask;
+        reachable[y + 1] = (walkableRows[y] | agentRows[y]) * allLanes & laneMask;
+    }
+
+    // expand the frontiers of all agents layer by layer, only
+    // the rows next to the current frontier can change
+    int first = BOARD_SIZE + 1, last = 0;
+    for(int y = 1; y <= BOARD_SIZE; y++)
+    {
+        if(frontier[y] != 0)
+        {
+            first = std::min(first, y);
+            last = y;
+        }
+    }
+
+    uint64_t next[BOARD_SIZE + 2] = {};
+    for(int dist = 1; first <= last; dist++)
+    {
+        const int from = std::max(1, first - 1);
+        const int to = std::min(BOARD_SIZE, last + 1);
+        for(int y = from; y <= to; y++)
+        {
+            // bits which are shifted out of a row are not reachable
+            const uint64_t f = frontier[y];
+            next[y] = ((f << 1) | (f >> 1) | frontier[y - 1] | frontier[y + 1]) & reachable[y] & ~visited[y];
+        }
+
+        first = BOARD_SIZE + 1;
+        last = 0;
+        for(int y = from; y <= to; y++)
+        {
+            visited[y] |= next[y];
+            frontier[y] = next[y] & walkable[y];
+            if(frontier[y] != 0)
+            {
+                first = std::min(first, y);
+                last = y;
+            }
+
+            for(uint64_t bits = next[y]; bits != 0; bits &= bits - 1)
+            {
+                const int bit = CountTrailingZeros(bits);
+                r.distance[firstAgent + bit / laneBits][bit % laneBits + BOARD_SIZE * (y - 1)] = (MultiRMap::Cell)dist;
+            }
+        }
+    }
+}
+
+// Bit-parallel BFS
+void FillMultiRMap(const Board& b, MultiRMap& r, int agentMask)
+{
+    uint64_t walkableCells[_CELL_WORDS], agentCells[_CELL_WORDS];
+    _findWalkableAndAgents(&b.items[0][0], walkableCells, agentCells);
+
+    uint64_t walkableRows[BOARD_SIZE], agentRows[BOARD_SIZE];
+    for(int y = 0; y < BOARD_SIZE; y++)
+    {
+        walkableRows[y] = _getRow(walkableCells, y);
+        agentRows[y] = _getRow(agentCells, y);
+        r.walkable[y] = (MultiRMap::Row)walkableRows[y];
+    }
+
+    r.agentMask = 0;
+    for(int i = 0; i < AGENT_COUNT; i += MultiRMap::LANES)
+    {
+        _fillLanes(b, r, agentMask, i, walkableRows, agentRows);
+    }
+}
+
 ///////////////////////
 // General Functions //
 ///////////////////////
 
-Move MoveTowardsPosition(const RMap& r, const Position& position)
+template<typename M>
+Move _moveTowardsPosition(const M& r, const Position& position)
 {
     Position curr = position;
     for(int i = 0;; i++)
@@ -120,7 +367,18 @@ Move MoveTowardsPosition(const RMap& r, const Position& position)
     }
 }
 
-Move MoveTowardsSafePlace(const Board& b, const RMap& r, int radius)
+Move MoveTowardsPosition(const RMap& r, const Position& position)
+{
+    return _moveTowardsPosition(r, position);
+}
+
+Move MoveTowardsPosition(const AgentRMap& r, const Position& position)
+{
+    return _moveTowardsPosition(r, position);
+}
+
+template<typename D>
+Move _moveTowardsSafePlace(const D& danger, const RMap& r, int radius)
 {
     int originX = r.source.x;
     int originY = r.source.y;
@@ -132,7 +390,7 @@ Move MoveTowardsSafePlace(const Board& b, const RMap& r, int radius)
             if(util::IsOutOfBounds({x, y}) ||
                     std::abs(x - originX) + std::abs(y - originY) > radius) continue;
 
-            if(r.GetDistance(x, y) != 0 && _safe_condition(IsInDanger(b, x, y)))
+            if(r.GetDistance(x, y) != 0 && _safe_condition(IsInDanger(danger, x, y)))
             {
                 return MoveTowardsPosition(r, {x, y});
             }
@@ -141,6 +399,16 @@ Move MoveTowardsSafePlace(const Board& b, const RMap& r, int radius)
     return Move::IDLE;
 }
 
+Move MoveTowardsSafePlace(const Board& b, const RMap& r, int radius)
+{
+    return _moveTowardsSafePlace(b, r, radius);
+}
+
+Move MoveTowardsSafePlace(const DangerMap& d, const RMap& r, int radius)
+{
+    return _moveTowardsSafePlace(d, r, radius);
+}
+
 Move MoveTowardsPowerup(const Board& b, const RMap& r, int radius)
 {
     const Position& a = r.source;
@@ -194,33 +462,44 @@ bool _safe_condition(int danger, int min)
 {
     return danger == 0 || danger >= min;
 }
-void SafeDirections(const Board& b, FixedQueue<Move, MOVE_COUNT>& q, int x, int y)
+template<typename D>
+void _safeDirections(const Board& b, const D& danger, FixedQueue<Move, MOVE_COUNT>& q, int x, int y)
 {
-    int d = IsInDanger(b, x + 1, y);
+    int d = IsInDanger(danger, x + 1, y);
     if(_CheckPos(b, x + 1, y) && _safe_condition(d))
     {
         q.AddElem(Move::RIGHT);
     }
 
-    d = IsInDanger(b, x - 1, y);
+    d = IsInDanger(danger, x - 1, y);
     if(_CheckPos(b, x - 1, y) && _safe_condition(d))
     {
         q.AddElem(Move::LEFT);
     }
 
-    d = IsInDanger(b, x, y + 1);
+    d = IsInDanger(danger, x, y + 1);
     if(_CheckPos(b, x, y + 1) && _safe_condition(d))
     {
         q.AddElem(Move::DOWN);
     }
 
-    d = IsInDanger(b, x, y - 1);
+    d = IsInDanger(danger, x, y - 1);
     if(_CheckPos(b, x, y - 1) && _safe_condition(d))
     {
         q.AddElem(Move::UP);
     }
 }
 
+void SafeDirections(const Board& b, FixedQueue<Move, MOVE_COUNT>& q, int x, int y)
+{
+    _safeDirections(b, b, q, x, y);
+}
+
+void SafeDirections(const Board& b, const DangerMap& d, FixedQueue<Move, MOVE_COUNT>& q, int x, int y)
+{
+    _safeDirections(b, d, q, x, y);
+}
+
 int IsInDanger(const Board& b, int agentID)
 {
     const AgentInfo& a = b.agents[agentID];
@@ -230,7 +509,7 @@ int IsInDanger(const Board& b, int agentID)
 int IsInDanger(const Board& b, int x, int y)
 {
     int minTime = std::numeric_limits<int>::max();
-    // TODO: add consideration for chained bomb explosions
+    // note: chained explosions and blocked flames are considered by DangerMap
     for(int i = 0; i < b.bombs.count; i++)
     {
         const Bomb& bomb = b.bombs[i];
@@ -249,6 +528,85 @@ int IsInDanger(const Board& b, int x, int y)
     return minTime;
 }
 
+/**
+ * @brief _markDanger Lowers the explosion time of the cell (x, y) to t.
+ */
+inline void _markDanger(DangerMap& d, int x, int y, int t)
+{
+    int& time = d.time[y][x];
+    if(time == 0 || t < time)
+    {
+        time = t;
+    }
+}
+
+void FillDangerMap(const Board& b, DangerMap& d)
+{
+    std::fill_n(&d.time[0][0], BOARD_SIZE * BOARD_SIZE, 0);
+
+    int explosionTime[MAX_BOMBS];
+    bool exploded[MAX_BOMBS] = {};
+    for(int i = 0; i < b.bombs.count; i++)
+    {
+        explosionTime[i] = BMB_TIME(b.bombs[i]);
+    }
+
+    const int dx[4] = {1, -1, 0, 0};
+    const int dy[4] = {0, 0, 1, -1};
+    for(int k = 0; k < b.bombs.count; k++)
+    {
+        // explode the remaining bomb with the earliest explosion time,
+        // all bombs in its range explode at the same time
+        int next = -1;
+        for(int i = 0; i < b.bombs.count; i++)
+        {
+            if(!exploded[i] && (next == -1 || explosionTime[i] < explosionTime[next]))
+            {
+                next = i;
+            }
+        }
+        exploded[next] = true;
+
+        const Bomb bomb = b.bombs[next];
+        const int t = explosionTime[next];
+        const int x = BMB_POS_X(bomb), y = BMB_POS_Y(bomb);
+        _markDanger(d, x, y, t);
+
+        for(int dir = 0; dir < 4; dir++)
+        {
+            for(int i = 1; i <= BMB_STRENGTH(bomb); i++)
+            {
+                const int fx = x + i * dx[dir], fy = y + i * dy[dir];
+                if(util::IsOutOfBounds(fx, fy))
+                    break;
+
+                // flames stop at rigid blocks and burn the first wooden block
+                const int item = b.items[fy][fx];
+                if(item == Item::RIGID)
+                    break;
+
+                // the time of a wooden block is the time it burns, flames of
+                // later explosions pass burnt blocks
+                const int burnt = d.time[fy][fx];
+                _markDanger(d, fx, fy, t);
+
+                // bombs can also be hidden below agents
+                if(item == Item::BOMB || IS_AGENT(item))
+                {
+                    const int j = b.GetBombIndex(fx, fy);
+                    if(j != -1 && !exploded[j] && t < explosionTime[j])
+                    {
+                        explosionTime[j] = t;
+                    }
+                }
+
+                if(IS_WOOD(item) && (burnt == 0 || burnt >= t))
+                    break;
+            }
+        }
+    }
+}
+
 void PrintMap(RMap &r)
 {
     std::string res = "";
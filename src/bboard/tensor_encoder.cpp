@@ -0,0 +1,244 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "tensor_encoder.hpp"
+#include "step_utility.hpp"
+
+namespace bboard
+{
+
+/**
+ * @brief The cells of an item plane are 1 if (item >> shift) == value.
+ * This is the same as IS_WOOD and IS_FLAME for wood and flames (with any
+ * powerup) and a comparison for all other items.
+ */
+struct _ItemClass
+{
+    int shift;
+    int value;
+};
+
+static const _ItemClass _ITEM_CLASSES[] = {
+    {0, Item::PASSAGE},
+    {0, Item::RIGID},
+    {8, Item::WOOD >> 8},
+    {0, Item::BOMB},
+    {16, Item::FLAME >> 16},
+    {0, Item::FOG},
+    {0, Item::EXTRABOMB},
+    {0, Item::INCRRANGE},
+    {0, Item::KICK}
+};
+
+#ifdef __SSE2__
+
+inline void _store4(float* out, __m128i values)
+{
+    _mm_storeu_ps(out, _mm_cvtepi32_ps(values));
+}
+
+inline void _store4(uint8_t* out, __m128i values)
+{
+    // values are 0 or 1, pack them into the lowest 4 bytes
+    const __m128i packed16 = _mm_packs_epi32(values, values);
+    const int packed8 = _mm_cvtsi128_si32(_mm_packus_epi16(packed16, packed16));
+    std::memcpy(out, &packed8, 4);
+}
+
+#endif // __SSE2__
+
+/**
+ * @brief _classify Writes the item plane of the given class (4 cells at once
+ * if SSE2 is available).
+ */
+template<typename T>
+inline void _classify(const int* items, const _ItemClass& c, T* out)
+{
+    int i = 0;
+#ifdef __SSE2__
+    const __m128i value = _mm_set1_epi32(c.value);
+    const __m128i shift = _mm_cvtsi32_si128(c.shift);
+    const __m128i one = _mm_set1_epi32(1);
+    for(; i + 4 <= CELL_COUNT; i += 4)
+    {
+        const __m128i x = _mm_loadu_si128((const __m128i*)(items + i));
+        const __m128i match = _mm_cmpeq_epi32(_mm_sra_epi32(x, shift), value);
+        _store4(out + i, _mm_and_si128(match, one));
+    }
+#endif
+    for(; i < CELL_COUNT; i++)
+    {
+        out[i] = T((items[i] >> c.shift) == c.value);
+    }
+}
+
+std::vector<Plane> TensorEncoder::DefaultPlanes()
+{
+    std::vector<Plane> planes;
+    for(int p = 0; p < int(Plane::PLANE_COUNT); p++)
+    {
+        if(Plane(p) != Plane::BOMB_MOVING)
+        {
+            planes.push_back(Plane(p));
+        }
+    }
+    return planes;
+}
+
+TensorEncoder::TensorEncoder(std::vector<Plane> planes) : planes(std::move(planes))
+{
+    for(Plane p : this->planes)
+    {
+        if(p >= Plane::PLANE_COUNT)
+        {
+            throw std::runtime_error("Invalid tensor plane " + std::to_string(int(p)));
+        }
+    }
+}
+
+const std::vector<Plane>& TensorEncoder::GetPlanes() const
+{
+    return planes;
+}
+
+int TensorEncoder::PlaneCount() const
+{
+    return (int)planes.size();
+}
+
+int TensorEncoder::Size() const
+{
+    return PlaneCount() * CELL_COUNT;
+}
+
+template<typename T>
+void TensorEncoder::_encode(const Board& board, int agentID, T* out) const
+{
+    const AgentInfo& self = board.agents[agentID];
+
+    for(size_t p = 0; p < planes.size(); p++)
+    {
+        T* plane = out + p * CELL_COUNT;
+        const Plane type = planes[p];
+
+        if(type <= Plane::KICK)
+        {
+            _classify(&board.items[0][0], _ITEM_CLASSES[int(type)], plane);
+            continue;
+        }
+
+        switch(type)
+        {
+            case Plane::SELF_AMMO:
+                std::fill_n(plane, CELL_COUNT, T(std::max(0, self.maxBombCount - self.bombCount)));
+                continue;
+            case Plane::SELF_BOMB_STRENGTH:
+                std::fill_n(plane, CELL_COUNT, T(self.bombStrength));
+                continue;
+            case Plane::SELF_CAN_KICK:
+                std::fill_n(plane, CELL_COUNT, T(self.canKick));
+                continue;
+            default:
+                break;
+        }
+
+        // sparse planes
+        std::fill_n(plane, CELL_COUNT, T(0));
+        switch(type)
+        {
+            case Plane::BOMB_TIME:
+            case Plane::BOMB_STRENGTH:
+            case Plane::BOMB_MOVING:
+                for(int i = 0; i < board.bombs.count; i++)
+                {
+                    const Bomb b = board.bombs[i];
+                    const int value = type == Plane::BOMB_TIME ? BMB_TIME(b)
+                                      : type == Plane::BOMB_STRENGTH ? BMB_STRENGTH(b)
+                                      : BMB_DIR(b) != int(Direction::IDLE);
+                    plane[BMB_POS_X(b) + BOARD_SIZE * BMB_POS_Y(b)] = T(value);
+                }
+                break;
+            case Plane::FLAME_TIME:
+            {
+                // the lifetimes are additive if the flame queue is optimized
+                int timeLeft = 0;
+                for(int i = 0; i < board.flames.count; i++)
+                {
+                    const Flame& f = board.flames[i];
+                    timeLeft = board.currentFlameTime == -1 ? f.timeLeft : timeLeft + f.timeLeft;
+                    plane[f.position.x + BOARD_SIZE * f.position.y] = T(timeLeft);
+                }
+                break;
+            }
+            case Plane::SELF:
+            case Plane::TEAMMATE:
+            case Plane::ENEMIES:
+                for(int i = 0; i < AGENT_COUNT; i++)
+                {
+                    const AgentInfo& other = board.agents[i];
+                    if(other.dead || !other.visible || util::IsOutOfBounds(other.GetPos()))
+                        continue;
+
+                    bool relation;
+                    if(type == Plane::SELF)
+                        relation = i == agentID;
+                    else if(type == Plane::TEAMMATE)
+                        relation = i != agentID && self.team != 0 && other.team == self.team;
+                    else
+                        relation = i != agentID && self.IsEnemy(other);
+
+                    if(relation)
+                    {
+                        plane[other.x + BOARD_SIZE * other.y] = T(1);
+                    }
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void TensorEncoder::Encode(const Board& board, int agentID, float* out) const
+{
+    _encode(board, agentID, out);
+}
+
+void TensorEncoder::Encode(const Board& board, int agentID, uint8_t* out) const
+{
+    _encode(board, agentID, out);
+}
+
+void TensorEncoder::Encode(const Observation& obs, float* out) const
+{
+    _encode(obs, obs.agentID, out);
+}
+
+void TensorEncoder::Encode(const Observation& obs, uint8_t* out) const
+{
+    _encode(obs, obs.agentID, out);
+}
+
+void TensorEncoder::EncodeBatch(const Observation* observations, int count, float* out) const
+{
+    for(int i = 0; i < count; i++)
+    {
+        _encode(observations[i], observations[i].agentID, out + (size_t)i * Size());
+    }
+}
+
+void TensorEncoder::EncodeBatch(const Observation* observations, int count, uint8_t* out) const
+{
+    for(int i = 0; i < count; i++)
+    {
+        _encode(observations[i], observations[i].agentID, out + (size_t)i * Size());
+    }
+}
+
+}
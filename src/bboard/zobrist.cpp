@@ -0,0 +1,70 @@
+#include "bboard.hpp"
+
+namespace bboard::zobrist
+{
+
+/**
+ * @brief _splitMix64 A small random number generator (SplitMix64) which is
+ * used to create the keys deterministically.
+ */
+constexpr uint64_t _splitMix64(uint64_t& x)
+{
+    uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+constexpr Keys _generateKeys()
+{
+    Keys k{};
+    uint64_t seed = 0x5EED;
+    for(int i = 0; i < BOARD_SIZE * BOARD_SIZE; i++)
+    {
+        // passages do not contribute to the hash
+        k.itemKeys[i][Item::PASSAGE] = 0;
+        for(int j = 1; j < ITEM_KEY_COUNT; j++)
+        {
+            k.itemKeys[i][j] = _splitMix64(seed);
+        }
+        k.flameKeys[i] = _splitMix64(seed);
+    }
+
+    for(int i = 0; i < AGENT_COUNT; i++)
+    {
+        k.agentSalts[i] = _splitMix64(seed);
+    }
+    k.bombSalt = _splitMix64(seed);
+    return k;
+}
+
+// constant initialization, does not depend on the order of the dynamic
+// initialization of the translation units
+constexpr Keys keys = _generateKeys();
+
+uint64_t AgentKey(int id, const AgentInfo& info)
+{
+    // positions can be negative for invisible agents
+    uint64_t packed = (uint64_t)(info.x & 0xFF)
+            | (uint64_t)(info.y & 0xFF) << 8
+            | (uint64_t)(info.bombCount & 0xFF) << 16
+            | (uint64_t)(info.maxBombCount & 0xFF) << 24
+            | (uint64_t)(info.bombStrength & 0xFF) << 32
+            | (uint64_t)(info.team & 0xFF) << 40
+            | (uint64_t)info.dead << 48
+            | (uint64_t)info.visible << 49
+            | (uint64_t)info.statsVisible << 50
+            | (uint64_t)info.canKick << 51;
+
+    packed ^= keys.agentSalts[id];
+    return _splitMix64(packed);
+}
+
+uint64_t BombKey(Bomb bomb)
+{
+    // only the bits up to the flag field contain information
+    uint64_t packed = (uint64_t)(bomb & ((1 << (BMB_FLAG_SHIFT + 4)) - 1)) ^ keys.bombSalt;
+    return _splitMix64(packed);
+}
+
+}
@@ -218,6 +218,7 @@ void StateFromJSON(State& state, const nlohmann::json& json)
         // increment agent bomb count
         state.agents[BMB_ID(bomb)].bombCount++;
     }
+    state.RebuildBombIndex();
 
     state.aliveAgents = 0;
 
@@ -308,6 +309,7 @@ void StateFromJSON(State& state, const nlohmann::json& json)
 
     // optimize flames for faster steps
     state.currentFlameTime = util::OptimizeFlameQueue(state);
+    state.RecomputeHash();
 }
 
 State StateFromJSON(const nlohmann::json& json)
@@ -328,6 +330,7 @@ void _sort_bombs(Board& board)
     board.bombs.CopyTo(bombs);
     std::sort(bombs, bombs + board.bombs.count, _bomb_compare_time);
     board.bombs.CopyFrom(bombs, board.bombs.count);
+    board.RebuildBombIndex();
 }
 
 void ObservationFromJSON(Observation& obs, const nlohmann::json& json, int agentId)
@@ -14,6 +14,10 @@ std::unique_ptr<bboard::Agent> PyInterface::new_agent(std::string agentName, lon
     {
         return std::make_unique<agents::SimpleUnbiasedAgent>(seed);
     }
+    else if(agentName == "MCTSAgent")
+    {
+        return std::make_unique<agents::MCTSAgent>(seed);
+    }
     else
     {
         return nullptr;
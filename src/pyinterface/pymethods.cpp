@@ -1,7 +1,11 @@
 #include "pymethods.hpp"
 #include "from_json.hpp"
+#include "profile.hpp"
+#include "tensor_encoder.hpp"
 
 #include <iostream>
+#include <stdexcept>
+#include <string>
 
 // init interface state
 
@@ -88,6 +92,7 @@ int agent_act(char* cjson, bool jsonIsState)
         }
     }
 
+    POMCPP_PROFILE_ACT(agent->id);
     bboard::Move move = agent->act(&PyInterface::observation);
     // agent->Send(new PythonEnvMessage(0, 2, {agent->id, 7}));
     // bboard::PrintState(&PyInterface::state);
@@ -123,3 +128,102 @@ void get_message(int* word0, int* word1)
     
     return;
 }
+
+bboard::TensorEncoder _create_encoder(const int* planes, int planeCount)
+{
+    if(planes == nullptr || planeCount <= 0)
+    {
+        return bboard::TensorEncoder();
+    }
+
+    std::vector<bboard::Plane> selected(planeCount);
+    for(int i = 0; i < planeCount; i++)
+    {
+        // check the range before the value is truncated to the enum type
+        if(planes[i] < 0 || planes[i] >= int(bboard::Plane::PLANE_COUNT))
+        {
+            throw std::runtime_error("Invalid tensor plane " + std::to_string(planes[i]));
+        }
+        selected[i] = bboard::Plane(planes[i]);
+    }
+    return bboard::TensorEncoder(selected);
+}
+
+int encoder_default_plane_count()
+{
+    return (int)bboard::TensorEncoder::DefaultPlanes().size();
+}
+
+int encoder_board_size()
+{
+    return bboard::BOARD_SIZE;
+}
+
+bool encode_observation(const int* planes, int planeCount, float* buffer)
+{
+    if(PyInterface::observation.agentID < 0)
+    {
+        std::cout << "There is no observation to encode!" << std::endl;
+        return false;
+    }
+
+    try
+    {
+        _create_encoder(planes, planeCount).Encode(PyInterface::observation, buffer);
+    }
+    catch(const std::exception& e)
+    {
+        std::cout << "Could not encode the observation: " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+template<typename T>
+bool _encode_json_batch(char** cjsons, int count, bool jsonIsState, const int* agentIDs, const int* planes, int planeCount, T* buffer)
+{
+    try
+    {
+        const bboard::TensorEncoder encoder = _create_encoder(planes, planeCount);
+        auto state = std::make_unique<bboard::State>();
+        auto obs = std::make_unique<bboard::Observation>();
+        for(int i = 0; i < count; i++)
+        {
+            if(agentIDs[i] < 0 || agentIDs[i] >= bboard::AGENT_COUNT)
+            {
+                throw std::runtime_error("Invalid agent id " + std::to_string(agentIDs[i]));
+            }
+
+            nlohmann::json json = nlohmann::json::parse(cjsons[i]);
+            T* out = buffer + (size_t)i * encoder.Size();
+            if(jsonIsState)
+            {
+                *state = bboard::State();
+                StateFromJSON(*state, json);
+                encoder.Encode(*state, agentIDs[i], out);
+            }
+            else
+            {
+                *obs = bboard::Observation();
+                ObservationFromJSON(*obs, json, agentIDs[i]);
+                encoder.Encode(*obs, out);
+            }
+        }
+    }
+    catch(const std::exception& e)
+    {
+        std::cout << "Could not encode the batch: " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool encode_json_batch(char** cjsons, int count, bool jsonIsState, const int* agentIDs, const int* planes, int planeCount, float* buffer)
+{
+    return _encode_json_batch(cjsons, count, jsonIsState, agentIDs, planes, planeCount, buffer);
+}
+
+bool encode_json_batch_u8(char** cjsons, int count, bool jsonIsState, const int* agentIDs, const int* planes, int planeCount, uint8_t* buffer)
+{
+    return _encode_json_batch(cjsons, count, jsonIsState, agentIDs, planes, planeCount, buffer);
+}
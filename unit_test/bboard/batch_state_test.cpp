@@ -0,0 +1,88 @@
+#include <random>
+
+#include "catch.hpp"
+#include "bboard.hpp"
+#include "batch_state.hpp"
+#include "testing_utilities.hpp"
+
+using namespace bboard;
+
+TEST_CASE("Batch State Conversion", "[batch state]")
+{
+    const int N = 4;
+
+    auto batch = std::make_unique<BatchState<N>>();
+    batch->Init(GameMode::TwoTeams, 1234, -1);
+
+    for(int g = 0; g < N; g++)
+    {
+        State s;
+        s.Init(GameMode::TwoTeams, 1234 + g, -1);
+        s.PutBomb(1, 3, 0, 3, 5, true);
+        batch->FromState(g, s);
+
+        State converted;
+        batch->ToState(g, converted);
+        REQUIRE(StatesEqual(s, converted));
+    }
+}
+
+TEST_CASE("Batch Step", "[batch state]")
+{
+    const int N = 16;
+    std::mt19937 rng(42);
+
+    auto batch = std::make_unique<BatchState<N>>();
+    auto reference = std::make_unique<State[]>(N);
+
+    // random games end after a few dozen steps, finished games are
+    // replaced by new ones to cover many games in a single batch
+    auto newGame = [&](int g)
+    {
+        State& s = reference[g];
+        s = State();
+        s.Init(GameMode::FreeForAll, rng(), rng());
+        for(int i = 0; i < AGENT_COUNT; i++)
+        {
+            // let some agents kick to cover the bomb movement
+            s.agents[i].canKick = (g + i) % 2 == 0;
+            s.agents[i].maxBombCount = 1 + (g + i) % 3;
+        }
+        batch->FromState(g, s);
+    };
+
+    for(int g = 0; g < N; g++)
+    {
+        newGame(g);
+    }
+
+    Move moves[N][AGENT_COUNT];
+    CompactState actual, expected;
+    int finishedGames = 0;
+    for(int step = 0; step < 2000; step++)
+    {
+        for(int g = 0; g < N; g++)
+        {
+            FillRandomMoves(rng, moves[g]);
+            reference[g].Step(moves[g]);
+        }
+        batch->StepBatch(moves);
+
+        for(int g = 0; g < N; g++)
+        {
+            INFO("step " << step << ", game " << g);
+            batch->GetGame(g, actual);
+            expected.FromState(reference[g]);
+            REQUIRE(actual == expected);
+
+            // keep some finished games in the batch for a few steps
+            if(reference[g].finished && rng() % 4 == 0)
+            {
+                finishedGames++;
+                newGame(g);
+            }
+        }
+    }
+
+    REQUIRE(finishedGames > 100);
+}
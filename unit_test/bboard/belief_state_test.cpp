@@ -0,0 +1,133 @@
+#include <memory>
+#include <random>
+#include <stdexcept>
+
+#include "catch.hpp"
+#include "bboard.hpp"
+#include "belief_state.hpp"
+#include "testing_utilities.hpp"
+
+using namespace bboard;
+
+/**
+ * @brief _consistentParticle Checks whether the particle is a full state
+ * which agrees with the agents in the observation.
+ */
+bool _consistentParticle(const State& particle, const Observation& obs)
+{
+    for(int y = 0; y < BOARD_SIZE; y++)
+    {
+        for(int x = 0; x < BOARD_SIZE; x++)
+        {
+            if(particle.items[y][x] == Item::FOG)
+                return false;
+        }
+    }
+
+    for(int i = 0; i < AGENT_COUNT; i++)
+    {
+        const AgentInfo& a = particle.agents[i];
+        const AgentInfo& observed = obs.agents[i];
+        if(a.dead != observed.dead)
+            return false;
+        if(a.dead)
+            continue;
+
+        if(observed.visible)
+        {
+            // visible agents are at their observed positions
+            if(a.GetPos() != observed.GetPos())
+                return false;
+        }
+        else if(a.visible)
+        {
+            // hidden agents are outside of the view
+            if(obs.items[a.y][a.x] != Item::FOG || particle.items[a.y][a.x] != Item::AGENT0 + i)
+                return false;
+        }
+    }
+    return true;
+}
+
+TEST_CASE("Belief State", "[belief state]")
+{
+    ObservationParameters params;
+    params.agentPartialMapView = true;
+    // large views would show the whole board on small boards
+    params.agentViewSize = 4 * BOARD_SIZE / 11;
+    params.exposePowerUps = false;
+    params.agentInfoVisibility = AgentInfoVisibility::InView;
+
+    std::mt19937 rng(3);
+    auto s = std::make_unique<State>();
+    auto obs = std::make_unique<Observation>();
+    BeliefState belief(32, 8, 5);
+    REQUIRE(belief.GetParticleCount() == 32);
+
+    bool consistent = true, samplesInPool = true;
+    int resampled = 0, hiddenPowerups = 0;
+    for(int game = 0; game < 4; game++)
+    {
+        *s = State();
+        s->Init(GameMode::TeamRadio, rng(), rng());
+        const int agent = game % AGENT_COUNT;
+
+        Observation::Get(*s, agent, params, *obs);
+        belief.Reset(*obs);
+
+        Move moves[AGENT_COUNT];
+        for(int step = 0; step < 300 && !s->finished && consistent; step++)
+        {
+            FillRandomMoves(rng, moves);
+            s->Step(moves);
+            if(s->agents[agent].dead)
+                break;
+
+            Observation::Get(*s, agent, params, *obs);
+            belief.Update(*obs);
+            resampled += belief.GetResampleCount();
+
+            for(int p = 0; p < belief.GetParticleCount(); p++)
+            {
+                const State& particle = belief.GetParticle(p);
+                consistent = consistent && _consistentParticle(particle, *obs) && particle.timeStep == s->timeStep;
+                for(int y = 0; y < BOARD_SIZE; y++)
+                {
+                    for(int x = 0; x < BOARD_SIZE; x++)
+                    {
+                        hiddenPowerups += IS_WOOD(particle.items[y][x]) && particle.items[y][x] != Item::WOOD;
+                    }
+                }
+            }
+
+            // samples are copies of particles in the pool
+            const State* first = &belief.Sample();
+            for(int k = 1; k < 8; k++)
+            {
+                samplesInPool = samplesInPool && &belief.Sample() != first;
+            }
+            const State& sample = belief.Sample();
+            samplesInPool = samplesInPool && &sample == first;
+
+            bool isParticle = false;
+            for(int p = 0; p < belief.GetParticleCount(); p++)
+            {
+                isParticle = isParticle || belief.GetParticle(p).hash == sample.hash;
+            }
+            consistent = consistent && isParticle;
+
+            // samples are valid states
+            for(int k = 0; k < 8; k++)
+            {
+                belief.Sample().Step(moves);
+            }
+        }
+    }
+
+    REQUIRE(consistent);
+    REQUIRE(samplesInPool);
+    REQUIRE(resampled > 0);
+    REQUIRE(hiddenPowerups > 0);
+
+    REQUIRE_THROWS_AS(BeliefState(0), std::runtime_error);
+}
@@ -0,0 +1,93 @@
+#include <random>
+
+#include "catch.hpp"
+#include "bboard.hpp"
+#include "bitboard.hpp"
+#include "testing_utilities.hpp"
+
+using namespace bboard;
+
+TEST_CASE("Bit Plane Shifts", "[bitboard]")
+{
+    BitPlane p;
+    p.Set(BOARD_SIZE - 1, 0);
+    p.Set(0, BOARD_SIZE - 1);
+
+    // cells must not wrap around the board edges
+    REQUIRE(Shift(p, Direction::RIGHT).Count() == 1);
+    REQUIRE(Shift(p, Direction::RIGHT).Test(1, BOARD_SIZE - 1));
+    REQUIRE(Shift(p, Direction::LEFT).Count() == 1);
+    REQUIRE(Shift(p, Direction::LEFT).Test(BOARD_SIZE - 2, 0));
+    REQUIRE(Shift(p, Direction::DOWN).Count() == 1);
+    REQUIRE(Shift(p, Direction::DOWN).Test(BOARD_SIZE - 1, 1));
+    REQUIRE(Shift(p, Direction::UP).Count() == 1);
+    REQUIRE(Shift(p, Direction::UP).Test(0, BOARD_SIZE - 2));
+
+    REQUIRE((~BitPlane()).Count() == BOARD_SIZE * BOARD_SIZE);
+}
+
+TEST_CASE("BitBoard Conversion", "[bitboard]")
+{
+    State s;
+    s.Init(GameMode::FreeForAll, 1234, -1);
+    s.PutBomb(1, 3, 0, 3, 5, true);
+    s.agents[0].bombCount = 1;
+
+    BitBoard b;
+    b.FromState(s);
+
+    State converted;
+    b.ToState(converted);
+    REQUIRE(StatesEqual(s, converted));
+
+    // flames are converted to the canonical order of the queue, but
+    // converting back results in the same bitboard
+    for(int i = 0; i < 6; i++)
+    {
+        Move moves[AGENT_COUNT] = {Move::IDLE, Move::IDLE, Move::IDLE, Move::IDLE};
+        b.Step(moves);
+    }
+    REQUIRE(b.flames[FLAME_LIFETIME - 2].Any());
+
+    b.ToState(converted);
+    BitBoard reconverted;
+    reconverted.FromState(converted);
+    REQUIRE(b == reconverted);
+}
+
+TEST_CASE("BitBoard Step", "[bitboard]")
+{
+    std::mt19937 rng(1337);
+
+    for(int game = 0; game < 20; game++)
+    {
+        State s;
+        s.Init(GameMode::FreeForAll, rng(), rng());
+        for(int i = 0; i < AGENT_COUNT; i++)
+        {
+            // let some agents kick to cover the bomb movement
+            s.agents[i].canKick = (game + i) % 2 == 0;
+        }
+
+        BitBoard b;
+        b.FromState(s);
+
+        Move moves[AGENT_COUNT];
+        BitBoard expected;
+        for(int step = 0; step < 500 && !s.finished; step++)
+        {
+            FillRandomMoves(rng, moves);
+            s.Step(moves);
+            b.Step(moves);
+
+            INFO("game " << game << ", step " << step);
+            expected.FromState(s);
+            REQUIRE(b == expected);
+
+            // the incrementally updated lookups match a rebuild
+            REQUIRE(b.burning == expected.burning);
+            REQUIRE(std::equal(b.agentMasks, b.agentMasks + CELL_COUNT, expected.agentMasks));
+            REQUIRE(std::equal(b.bombCounts, b.bombCounts + CELL_COUNT, expected.bombCounts));
+        }
+    }
+}
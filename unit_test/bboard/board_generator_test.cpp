@@ -0,0 +1,91 @@
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+
+#include "catch.hpp"
+#include "bboard.hpp"
+#include "board_generator.hpp"
+#include "testing_utilities.hpp"
+
+using namespace bboard;
+
+TEST_CASE("Board Cache Init", "[board generator]")
+{
+    BoardGenerator generator(3);
+
+    BoardKey parameters;
+    BoardCache cache = generator.Generate(100, 50, parameters);
+    REQUIRE(cache.Size() == 50);
+
+    // other parameters (also a padding larger than the breathing room)
+    BoardKey other;
+    other.numRigid = 10 * BOARD_SIZE * BOARD_SIZE / 121;
+    other.numWood = 30 * BOARD_SIZE * BOARD_SIZE / 121;
+    other.numPowerUps = 5 * BOARD_SIZE * BOARD_SIZE / 121;
+    other.padding = BOARD_SIZE / 2 - 1;
+    std::vector<BoardKey> keys = {other, parameters};
+    keys[1].boardSeed = 100;
+    BoardCache small = generator.Generate(keys);
+    REQUIRE(small.Size() == 2);
+
+    auto expected = std::make_unique<State>();
+    auto cached = std::make_unique<State>();
+    for(int seed = 100; seed < 150; seed++)
+    {
+        BoardKey key = parameters;
+        key.boardSeed = seed;
+        const long agentSeed = seed % 3 == 0 ? -1 : seed;
+
+        expected->Init(GameMode::TwoTeams, seed, agentSeed);
+        *cached = State();
+        REQUIRE(cache.Init(*cached, GameMode::TwoTeams, key, agentSeed));
+        REQUIRE(StatesEqual(*expected, *cached));
+        REQUIRE(expected->hash == cached->hash);
+    }
+
+    expected->Init(GameMode::FreeForAll, other.boardSeed, 7, other.numRigid, other.numWood, other.numPowerUps, other.padding);
+    *cached = State();
+    REQUIRE(small.Init(*cached, GameMode::FreeForAll, other, 7));
+    REQUIRE(StatesEqual(*expected, *cached));
+
+    // boards which are not in the cache are generated
+    other.boardSeed = 1;
+    *cached = State();
+    REQUIRE_FALSE(small.Init(*cached, GameMode::FreeForAll, other, 7));
+    expected->Init(GameMode::FreeForAll, 1, 7, other.numRigid, other.numWood, other.numPowerUps, other.padding);
+    REQUIRE(StatesEqual(*expected, *cached));
+}
+
+TEST_CASE("Board Cache File", "[board generator]")
+{
+    BoardGenerator generator(2);
+    BoardCache cache = generator.Generate(7, 20);
+
+    const std::string path = "board_cache_test.bin";
+    cache.Save(path);
+
+    {
+        BoardCache loaded = BoardCache::Load(path);
+        REQUIRE(loaded.Size() == cache.Size());
+        for(int i = 0; i < cache.Size(); i++)
+        {
+            const CachedBoard* board = loaded.Find(cache.Boards()[i].key);
+            REQUIRE(board != nullptr);
+            REQUIRE(std::equal(&board->items[0][0], &board->items[0][0] + BOARD_SIZE * BOARD_SIZE, &cache.Boards()[i].items[0][0]));
+        }
+
+        // the loaded cache can be moved
+        BoardCache moved = std::move(loaded);
+        REQUIRE(moved.Size() == cache.Size());
+        REQUIRE(loaded.Size() == 0);
+    }
+
+    // invalid files are rejected
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << "not a board cache";
+    }
+    REQUIRE_THROWS_AS(BoardCache::Load(path), std::runtime_error);
+    std::remove(path.c_str());
+}
@@ -2,6 +2,7 @@
 
 #include "catch.hpp"
 #include "bboard.hpp"
+#include "step_utility.hpp"
 
 using namespace bboard;
 /**
@@ -62,14 +63,18 @@ void PlantBomb(State* s, int x, int y, int id, bool setItem=false)
     agent.x = x;
     agent.y = y;
     // then plants a bomb
-    s->TryPutBomb<false>(id, setItem);
+    util::TryPutBomb<false>(s, id, setItem);
     // then moves back
     agent.x = oldPosition.x;
     agent.y = oldPosition.y;
 }
 
-TEST_CASE("Basic Non-Obstacle Movement", "[step function]")
+TEST_CASE("Basic Non-Obstacle Movement", "[step function][default-size]")
 {
+    // the positions are hard-coded for the default board size
+    if(BOARD_SIZE != 11)
+        return;
+
     auto s = std::make_unique<bboard::State>();
     s->PutAgentsInCorners(0, 1, 2, 3, 0);
 
@@ -329,7 +334,7 @@ TEST_CASE("Ouroboros", "[step function]")
     SECTION("Ouroboros with bomb")
     {
         // when player 0 plants a bomb, no player can move
-        s->TryPutBomb<false>(0);
+        util::TryPutBomb<false>(s, 0);
         s->Step(m);
         REQUIRE_OUROBOROS_MOVED(s, false);
     }
@@ -337,7 +342,7 @@ TEST_CASE("Ouroboros", "[step function]")
     {
         // when player 1 plants a bomb and player 0 can kick it
         // then we can move
-        s->TryPutBomb<false>(1);
+        util::TryPutBomb<false>(s, 1);
         s->agents[0].canKick = true;
         s->Step(m);
         REQUIRE_OUROBOROS_MOVED(s, true);
@@ -346,7 +351,7 @@ TEST_CASE("Ouroboros", "[step function]")
         SECTION("Ouroboros with bomb kick - 2 - " + std::to_string((int)i))
         {
             // does not work when the movement is blocked by something
-            s->TryPutBomb<false>(1);
+            util::TryPutBomb<false>(s, 1);
             s->agents[0].canKick = true;
             s->PutItem(2, 0, i);
             s->Step(m);
@@ -356,7 +361,7 @@ TEST_CASE("Ouroboros", "[step function]")
     SECTION("Ouroboros with bomb kick - 3")
     {
         // also works vertically
-        s->TryPutBomb<false>(2);
+        util::TryPutBomb<false>(s, 2);
         s->agents[1].canKick = true;
         s->Step(m);
         REQUIRE_OUROBOROS_MOVED(s, true);
@@ -365,7 +370,7 @@ TEST_CASE("Ouroboros", "[step function]")
     {
         // doesn't work for players 0 and 3 because the bomb cannot
         // be kicked out of bounds
-        s->TryPutBomb<false>(0);
+        util::TryPutBomb<false>(s, 0);
         s->agents[3].canKick = true;
         s->Step(m);
         REQUIRE_OUROBOROS_MOVED(s, false);
@@ -436,8 +441,12 @@ TEST_CASE("Bomb Mechanics", "[step function]")
 }
 
 
-TEST_CASE("Bomb Explosion", "[step function]")
+TEST_CASE("Bomb Explosion", "[step function][default-size]")
 {
+    // the positions are hard-coded for the default board size
+    if(BOARD_SIZE != 11)
+        return;
+
     auto s = std::make_unique<bboard::State>();
     bboard::Move id = bboard::Move::IDLE;
     bboard::Move m[4] = {id, id, id, id};
@@ -530,8 +539,12 @@ TEST_CASE("Bomb Explosion", "[step function]")
     }
 }
 
-TEST_CASE("Bomb Explosion - Special Cases", "[step function]")
+TEST_CASE("Bomb Explosion - Special Cases", "[step function][default-size]")
 {
+    // the positions are hard-coded for the default board size
+    if(BOARD_SIZE != 11)
+        return;
+
     auto s = std::make_unique<bboard::State>();
     bboard::Move id = bboard::Move::IDLE;
     bboard::Move m[4] = {id, id, id, id};
@@ -595,8 +608,12 @@ TEST_CASE("Bomb Explosion - Special Cases", "[step function]")
     }
 }
 
-TEST_CASE("Flame Mechanics", "[step function]")
+TEST_CASE("Flame Mechanics", "[step function][default-size]")
 {
+    // the positions are hard-coded for the default board size
+    if(BOARD_SIZE != 11)
+        return;
+
     auto s = std::make_unique<bboard::State>();
     bboard::Move id = bboard::Move::IDLE;
     bboard::Move m[4] = {id, id, id, id};
@@ -704,8 +721,12 @@ TEST_CASE("Flame Mechanics", "[step function]")
     }
 }
 
-TEST_CASE("Chained Explosions", "[step function]")
+TEST_CASE("Chained Explosions", "[step function][default-size]")
 {
+    // the positions are hard-coded for the default board size
+    if(BOARD_SIZE != 11)
+        return;
+
     auto s = std::make_unique<bboard::State>();
     bboard::Move id = bboard::Move::IDLE;
     bboard::Move m[4] = {id, id, id, id};
@@ -747,8 +768,12 @@ TEST_CASE("Chained Explosions", "[step function]")
     }
 }
 
-TEST_CASE("Bomb Kick Mechanics", "[step function]")
+TEST_CASE("Bomb Kick Mechanics", "[step function][default-size]")
 {
+    // the positions are hard-coded for the default board size
+    if(BOARD_SIZE != 11)
+        return;
+
     auto s = std::make_unique<bboard::State>();
     bboard::Move id = bboard::Move::IDLE;
     bboard::Move m[4] = {id, id, id, id};
@@ -0,0 +1,92 @@
+#include <random>
+
+#include "catch.hpp"
+#include "bboard.hpp"
+#include "bitboard.hpp"
+#include "step_utility.hpp"
+
+using namespace bboard;
+
+TEST_CASE("Bomb Encoding", "[board size]")
+{
+    // every field keeps its value when the other fields are set to their maximum
+    Bomb b = 0;
+    SetBombPosition(b, BOARD_SIZE - 1, BOARD_SIZE - 1);
+    SetBombID(b, AGENT_COUNT - 1);
+    SetBombStrength(b, BOARD_SIZE - 1);
+    SetBombTime(b, BOMB_LIFETIME + 1);
+    SetBombDirection(b, Direction::RIGHT);
+    SetBombFlag(b, true);
+
+    REQUIRE(b >= 0);
+    REQUIRE(BMB_POS(b) == Position{BOARD_SIZE - 1, BOARD_SIZE - 1});
+    REQUIRE(BMB_ID(b) == AGENT_COUNT - 1);
+    REQUIRE(BMB_STRENGTH(b) == BOARD_SIZE - 1);
+    REQUIRE(BMB_TIME(b) == BOMB_LIFETIME + 1);
+    REQUIRE(BMB_DIR(b) == int(Direction::RIGHT));
+    REQUIRE(BMB_FLAG(b) == 1);
+
+    SetBombPosition(b, 0, 1);
+    ReduceBombTimer(b);
+    REQUIRE(BMB_POS(b) == Position{0, 1});
+    REQUIRE(BMB_STRENGTH(b) == BOARD_SIZE - 1);
+    REQUIRE(BMB_TIME(b) == BOMB_LIFETIME);
+}
+
+TEST_CASE("Bit Plane Random Shifts", "[board size]")
+{
+    std::mt19937 rng(99);
+    std::bernoulli_distribution bit(0.3);
+    const Direction directions[4] = {Direction::UP, Direction::DOWN, Direction::LEFT, Direction::RIGHT};
+
+    bool equal = true;
+    for(int i = 0; i < 100 && equal; i++)
+    {
+        BitPlane p;
+        for(int c = 0; c < CELL_COUNT; c++)
+        {
+            if(bit(rng))
+                p.Set(c);
+        }
+
+        for(Direction d : directions)
+        {
+            // compare against a cell by cell shift
+            BitPlane expected;
+            p.ForEach([&expected, d](int x, int y)
+            {
+                Position dest = util::DesiredPosition(x, y, Move(int(d)));
+                if(!util::IsOutOfBounds(dest))
+                    expected.Set(dest.x, dest.y);
+            });
+            equal = equal && Shift(p, d) == expected;
+        }
+    }
+    REQUIRE(equal);
+}
+
+TEST_CASE("Default Board Generation", "[board size]")
+{
+    for(int seed = 0; seed < 10; seed++)
+    {
+        State s;
+        s.Init(GameMode::FreeForAll, seed, seed);
+
+        int rigid = 0, wood = 0;
+        for(int y = 0; y < BOARD_SIZE; y++)
+        {
+            for(int x = 0; x < BOARD_SIZE; x++)
+            {
+                rigid += s.items[y][x] == Item::RIGID;
+                wood += IS_WOOD(s.items[y][x]);
+            }
+        }
+        REQUIRE(rigid == DEFAULT_NUM_RIGID);
+        REQUIRE(wood >= DEFAULT_NUM_WOOD);
+
+        for(int i = 0; i < AGENT_COUNT; i++)
+        {
+            REQUIRE(s.items[s.agents[i].y][s.agents[i].x] == Item::AGENT0 + i);
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#include <memory>
+
+#include "catch.hpp"
+#include "bboard.hpp"
+#include "testing_utilities.hpp"
+
+using namespace bboard;
+
+int _linearBombIndex(const Board& b, int x, int y)
+{
+    for(int i = 0; i < b.bombs.count; i++)
+    {
+        if(BMB_POS_X(b.bombs[i]) == x && BMB_POS_Y(b.bombs[i]) == y)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief _bombIndexMismatch Returns the first cell where the bomb index
+ * differs from a linear search, (-1, -1) if the index is consistent.
+ */
+Position _bombIndexMismatch(const Board& b)
+{
+    for(int y = 0; y < BOARD_SIZE; y++)
+    {
+        for(int x = 0; x < BOARD_SIZE; x++)
+        {
+            if(b.GetBombIndex(x, y) != _linearBombIndex(b, x, y))
+                return {x, y};
+        }
+    }
+    return {-1, -1};
+}
+
+TEST_CASE("Bomb Index", "[bomb index]")
+{
+    ObservationParameters params;
+    params.agentPartialMapView = true;
+    params.agentViewSize = 4;
+    auto obs = std::make_unique<Observation>();
+    auto fromObs = std::make_unique<State>();
+
+    // kicked bombs are moved and removed from the middle of the queue
+    PlayRandomGames(42, 100, 500, [&](State& s, Move* moves)
+    {
+        s.Step(moves);
+        REQUIRE(_bombIndexMismatch(s) == Position{-1, -1});
+
+        // bombs are filtered in partial observations
+        *obs = Observation();
+        *fromObs = State();
+        Observation::Get(s, s.timeStep % AGENT_COUNT, params, *obs);
+        obs->ToState(*fromObs);
+        REQUIRE(_bombIndexMismatch(*obs) == Position{-1, -1});
+        REQUIRE(_bombIndexMismatch(*fromObs) == Position{-1, -1});
+    });
+}
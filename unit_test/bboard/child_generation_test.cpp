@@ -0,0 +1,115 @@
+#include <memory>
+#include <random>
+
+#include "catch.hpp"
+#include "bboard.hpp"
+#include "child_generation.hpp"
+#include "testing_utilities.hpp"
+
+using namespace bboard;
+
+/**
+ * @brief Checks that the children of s cover every joint action of the
+ * masks exactly once and that they are equal to the regular steps.
+ */
+bool _childrenEqualSteps(const State& s, const MoveMask masks[AGENT_COUNT], int& children)
+{
+    int visits[ACTION_COUNT][ACTION_COUNT][ACTION_COUNT][ACTION_COUNT] = {};
+    bool equal = true;
+    children = 0;
+
+    auto expected = std::make_unique<State>();
+    GenerateChildren(s, masks, [&](const Move* moves, const MoveMask* equivalent, const State& child)
+    {
+        children++;
+        for(int i = 0; i < AGENT_COUNT; i++)
+        {
+            equal = equal && (equivalent[i] & MoveBit(moves[i])) && (equivalent[i] & ~masks[i]) == 0;
+        }
+
+        // all joint actions of the equivalent moves result in this child
+        for(int a = 0; a < ACTION_COUNT; a++)
+        for(int b = 0; b < ACTION_COUNT; b++)
+        for(int c = 0; c < ACTION_COUNT; c++)
+        for(int d = 0; d < ACTION_COUNT; d++)
+        {
+            Move m[AGENT_COUNT] = {Move(a), Move(b), Move(c), Move(d)};
+            bool inClass = true;
+            for(int i = 0; i < AGENT_COUNT; i++)
+            {
+                inClass = inClass && (equivalent[i] & MoveBit(m[i]));
+            }
+            if(!inClass)
+                continue;
+
+            visits[a][b][c][d]++;
+            *expected = s;
+            expected->Step(m);
+            equal = equal && StatesEqual(*expected, child) && expected->hash == child.hash;
+        }
+    });
+
+    // every joint action of the masks is covered exactly once
+    for(int a = 0; a < ACTION_COUNT; a++)
+    for(int b = 0; b < ACTION_COUNT; b++)
+    for(int c = 0; c < ACTION_COUNT; c++)
+    for(int d = 0; d < ACTION_COUNT; d++)
+    {
+        const bool inMasks = (masks[0] & MoveBit(Move(a))) && (masks[1] & MoveBit(Move(b)))
+                && (masks[2] & MoveBit(Move(c))) && (masks[3] & MoveBit(Move(d)));
+        equal = equal && visits[a][b][c][d] == (inMasks ? 1 : 0);
+    }
+    return equal;
+}
+
+TEST_CASE("Generate Children", "[child generation]")
+{
+    std::mt19937 rng(31);
+    const MoveMask allMoves[AGENT_COUNT] = {ALL_MOVES, ALL_MOVES, ALL_MOVES, ALL_MOVES};
+
+    int totalChildren = 0;
+    int states = 0;
+    for(int game = 0; game < 6; game++)
+    {
+        auto s = std::make_unique<State>();
+        s->Init(GameMode::TwoTeams, rng(), rng());
+        for(int i = 0; i < AGENT_COUNT; i++)
+        {
+            s->agents[i].canKick = (game + i) % 2 == 0;
+        }
+        s->RecomputeHash();
+
+        Move moves[AGENT_COUNT];
+        for(int step = 0; step < 120 && !s->finished; step++)
+        {
+            if(step % 10 == 0)
+            {
+                int children;
+                REQUIRE(_childrenEqualSteps(*s, allMoves, children));
+                totalChildren += children;
+                states++;
+            }
+
+            FillRandomMoves(rng, moves);
+            s->Step(moves);
+        }
+    }
+
+    // the equivalent moves reduce the number of children
+    REQUIRE(totalChildren < states * 1296);
+
+    // partial masks
+    auto s = std::make_unique<State>();
+    s->Init(GameMode::FreeForAll, 5, 5);
+    const MoveMask masks[AGENT_COUNT] = {
+        MoveMask(MoveBit(Move::IDLE) | MoveBit(Move::BOMB)), ALL_MOVES,
+        MoveMask(MoveBit(Move::UP) | MoveBit(Move::LEFT)), MoveBit(Move::RIGHT)
+    };
+    int children;
+    REQUIRE(_childrenEqualSteps(*s, masks, children));
+
+    // no children without moves
+    const MoveMask noMoves[AGENT_COUNT] = {ALL_MOVES, 0, ALL_MOVES, ALL_MOVES};
+    REQUIRE(_childrenEqualSteps(*s, noMoves, children));
+    REQUIRE(children == 0);
+}
@@ -0,0 +1,70 @@
+#include <random>
+
+#include "catch.hpp"
+#include "bboard.hpp"
+#include "compact_state.hpp"
+#include "testing_utilities.hpp"
+
+using namespace bboard;
+
+TEST_CASE("Compact State Conversion", "[compact state]")
+{
+    State s;
+    s.Init(GameMode::TwoTeams, 1234, -1);
+    s.PutBomb(1, 3, 0, 3, 5, true);
+
+    CompactState c;
+    c.FromState(s);
+
+    State converted;
+    c.ToState(converted);
+    REQUIRE(StatesEqual(s, converted));
+
+    // flames are converted to the canonical order of the queue, but
+    // converting back results in the same compact state
+    for(int i = 0; i < 6; i++)
+    {
+        Move moves[AGENT_COUNT] = {Move::IDLE, Move::IDLE, Move::IDLE, Move::IDLE};
+        c.Step(moves);
+    }
+    c.ToState(converted);
+    REQUIRE(converted.flames.count > 0);
+
+    CompactState reconverted;
+    reconverted.FromState(converted);
+    REQUIRE(c == reconverted);
+}
+
+TEST_CASE("Compact State Step", "[compact state]")
+{
+    std::mt19937 rng(1338);
+
+    for(int game = 0; game < 20; game++)
+    {
+        State s;
+        s.Init(GameMode::FreeForAll, rng(), rng());
+        for(int i = 0; i < AGENT_COUNT; i++)
+        {
+            // let some agents kick to cover the bomb movement
+            s.agents[i].canKick = (game + i) % 2 == 0;
+            s.agents[i].maxBombCount = 1 + (game + i) % 3;
+        }
+
+        CompactState c;
+        c.FromState(s);
+
+        Move moves[AGENT_COUNT];
+        CompactState expected;
+        bool equal = true;
+        for(int step = 0; step < 500 && !s.finished && equal; step++)
+        {
+            FillRandomMoves(rng, moves);
+            s.Step(moves);
+            c.Step(moves);
+
+            expected.FromState(s);
+            equal = c == expected;
+        }
+        REQUIRE(equal);
+    }
+}
@@ -0,0 +1,77 @@
+#include <memory>
+
+#include "catch.hpp"
+#include "bboard.hpp"
+#include "step_utility.hpp"
+#include "testing_utilities.hpp"
+
+using namespace bboard;
+
+bool _flameBucketsConsistent(const Board& b)
+{
+    int buckets[FLAME_LIFETIME] = {};
+    int cumulativeTime = 0;
+    for(int i = 0; i < b.flames.count; i++)
+    {
+        const Flame& f = b.flames[i];
+        cumulativeTime += f.timeLeft;
+        if(cumulativeTime < 1 || cumulativeTime > FLAME_LIFETIME)
+            return false;
+
+        // only the first flame of a bucket stores the time difference
+        if(buckets[cumulativeTime - 1] > 0 && f.timeLeft != 0)
+            return false;
+
+        buckets[cumulativeTime - 1]++;
+        if(b.GetFlameIndex(f.position.x, f.position.y) != i || b.GetFlameLifetime(i) != cumulativeTime)
+            return false;
+    }
+
+    return std::equal(buckets, buckets + FLAME_LIFETIME, b.flameBuckets)
+            && (b.flames.count == 0 || b.currentFlameTime == cumulativeTime);
+}
+
+TEST_CASE("Flame Buckets", "[flame buckets]")
+{
+    PlayRandomGames(4, 100, 500, [](State& s, Move* moves)
+    {
+        s.Step(moves);
+        REQUIRE(_flameBucketsConsistent(s));
+    });
+}
+
+TEST_CASE("Overwrite Newest Flame Bucket", "[flame buckets]")
+{
+    auto state = std::make_unique<State>();
+    State& s = *state;
+    s.PutAgentsInCorners(0, 1, 2, 3, 0);
+    s.timeStep = 0;
+
+    // flames with absolute lifetimes
+    s.currentFlameTime = -1;
+    s.flames.AddElem({{5, 5}, 3, -1});
+    s.flames.AddElem({{3, 3}, 2, -1});
+    s.items[5][5] = Item::FLAME;
+    s.items[3][3] = Item::FLAME;
+    s.currentFlameTime = util::OptimizeFlameQueue(s);
+    REQUIRE(_flameBucketsConsistent(s));
+
+    // a bomb explodes on top of the newest flame
+    s.PutBomb(5, 5, 0, 1, 1, false);
+    s.RecomputeHash();
+
+    Move m[AGENT_COUNT] = {Move::IDLE, Move::IDLE, Move::IDLE, Move::IDLE};
+    s.Step(m);
+    REQUIRE(_flameBucketsConsistent(s));
+    REQUIRE(s.GetFlameLifetime(s.GetFlameIndex(5, 5)) == FLAME_LIFETIME);
+
+    // the new flame burns for the full lifetime
+    for(int i = 0; i < FLAME_LIFETIME - 1; i++)
+    {
+        s.Step(m);
+        REQUIRE(IS_FLAME(s.items[5][5]));
+    }
+    s.Step(m);
+    REQUIRE(!IS_FLAME(s.items[5][5]));
+    REQUIRE(s.flames.count == 0);
+}
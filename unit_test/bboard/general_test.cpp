@@ -77,3 +77,41 @@ TEST_CASE("Fixed Size Queue", "[general]")
         TestQueue(queue);
     }
 }
+
+TEST_CASE("Bit Plane Cells", "[general]")
+{
+    BitPlane mask;
+    REQUIRE(!mask.Any());
+
+    std::vector<int> cells;
+    for(int c : {0, 5, 63, 64, 100, BOARD_SIZE * BOARD_SIZE - 1})
+    {
+        // skip cells which do not exist on small boards
+        if(c >= BOARD_SIZE * BOARD_SIZE || (!cells.empty() && c <= cells.back()))
+            continue;
+        cells.push_back(c);
+        mask.Set(c);
+        REQUIRE(mask.Test(c));
+    }
+    REQUIRE(mask.Any());
+
+    std::vector<int> visited;
+    mask.ForEachIndex([&](int c) { visited.push_back(c); });
+    REQUIRE(visited == cells);
+
+    // ranges include both bounds, also across word boundaries
+    if(BOARD_SIZE * BOARD_SIZE > 64)
+    {
+        visited.clear();
+        mask.ForEachIndex([&](int c) { visited.push_back(c); }, 5, 64);
+        REQUIRE(visited == std::vector<int>({5, 63, 64}));
+    }
+
+    // the last cell is set
+    visited.clear();
+    mask.ForEachIndex([&](int c) { visited.push_back(c); }, 6, std::min(62, BOARD_SIZE * BOARD_SIZE - 2));
+    REQUIRE(visited.empty());
+
+    mask.Reset();
+    REQUIRE(!mask.Any());
+}
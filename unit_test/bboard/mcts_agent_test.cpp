@@ -0,0 +1,143 @@
+#include <chrono>
+#include <memory>
+#include <random>
+#include <stdexcept>
+
+#include "catch.hpp"
+#include "bboard.hpp"
+#include "agents.hpp"
+#include "pymethods.hpp"
+#include "testing_utilities.hpp"
+
+using namespace bboard;
+
+/**
+ * @brief _escapeState Agent 0 stands on its own bomb in the top left
+ * corner, it only survives if it moves to the right (and then down).
+ */
+void _escapeState(State& s)
+{
+    s = State();
+    s.PutAgent(0, 0, 0);
+    s.PutAgent(BOARD_SIZE - 1, BOARD_SIZE - 1, 1);
+    s.Kill(2, 3);
+    s.PutItem(0, 1, Item::RIGID);
+    s.PutBomb(0, 0, 0, 2, 3, false);
+    s.agents[0].bombCount = 1;
+}
+
+/**
+ * @brief _drawState Agent 0 dies in the first step unless it moves down,
+ * then it dies in the second step together with agent 1 (draw).
+ */
+void _drawState(State& s)
+{
+    s = State();
+    s.PutAgent(1, 0, 0);
+    s.PutAgent(3, 2, 1);
+    s.Kill(2, 3);
+    s.PutItem(2, 0, Item::RIGID);
+    s.PutItem(0, 1, Item::RIGID);
+    s.PutItem(2, 1, Item::RIGID);
+    s.PutItem(3, 1, Item::RIGID);
+    s.PutItem(4, 2, Item::RIGID);
+    s.PutItem(3, 3, Item::RIGID);
+    s.PutBomb(0, 0, 0, 1, 1, true);
+    s.PutBomb(1, 2, 1, 2, 2, true);
+}
+
+TEST_CASE("MCTS Agent", "[mcts agent]")
+{
+    auto s = std::make_unique<State>();
+    auto obs = std::make_unique<Observation>();
+
+    MCTSParameters params;
+    params.iterations = 2000;
+    params.timeBudgetMs = 0;
+
+    SECTION("Escapes From Bombs")
+    {
+        for(RolloutPolicy policy : {RolloutPolicy::RANDOM, RolloutPolicy::SIMPLE})
+        {
+            params.rolloutPolicy = policy;
+            params.iterations = policy == RolloutPolicy::RANDOM ? 2000 : 300;
+            MCTSAgent agent(7, params);
+            agent.id = 0;
+
+            _escapeState(*s);
+            Observation::Get(*s, 0, ObservationParameters(), *obs);
+            REQUIRE(agent.act(obs.get()) == Move::RIGHT);
+            REQUIRE(agent.GetLastIterations() == params.iterations);
+
+            int visits[ACTION_COUNT];
+            agent.GetRootVisits(visits);
+            REQUIRE(visits[0] + visits[1] + visits[2] + visits[3] + visits[4] + visits[5] == params.iterations);
+        }
+    }
+    SECTION("Prefers Draws Over Losses")
+    {
+        MCTSAgent agent(7, params);
+        agent.id = 0;
+
+        _drawState(*s);
+        Observation::Get(*s, 0, ObservationParameters(), *obs);
+        REQUIRE(agent.act(obs.get()) == Move::DOWN);
+    }
+    SECTION("Determinism")
+    {
+        std::mt19937 rng(3);
+        s->Init(GameMode::FreeForAll, 11, 11);
+
+        MCTSAgent a(5, params), b(5, params);
+        a.id = b.id = 2;
+        Move moves[AGENT_COUNT];
+        for(int step = 0; step < 10 && !s->finished; step++)
+        {
+            Observation::Get(*s, 2, ObservationParameters(), *obs);
+            const Move m = a.act(obs.get());
+            REQUIRE(m == b.act(obs.get()));
+
+            FillRandomMoves(rng, moves);
+            moves[2] = m;
+            s->Step(moves);
+        }
+    }
+    SECTION("Time Budget")
+    {
+        params.iterations = 0;
+        params.timeBudgetMs = 20;
+        MCTSAgent agent(1, params);
+        agent.id = 0;
+
+        s->Init(GameMode::FreeForAll, 1, 1);
+        Observation::Get(*s, 0, ObservationParameters(), *obs);
+
+        auto t0 = std::chrono::steady_clock::now();
+        agent.act(obs.get());
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - t0;
+
+        REQUIRE(agent.GetLastIterations() > 0);
+        REQUIRE(elapsed.count() < 1000);
+    }
+    SECTION("Plays Against Simple Agents")
+    {
+        params.iterations = 100;
+        std::mt19937 rng(42);
+        MCTSAgent agent(3, params);
+        SimpleAgent s1(rng()), s2(rng()), s3(rng());
+
+        Environment env;
+        env.MakeGame({&agent, &s1, &s2, &s3}, GameMode::FreeForAll, 7);
+        for(int step = 0; step < 100 && !env.IsDone(); step++)
+        {
+            env.Step();
+        }
+        REQUIRE(agent.GetLastIterations() == params.iterations);
+    }
+
+    MCTSParameters noBudget;
+    noBudget.iterations = 0;
+    noBudget.timeBudgetMs = 0;
+    REQUIRE_THROWS_AS(MCTSAgent(0, noBudget), std::runtime_error);
+    REQUIRE(PyInterface::new_agent("MCTSAgent", 0) != nullptr);
+}
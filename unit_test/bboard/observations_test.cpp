@@ -1,7 +1,9 @@
 #include <iostream>
+#include <random>
 
 #include "catch.hpp"
 #include "bboard.hpp"
+#include "testing_utilities.hpp"
 
 using namespace bboard;
 
@@ -265,6 +267,49 @@ TEST_CASE("Hidden Flames", "[observation]")
     REQUIRE(obs.flames[0].timeLeft == bboard::FLAME_LIFETIME);
 }
 
+TEST_CASE("Virtual Step Adds New Flames", "[observation]")
+{
+    ObservationParameters params;
+    params.agentPartialMapView = true;
+    params.agentViewSize = 2;
+
+    State s;
+    s.Clear(Item::PASSAGE);
+    s.timeStep = 0;
+    // empty optimized flame queue (like after State::Init)
+    s.currentFlameTime = 0;
+    s.PutAgentsInCorners(0, 1, 2, 3, 1);
+
+    Observation obs;
+    Observation::Get(s, 0, params, obs);
+    State reconstructed;
+    obs.ToState(reconstructed);
+
+    // the bomb explodes in the next step, one of its flames is out of view
+    s.PutBomb(3, 1, 0, 1, 1, true);
+    Move m[AGENT_COUNT];
+    std::fill_n(m, AGENT_COUNT, Move::IDLE);
+
+    for(int step = 0; step < 2; step++)
+    {
+        INFO("step " << step);
+        s.Step(m);
+        Observation::Get(s, 0, params, obs);
+        REQUIRE(obs.flames.count == 4);
+
+        // every visible flame is added exactly once
+        obs.VirtualStep(reconstructed, false, false, nullptr);
+        REQUIRE(reconstructed.flames.count == obs.flames.count);
+        for(int i = 0; i < obs.flames.count; i++)
+        {
+            const Position& p = obs.flames[i].position;
+            const int index = reconstructed.GetFlameIndex(p.x, p.y);
+            REQUIRE(index != -1);
+            REQUIRE(reconstructed.GetFlameLifetime(index) == FLAME_LIFETIME - step);
+        }
+    }
+}
+
 TEST_CASE("Bomb moves into fog", "[observation]")
 {
     bool print = false;
@@ -483,8 +528,12 @@ void ClearBombOwnership(Observation& obs)
     }
 }
 
-TEST_CASE("TrackStats Tests", "[stats tracking]")
+TEST_CASE("TrackStats Tests", "[stats tracking][default-size]")
 {
+    // the positions are hard-coded for the default board size
+    if(BOARD_SIZE != 11)
+        return;
+
     ObservationParameters params;
     params.agentInfoVisibility = AgentInfoVisibility::OnlySelf;
     params.agentPartialMapView = false;
@@ -853,4 +902,280 @@ TEST_CASE("TrackStats Tests", "[stats tracking]")
         REQUIRE(bboard::BMB_ID(obs.bombs[0]) == 0);
         REQUIRE(obs.agents[0].bombCount == 1);
     }
+    SECTION("Bomb tracking - kicking bombs head-on")
+    {
+        s->agents[0].canKick = true;
+        s->PutAgent(0, 1, 0);
+        s->PutAgent(5, 1, 1);
+        s->PutAgent(BOARD_SIZE - 1, BOARD_SIZE - 1, 2);
+        s->PutBomb(3, 1, 1, 1, 10, true);
+        Bomb &b = s->bombs[0];
+        SetBombDirection(b, Direction::LEFT);
+        s->Kill(3);
+        // 0     b  1
+
+        // important: get initial stats from state as we artificially placed the bomb
+        State initialState = *s;
+        initialState.agents[0].canKick = false;
+        s->Step(m);
+        Observation::Get(*s, 2, params, obs);
+        obs.TrackStats(initialState);
+
+        REQUIRE(bboard::BMB_ID(obs.bombs[0]) == 1);
+        REQUIRE(obs.agents[0].canKick == false);
+        oldObs = obs;
+
+        // bomb moves left, agent moves right
+        m[0] = bboard::Move::RIGHT;
+        s->Step(m);
+
+        // expected:
+        //    0  b     1
+        REQUIRE(s->bombs.count == 1);
+        REQUIRE(bboard::BMB_POS_X(s->bombs[0]) == 2);
+        REQUIRE(bboard::BMB_DIR(s->bombs[0]) == (int)Direction::RIGHT);
+
+        Observation::Get(*s, 2, params, obs);
+        ClearBombOwnership(obs);
+
+        // the bomb is not behind its movement, it has to be found behind the agent
+        int errors = 0;
+        obs.TrackStats(oldObs, &errors);
+        REQUIRE(errors == 0);
+        REQUIRE(bboard::BMB_ID(obs.bombs[0]) == 1);
+        REQUIRE(obs.agents[0].canKick == true);
+        REQUIRE(obs.agents[0].bombCount == 0);
+        REQUIRE(obs.agents[1].bombCount == 1);
+    }
+    SECTION("Bomb tracking - chained kicks")
+    {
+        s->agents[0].canKick = true;
+        s->agents[1].canKick = true;
+        s->PutAgent(0, 1, 0);
+        s->PutAgent(5, 1, 1);
+        s->PutAgent(BOARD_SIZE - 1, BOARD_SIZE - 1, 2);
+        s->PutBomb(1, 1, 0, 1, 10, true);
+        s->Kill(3);
+        // 0  b           1
+
+        // important: get initial stats from state as we artificially placed the bomb
+        State initialState = *s;
+        initialState.agents[0].canKick = false;
+        initialState.agents[1].canKick = false;
+        s->Step(m);
+        Observation::Get(*s, 2, params, obs);
+        obs.TrackStats(initialState);
+        REQUIRE(bboard::BMB_ID(obs.bombs[0]) == 0);
+        oldObs = obs;
+
+        // agent 0 kicks the bomb to the right until it stops in front of
+        // agent 1, then agent 1 kicks it back
+        const Move kicks[][2] = {
+            {Move::RIGHT, Move::IDLE},
+            {Move::IDLE, Move::IDLE},
+            {Move::IDLE, Move::IDLE},
+            {Move::IDLE, Move::IDLE},
+            {Move::IDLE, Move::LEFT},
+            {Move::IDLE, Move::IDLE}
+        };
+        const int bombX[] = {2, 3, 4, 4, 3, 2};
+
+        for(int k = 0; k < 6; k++)
+        {
+            INFO("step " << k);
+            m[0] = kicks[k][0];
+            m[1] = kicks[k][1];
+            s->Step(m);
+            REQUIRE(bboard::BMB_POS_X(s->bombs[0]) == bombX[k]);
+
+            Observation::Get(*s, 2, params, obs);
+            ClearBombOwnership(obs);
+
+            int errors = 0;
+            obs.TrackStats(oldObs, &errors);
+            REQUIRE(errors == 0);
+            REQUIRE(bboard::BMB_ID(obs.bombs[0]) == 0);
+            REQUIRE(obs.agents[0].bombCount == 1);
+            REQUIRE(obs.agents[1].bombCount == 0);
+
+            // the kicks reveal that both agents can kick
+            REQUIRE(obs.agents[0].canKick == true);
+            REQUIRE(obs.agents[1].canKick == (k >= 4));
+            oldObs = obs;
+        }
+    }
+    SECTION("Bomb tracking - backtracking errors")
+    {
+        params.agentPartialMapView = true;
+        params.agentViewSize = 2;
+        // empty optimized flame queue (like after State::Init)
+        s->currentFlameTime = 0;
+
+        s->agents[0].canKick = true;
+        s->PutAgent(3, 1, 0);
+        s->PutAgent(8, 1, 1);
+        s->PutBomb(4, 1, 0, 1, 10, true);
+        s->Kill(2, 3);
+        // 0  b        | 1
+        // agent 1 only sees the cells right of the |
+
+        // important: get initial stats from state as we artificially placed the bomb
+        State initialState = *s;
+        s->Step(m);
+        Observation::Get(*s, 1, params, obs);
+        obs.TrackStats(initialState);
+        REQUIRE(obs.bombs.count == 0);
+        oldObs = obs;
+
+        // the kick happens in the fog
+        m[0] = bboard::Move::RIGHT;
+        s->Step(m);
+        Observation::Get(*s, 1, params, obs);
+        int errors = 0;
+        obs.TrackStats(oldObs, &errors);
+        REQUIRE(obs.bombs.count == 0);
+        REQUIRE(errors == 0);
+        oldObs = obs;
+
+        // the bomb enters the view, its owner cannot be found
+        m[0] = bboard::Move::IDLE;
+        s->Step(m);
+        Observation::Get(*s, 1, params, obs);
+        ClearBombOwnership(obs);
+        REQUIRE(obs.bombs.count == 1);
+        REQUIRE(bboard::BMB_POS_X(obs.bombs[0]) == 6);
+
+        obs.TrackStats(oldObs, &errors);
+        REQUIRE(errors == 1);
+        REQUIRE(bboard::BMB_ID(obs.bombs[0]) == bboard::AGENT_COUNT);
+    }
+}
+
+/**
+ * @brief _objectIndicesEqual Checks whether the bomb and flame indices
+ * of both boards are equal.
+ */
+bool _objectIndicesEqual(const Board& a, const Board& b)
+{
+    for(int y = 0; y < BOARD_SIZE; y++)
+    {
+        for(int x = 0; x < BOARD_SIZE; x++)
+        {
+            if(a.GetBombIndex(x, y) != b.GetBombIndex(x, y) || a.GetFlameIndex(x, y) != b.GetFlameIndex(x, y))
+                return false;
+        }
+    }
+
+    for(int i = 0; i < a.flames.count; i++)
+    {
+        if(a.GetFlameLifetime(i) != b.GetFlameLifetime(i))
+            return false;
+    }
+    return true;
+}
+
+TEST_CASE("Incremental Observation Update", "[observation]")
+{
+    std::vector<ObservationParameters> paramList(5);
+    paramList[1].exposePowerUps = false;
+    paramList[2].agentPartialMapView = true;
+    paramList[2].agentInfoVisibility = AgentInfoVisibility::InView;
+    paramList[3].agentPartialMapView = true;
+    paramList[3].agentViewSize = 2;
+    paramList[3].exposePowerUps = false;
+    paramList[3].agentInfoVisibility = AgentInfoVisibility::OnlySelf;
+    paramList[4].agentInfoVisibility = AgentInfoVisibility::OnlySelf;
+
+    std::mt19937 rng(17);
+    auto s = std::make_unique<State>();
+    auto expected = std::make_unique<std::array<Observation, AGENT_COUNT>>();
+    auto updated = std::make_unique<std::array<Observation, AGENT_COUNT>>();
+
+    for(const ObservationParameters& params : paramList)
+    {
+        int patched = 0;
+        bool match = true;
+        for(int game = 0; game < 8 && match; game++)
+        {
+            *s = State();
+            s->Init(GameMode::FreeForAll, rng(), rng());
+            for(int i = 0; i < AGENT_COUNT; i++)
+            {
+                Observation::Get(*s, i, params, (*updated)[i]);
+            }
+
+            Move moves[AGENT_COUNT];
+            for(int step = 0; step < 400 && !s->finished && match; step++)
+            {
+                FillRandomMoves(rng, moves);
+                s->Step(moves);
+
+                // skipped updates have to fall back to Get
+                if(step % 37 == 5)
+                    continue;
+
+                for(int i = 0; i < AGENT_COUNT; i++)
+                {
+                    Observation& obs = (*updated)[i];
+                    patched += s->dirtyBaseHash == obs.sourceHash;
+                    obs.Update(*s);
+
+                    Observation::Get(*s, i, params, (*expected)[i]);
+                    match = match && BoardsEqual(obs, (*expected)[i]) && _objectIndicesEqual(obs, (*expected)[i])
+                            && obs.sourceHash == s->hash;
+                }
+            }
+        }
+        REQUIRE(match);
+        REQUIRE(patched > 0);
+    }
+
+    // observations have to be created with Get first
+    Observation obs;
+    REQUIRE_THROWS_AS(obs.Update(*s), std::runtime_error);
+}
+
+TEST_CASE("Observations of All Agents", "[observation]")
+{
+    std::vector<ObservationParameters> paramList(5);
+    paramList[1].exposePowerUps = false;
+    paramList[2].agentPartialMapView = true;
+    paramList[2].agentInfoVisibility = AgentInfoVisibility::InView;
+    paramList[3].agentPartialMapView = true;
+    paramList[3].agentViewSize = 2;
+    paramList[3].exposePowerUps = false;
+    paramList[3].agentInfoVisibility = AgentInfoVisibility::OnlySelf;
+    paramList[4].agentInfoVisibility = AgentInfoVisibility::OnlySelf;
+
+    std::mt19937 rng(19);
+    auto s = std::make_unique<State>();
+    auto expected = std::make_unique<std::array<Observation, AGENT_COUNT>>();
+    auto all = std::make_unique<std::array<Observation, AGENT_COUNT>>();
+
+    for(const ObservationParameters& params : paramList)
+    {
+        bool match = true;
+        for(int game = 0; game < 6 && match; game++)
+        {
+            *s = State();
+            s->Init(game % 2 == 0 ? GameMode::FreeForAll : GameMode::TwoTeams, rng(), rng());
+
+            Move moves[AGENT_COUNT];
+            for(int step = 0; step < 400 && !s->finished && match; step++)
+            {
+                FillRandomMoves(rng, moves);
+                s->Step(moves);
+
+                Observation::GetAll(*s, params, all->data());
+                for(int i = 0; i < AGENT_COUNT; i++)
+                {
+                    const Observation& obs = (*all)[i];
+                    Observation::Get(*s, i, params, (*expected)[i]);
+                    match = match && BoardsEqual(obs, (*expected)[i]) && _objectIndicesEqual(obs, (*expected)[i])
+                            && obs.agentID == i && obs.sourceHash == s->hash;
+                }
+            }
+        }
+        REQUIRE(match);
+    }
 }
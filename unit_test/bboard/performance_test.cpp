@@ -10,6 +10,17 @@
 #include "test_args.hpp"
 
 #include "bboard.hpp"
+#include "batch_state.hpp"
+#include "bitboard.hpp"
+#include "compact_state.hpp"
+#include "child_generation.hpp"
+#include "step_utility.hpp"
+#include "rollout_engine.hpp"
+#include "board_generator.hpp"
+#include "belief_state.hpp"
+#include "profile.hpp"
+#include "tensor_encoder.hpp"
+#include "strategy.hpp"
 #include "agents.hpp"
 #include "colors.hpp"
 
@@ -49,6 +60,7 @@ void ProxyConcurrent(std::promise<int> && steps, int times)
 
 TEST_CASE("Step Function", "[performance]")
 {
+    bboard::profile::Reset();
     TESTING_AGENT b;
     int times = 1000;
     double t = -1;
@@ -106,6 +118,11 @@ TEST_CASE("Step Function", "[performance]")
               << type_name<decltype(b)>()
               << "\nTime: " << t/100.0 << "\n";
 
+    if(bboard::profile::Enabled())
+    {
+        bboard::profile::Report();
+    }
+
     REQUIRE(1);
 }
 
@@ -158,3 +175,855 @@ TEST_CASE("Episode Steps", "[performance]")
 
     REQUIRE(1);
 }
+
+TEST_CASE("Batch Step Function", "[performance]")
+{
+    const int N = 16;
+    const int numSteps = 100;
+    const int numRuns = 80;
+
+    std::mt19937 rng(42);
+
+    // pre-sample the moves so that both variants execute exactly the same steps,
+    // bombs are rare so that most games are still running after numSteps steps
+    auto moves = std::make_unique<bboard::Move[][N][bboard::AGENT_COUNT]>(numSteps);
+    for(int t = 0; t < numSteps; t++)
+    {
+        for(int g = 0; g < N; g++)
+        {
+            for(int i = 0; i < bboard::AGENT_COUNT; i++)
+            {
+                moves[t][g][i] = rng() % 16 == 0 ? bboard::Move::BOMB : bboard::Move(rng() % 5);
+            }
+        }
+    }
+
+    auto initial = std::make_unique<bboard::BatchState<N>>();
+    initial->Init(bboard::GameMode::FreeForAll, 42, -1);
+
+    auto initialStates = std::make_unique<bboard::State[]>(N);
+    for(int g = 0; g < N; g++)
+    {
+        initial->ToState(g, initialStates[g]);
+    }
+
+    auto scalar = std::make_unique<bboard::State[]>(N);
+    auto batch = std::make_unique<bboard::BatchState<N>>();
+
+    std::chrono::duration<double, std::milli> scalarTime(0), batchTime(0);
+    long gameSteps = 0;
+
+    for(int run = 0; run < numRuns; run++)
+    {
+        // scalar path
+        std::copy_n(initialStates.get(), N, scalar.get());
+        auto t1 = std::chrono::high_resolution_clock::now();
+        for(int t = 0; t < numSteps; t++)
+        {
+            for(int g = 0; g < N; g++)
+            {
+                scalar[g].Step(moves[t][g]);
+            }
+        }
+        scalarTime += std::chrono::high_resolution_clock::now() - t1;
+
+        // batched path
+        *batch = *initial;
+        t1 = std::chrono::high_resolution_clock::now();
+        for(int t = 0; t < numSteps; t++)
+        {
+            batch->StepBatch(moves[t]);
+        }
+        batchTime += std::chrono::high_resolution_clock::now() - t1;
+
+        for(int g = 0; g < N; g++)
+        {
+            gameSteps += batch->timeStep[g];
+        }
+    }
+
+    std::string tst = "Batch step performance results:\n";
+    std::cout << std::endl
+              << FGRN(tst)
+              << "Games per batch:                 " << N << std::endl
+              << "Steps/s (State::Step):           ";
+    RecursiveCommas(std::cout, (long)(gameSteps / (scalarTime.count() / 1000.0)));
+    std::cout << std::endl
+              << "Steps/s (BatchState::StepBatch): ";
+    RecursiveCommas(std::cout, (long)(gameSteps / (batchTime.count() / 1000.0)));
+    std::cout << std::endl;
+
+    REQUIRE(1);
+}
+
+template<typename S>
+double TimeSteps(const S& initial, std::vector<std::array<bboard::Move, bboard::AGENT_COUNT>>& moves, bool copy)
+{
+    S s = initial;
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for(auto& m : moves)
+    {
+        if(copy)
+        {
+            // tree search: step a copy of the parent
+            S child = s;
+            child.Step(m.data());
+            s = child.finished ? initial : child;
+        }
+        else
+        {
+            // random agents die quickly, restart finished games
+            if(s.finished) s = initial;
+            s.Step(m.data());
+        }
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - t1;
+    return elapsed.count();
+}
+
+TEST_CASE("BitBoard Step Function", "[performance]")
+{
+    const int numGames = 100;
+    const int numSteps = 1000;
+
+    std::mt19937 rng(42);
+
+    double stateTime[2] = {0, 0}, bitboardTime[2] = {0, 0};
+
+    for(int game = 0; game < numGames; game++)
+    {
+        bboard::State initial;
+        initial.Init(bboard::GameMode::FreeForAll, rng(), -1);
+        bboard::BitBoard initialBitBoard;
+        initialBitBoard.FromState(initial);
+
+        // pre-sample the moves so that both variants execute exactly the same steps
+        std::vector<std::array<bboard::Move, bboard::AGENT_COUNT>> moves(numSteps);
+        for(auto& m : moves)
+        {
+            FillRandomMoves(rng, m.data());
+        }
+
+        for(int copy = 0; copy < 2; copy++)
+        {
+            stateTime[copy] += TimeSteps(initial, moves, copy);
+            bitboardTime[copy] += TimeSteps(initialBitBoard, moves, copy);
+        }
+    }
+
+    const long steps = long(numGames) * numSteps;
+
+    std::string tst = "BitBoard step performance results:\n";
+    std::cout << std::endl
+              << FGRN(tst)
+              << "Size (State / BitBoard):         " << sizeof(bboard::State) << " / " << sizeof(bboard::BitBoard) << " bytes" << std::endl;
+    for(int copy = 0; copy < 2; copy++)
+    {
+        std::cout << (copy ? "Copy + Step/s (State / BitBoard): " : "Step/s (State / BitBoard):        ");
+        RecursiveCommas(std::cout, (long)(steps / (stateTime[copy] / 1000.0)));
+        std::cout << " / ";
+        RecursiveCommas(std::cout, (long)(steps / (bitboardTime[copy] / 1000.0)));
+        std::cout << std::endl;
+    }
+
+    REQUIRE(1);
+}
+
+TEST_CASE("Compact State Step Function", "[performance]")
+{
+    const int numGames = 100;
+    const int numSteps = 1000;
+
+    std::mt19937 rng(42);
+
+    double stateTime[2] = {0, 0}, compactTime[2] = {0, 0};
+
+    for(int game = 0; game < numGames; game++)
+    {
+        bboard::State initial;
+        initial.Init(bboard::GameMode::FreeForAll, rng(), -1);
+        bboard::CompactState initialCompact;
+        initialCompact.FromState(initial);
+
+        // pre-sample the moves so that both variants execute exactly the same steps
+        std::vector<std::array<bboard::Move, bboard::AGENT_COUNT>> moves(numSteps);
+        for(auto& m : moves)
+        {
+            FillRandomMoves(rng, m.data());
+        }
+
+        for(int copy = 0; copy < 2; copy++)
+        {
+            stateTime[copy] += TimeSteps(initial, moves, copy);
+            compactTime[copy] += TimeSteps(initialCompact, moves, copy);
+        }
+    }
+
+    const long steps = long(numGames) * numSteps;
+
+    std::string tst = "Compact state step performance results:\n";
+    std::cout << std::endl
+              << FGRN(tst)
+              << "Size (State / CompactState):         " << sizeof(bboard::State) << " / " << sizeof(bboard::CompactState) << " bytes" << std::endl;
+    for(int copy = 0; copy < 2; copy++)
+    {
+        std::cout << (copy ? "Copy + Step/s (State / CompactState): " : "Step/s (State / CompactState):        ");
+        RecursiveCommas(std::cout, (long)(steps / (stateTime[copy] / 1000.0)));
+        std::cout << " / ";
+        RecursiveCommas(std::cout, (long)(steps / (compactTime[copy] / 1000.0)));
+        std::cout << std::endl;
+    }
+
+    REQUIRE(1);
+}
+
+double TimeExpansions(const bboard::State& initial, std::vector<std::array<bboard::Move, bboard::AGENT_COUNT>>& moves, bool undo, uint64_t& hashSum)
+{
+    bboard::State s = initial;
+    bboard::StepJournal journal;
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for(auto& m : moves)
+    {
+        // expand a child of the current state and discard it
+        if(undo)
+        {
+            s.StepRecorded(m.data(), journal);
+            hashSum += s.hash;
+            s.Undo(journal);
+        }
+        else
+        {
+            bboard::State child = s;
+            child.Step(m.data());
+            hashSum += child.hash;
+        }
+
+        // then advance the game
+        if(s.finished) s = initial;
+        s.Step(m.data());
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - t1;
+    return elapsed.count();
+}
+
+TEST_CASE("Step Undo Function", "[performance]")
+{
+    const int numGames = 100;
+    const int numSteps = 1000;
+
+    std::mt19937 rng(42);
+
+    double time[2] = {0, 0};
+    uint64_t hashSum[2] = {0, 0};
+
+    for(int game = 0; game < numGames; game++)
+    {
+        bboard::State initial;
+        initial.Init(bboard::GameMode::FreeForAll, rng(), -1);
+
+        std::vector<std::array<bboard::Move, bboard::AGENT_COUNT>> moves(numSteps);
+        for(auto& m : moves)
+        {
+            FillRandomMoves(rng, m.data());
+        }
+
+        for(int undo = 0; undo < 2; undo++)
+        {
+            time[undo] += TimeExpansions(initial, moves, undo, hashSum[undo]);
+        }
+    }
+
+    const long steps = long(numGames) * numSteps;
+
+    std::string tst = "Step undo performance results:\n";
+    std::cout << std::endl
+              << FGRN(tst)
+              << "Size (State / StepJournal):               " << sizeof(bboard::State) << " / " << sizeof(bboard::StepJournal) << " bytes" << std::endl
+              << "Expansions/s (Copy + Step / Step + Undo): ";
+    RecursiveCommas(std::cout, (long)(steps / (time[0] / 1000.0)));
+    std::cout << " / ";
+    RecursiveCommas(std::cout, (long)(steps / (time[1] / 1000.0)));
+    std::cout << std::endl;
+
+    // both variants visit exactly the same states
+    REQUIRE(hashSum[0] == hashSum[1]);
+}
+
+template<typename Rules>
+double TimeRuleSteps(const bboard::State& initial, std::vector<std::array<bboard::Move, bboard::AGENT_COUNT>>& moves, uint64_t& hashSum)
+{
+    bboard::State s = initial;
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for(auto& m : moves)
+    {
+        if(s.finished) s = initial;
+        s.StepT<Rules>(m.data());
+        hashSum += s.hash;
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - t1;
+    return elapsed.count();
+}
+
+TEST_CASE("Step Rules Function", "[performance]")
+{
+    const int numGames = 100;
+    const int numSteps = 1000;
+
+    std::mt19937 rng(42);
+
+    double time[2] = {0, 0};
+    uint64_t hashSum[2] = {0, 0};
+
+    for(int game = 0; game < numGames; game++)
+    {
+        bboard::State initial;
+        initial.Init(bboard::GameMode::FreeForAll, rng(), -1);
+        RemoveKickPowerUps(initial);
+
+        std::vector<std::array<bboard::Move, bboard::AGENT_COUNT>> moves(numSteps);
+        for(auto& m : moves)
+        {
+            FillRandomMoves(rng, m.data());
+        }
+
+        time[0] += TimeRuleSteps<bboard::DefaultRules>(initial, moves, hashSum[0]);
+        time[1] += TimeRuleSteps<bboard::NoKickFreeForAllRules>(initial, moves, hashSum[1]);
+    }
+
+    const long steps = long(numGames) * numSteps;
+
+    std::string tst = "Step rules performance results (no kick powerups, free for all):\n";
+    std::cout << std::endl
+              << FGRN(tst)
+              << "Step/s (DefaultRules / NoKickFreeForAllRules): ";
+    RecursiveCommas(std::cout, (long)(steps / (time[0] / 1000.0)));
+    std::cout << " / ";
+    RecursiveCommas(std::cout, (long)(steps / (time[1] / 1000.0)));
+    std::cout << std::endl;
+
+    // both rule sets play exactly the same games
+    REQUIRE(hashSum[0] == hashSum[1]);
+}
+
+TEST_CASE("Rollout Engine", "[performance]")
+{
+    const int rollouts = 256;
+
+    bboard::State root;
+    root.Init(bboard::GameMode::FreeForAll, 42, -1);
+    bboard::AgentFactory policy = [](int, long seed)
+    {
+        return std::make_unique<TESTING_AGENT>(seed);
+    };
+
+    const int maxThreads = THREADING ? THREAD_COUNT : std::max(1u, std::thread::hardware_concurrency());
+    std::string tst = "Rollout engine performance results:\n";
+    std::cout << std::endl << FGRN(tst);
+
+    long steps = -1;
+    for(int threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        bboard::RolloutEngine engine(threads);
+        auto t1 = std::chrono::high_resolution_clock::now();
+        bboard::RolloutResult result = engine.Run(root, policy, rollouts, 1234);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - t1;
+
+        std::cout << "Steps/s (" << threads << " threads): ";
+        RecursiveCommas(std::cout, (long)(result.steps / (elapsed.count() / 1000.0)));
+        std::cout << std::endl;
+
+        // the result does not depend on the number of threads
+        if(steps == -1) steps = result.steps;
+        REQUIRE(result.steps == steps);
+    }
+}
+
+TEST_CASE("Generate Children Function", "[performance]")
+{
+    const int numStates = 200;
+    std::mt19937 rng(42);
+
+    // collect states of random games
+    std::vector<bboard::State> states;
+    states.reserve(numStates);
+    while((int)states.size() < numStates)
+    {
+        bboard::State s;
+        s.Init(bboard::GameMode::FreeForAll, rng(), rng());
+        bboard::Move moves[bboard::AGENT_COUNT];
+        for(int step = 0; step < 100 && !s.finished; step++)
+        {
+            FillRandomMoves(rng, moves);
+            s.Step(moves);
+            if(step % 20 == 0 && !s.finished) states.push_back(s);
+        }
+    }
+    states.resize(numStates);
+
+    const bboard::MoveMask masks[bboard::AGENT_COUNT] = {bboard::ALL_MOVES, bboard::ALL_MOVES, bboard::ALL_MOVES, bboard::ALL_MOVES};
+    uint64_t hashSum[2] = {0, 0};
+    long children = 0;
+
+    // expand every joint action with State::Step
+    auto t1 = std::chrono::high_resolution_clock::now();
+    auto child = std::make_unique<bboard::State>();
+    for(const bboard::State& s : states)
+    {
+        for(int a = 0; a < 1296; a++)
+        {
+            bboard::Move moves[bboard::AGENT_COUNT];
+            for(int i = 0, c = a; i < bboard::AGENT_COUNT; i++, c /= 6)
+                moves[i] = bboard::Move(c % 6);
+
+            *child = s;
+            child->Step(moves);
+            hashSum[0] ^= child->hash;
+        }
+    }
+    std::chrono::duration<double, std::milli> stepTime = std::chrono::high_resolution_clock::now() - t1;
+
+    // expand all children with GenerateChildren
+    t1 = std::chrono::high_resolution_clock::now();
+    for(const bboard::State& s : states)
+    {
+        bboard::GenerateChildren(s, masks, [&](const bboard::Move*, const bboard::MoveMask* equivalent, const bboard::State& c)
+        {
+            // the child is reached by every combination of the equivalent moves
+            int combinations = 1;
+            for(int i = 0; i < bboard::AGENT_COUNT; i++)
+                combinations *= bboard::PopCount(equivalent[i]);
+
+            if(combinations % 2 == 1) hashSum[1] ^= c.hash;
+            children++;
+        });
+    }
+    std::chrono::duration<double, std::milli> generateTime = std::chrono::high_resolution_clock::now() - t1;
+
+    // the effective moves of all agents span the same children
+    long effectiveJointActions = 0;
+    for(const bboard::State& s : states)
+    {
+        bboard::MoveMask effective[bboard::AGENT_COUNT];
+        bboard::util::ComputeMoveMasks(s, effective);
+
+        long jointActions = 1;
+        for(int i = 0; i < bboard::AGENT_COUNT; i++)
+            jointActions *= bboard::PopCount(effective[i]);
+        effectiveJointActions += jointActions;
+    }
+
+    std::string tst = "Child generation performance results (all joint actions):\n";
+    std::cout << std::endl
+              << FGRN(tst)
+              << "Expansions/s (Step / GenerateChildren): ";
+    RecursiveCommas(std::cout, (long)(numStates / (stepTime.count() / 1000.0)));
+    std::cout << " / ";
+    RecursiveCommas(std::cout, (long)(numStates / (generateTime.count() / 1000.0)));
+    std::cout << std::endl
+              << "Children per state (Step / GenerateChildren): 1296 / " << children / numStates << std::endl
+              << "Effective joint actions per state (ComputeMoveMasks): " << effectiveJointActions / numStates << std::endl;
+
+    // both variants visit the same children
+    REQUIRE(hashSum[0] == hashSum[1]);
+    REQUIRE(effectiveJointActions == children);
+}
+
+TEST_CASE("Board Cache Init Function", "[performance]")
+{
+    const int numBoards = 20000;
+
+    bboard::BoardGenerator generator;
+    auto t0 = std::chrono::high_resolution_clock::now();
+    bboard::BoardCache cache = generator.Generate(0, numBoards);
+    std::chrono::duration<double, std::milli> generation = std::chrono::high_resolution_clock::now() - t0;
+
+    auto s = std::make_unique<bboard::State>();
+    double time[2] = {0, 0};
+    uint64_t hashSum[2] = {0, 0};
+    bboard::BoardKey key;
+    for(int cached = 0; cached < 2; cached++)
+    {
+        auto t1 = std::chrono::high_resolution_clock::now();
+        for(int seed = 0; seed < numBoards; seed++)
+        {
+            if(cached)
+            {
+                key.boardSeed = seed;
+                cache.Init(*s, bboard::GameMode::FreeForAll, key, seed);
+            }
+            else
+            {
+                s->Init(bboard::GameMode::FreeForAll, seed, seed);
+            }
+            hashSum[cached] += s->hash;
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - t1;
+        time[cached] = elapsed.count();
+    }
+
+    std::string tst = "Board cache performance results:\n";
+    std::cout << std::endl
+              << FGRN(tst)
+              << "Generated boards/s (" << generator.GetThreadCount() << " threads):     ";
+    RecursiveCommas(std::cout, (long)(numBoards / (generation.count() / 1000.0)));
+    std::cout << std::endl
+              << "Inits/s (Init / Cache Init):        ";
+    RecursiveCommas(std::cout, (long)(numBoards / (time[0] / 1000.0)));
+    std::cout << " / ";
+    RecursiveCommas(std::cout, (long)(numBoards / (time[1] / 1000.0)));
+    std::cout << std::endl;
+
+    REQUIRE(hashSum[0] == hashSum[1]);
+}
+
+TEST_CASE("Observation Update Function", "[performance]")
+{
+    const int numGames = 200;
+
+    bboard::ObservationParameters params[2];
+    params[1].agentPartialMapView = true;
+    params[1].exposePowerUps = false;
+
+    auto s = std::make_unique<bboard::State>();
+    // separate observations for Get, Update and GetAll
+    std::vector<bboard::Observation> obs(2 * 3 * bboard::AGENT_COUNT);
+    std::mt19937 rng(1);
+    bboard::Move moves[bboard::AGENT_COUNT];
+
+    double time[2][3] = {{0, 0, 0}, {0, 0, 0}};
+    long observations = 0;
+    for(int game = 0; game < numGames; game++)
+    {
+        *s = bboard::State();
+        s->Init(bboard::GameMode::FreeForAll, game, game);
+        for(int j = 0; j < (int)obs.size(); j++)
+        {
+            bboard::Observation::Get(*s, j % bboard::AGENT_COUNT, params[j / (3 * bboard::AGENT_COUNT)], obs[j]);
+        }
+
+        while(!s->finished && s->timeStep < 800)
+        {
+            FillRandomMoves(rng, moves);
+            s->Step(moves);
+            observations += bboard::AGENT_COUNT;
+
+            for(int p = 0; p < 2; p++)
+            {
+                // rotate the order, the first call reads the state from memory
+                for(int k = 0; k < 3; k++)
+                {
+                    const int mode = (k + s->timeStep) % 3;
+                    bboard::Observation* o = &obs[(3 * p + mode) * bboard::AGENT_COUNT];
+                    auto t = std::chrono::high_resolution_clock::now();
+                    if(mode == 2)
+                    {
+                        bboard::Observation::GetAll(*s, params[p], o);
+                    }
+                    else
+                    {
+                        for(int i = 0; i < bboard::AGENT_COUNT; i++)
+                        {
+                            if(mode == 1)
+                                o[i].Update(*s);
+                            else
+                                bboard::Observation::Get(*s, i, params[p], o[i]);
+                        }
+                    }
+                    std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - t;
+                    time[p][mode] += elapsed.count();
+                }
+            }
+        }
+    }
+
+    std::string tst = "Observation update performance results:\n";
+    std::cout << std::endl << FGRN(tst);
+    const char* names[2] = {"Full view   ", "Partial view"};
+    for(int p = 0; p < 2; p++)
+    {
+        std::cout << names[p] << " observations/s (Get / Update / GetAll): ";
+        for(int mode = 0; mode < 3; mode++)
+        {
+            if(mode > 0)
+                std::cout << " / ";
+            RecursiveCommas(std::cout, (long)(observations / (time[p][mode] / 1000.0)));
+        }
+        std::cout << std::endl;
+    }
+}
+
+TEST_CASE("Observation VirtualStep Function", "[performance]")
+{
+    const int numGames = 100;
+
+    // the observations of TeamRadio games
+    bboard::ObservationParameters params;
+    params.agentPartialMapView = true;
+    params.agentViewSize = 4;
+    params.exposePowerUps = false;
+    params.agentInfoVisibility = bboard::AgentInfoVisibility::InView;
+
+    auto s = std::make_unique<bboard::State>();
+    auto belief = std::make_unique<bboard::State>();
+    auto itemAge = std::make_unique<int[][bboard::BOARD_SIZE]>(bboard::BOARD_SIZE);
+    std::vector<bboard::Observation> trace;
+    std::mt19937 rng(1);
+    bboard::Move moves[bboard::AGENT_COUNT];
+
+    double time = 0;
+    long steps = 0;
+    for(int game = 0; game < numGames; game++)
+    {
+        // record the observations of all agents
+        trace.clear();
+        *s = bboard::State();
+        s->Init(bboard::GameMode::TeamRadio, game, game);
+        trace.resize(bboard::AGENT_COUNT);
+        bboard::Observation::GetAll(*s, params, &trace[0]);
+        while(!s->finished && s->timeStep < 800)
+        {
+            FillRandomMoves(rng, moves);
+            s->Step(moves);
+            trace.resize(trace.size() + bboard::AGENT_COUNT);
+            bboard::Observation::GetAll(*s, params, &trace[trace.size() - bboard::AGENT_COUNT]);
+        }
+
+        // and merge them into the belief states of the agents
+        for(int i = 0; i < bboard::AGENT_COUNT; i++)
+        {
+            trace[i].ToState(*belief);
+            std::fill_n(&itemAge[0][0], bboard::BOARD_SIZE * bboard::BOARD_SIZE, 0);
+
+            auto t = std::chrono::high_resolution_clock::now();
+            for(size_t j = bboard::AGENT_COUNT + i; j < trace.size(); j += bboard::AGENT_COUNT)
+            {
+                trace[j].VirtualStep(*belief, true, true, (int(*)[bboard::BOARD_SIZE][bboard::BOARD_SIZE])itemAge.get());
+                steps++;
+            }
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - t;
+            time += elapsed.count();
+        }
+    }
+
+    std::string tst = "Observation VirtualStep performance results:\n";
+    std::cout << std::endl << FGRN(tst);
+    std::cout << "Virtual steps/s: ";
+    RecursiveCommas(std::cout, (long)(steps / (time / 1000.0)));
+    std::cout << std::endl;
+}
+
+TEST_CASE("Belief State Function", "[performance]")
+{
+    const int numGames = 20;
+    const int samplesPerStep = 100;
+
+    bboard::ObservationParameters params;
+    params.agentPartialMapView = true;
+    params.agentViewSize = 4;
+    params.exposePowerUps = false;
+    params.agentInfoVisibility = bboard::AgentInfoVisibility::InView;
+
+    auto s = std::make_unique<bboard::State>();
+    auto obs = std::make_unique<bboard::Observation>();
+    bboard::BeliefState belief(64);
+    std::mt19937 rng(1);
+    bboard::Move moves[bboard::AGENT_COUNT];
+
+    double updateTime = 0, sampleTime = 0;
+    long updates = 0, samples = 0, steps = 0;
+    for(int game = 0; game < numGames; game++)
+    {
+        *s = bboard::State();
+        s->Init(bboard::GameMode::TeamRadio, game, game);
+        bboard::Observation::Get(*s, 0, params, *obs);
+        belief.Reset(*obs);
+
+        while(!s->finished && !s->agents[0].dead && s->timeStep < 800)
+        {
+            FillRandomMoves(rng, moves);
+            s->Step(moves);
+            bboard::Observation::Get(*s, 0, params, *obs);
+
+            auto t = std::chrono::high_resolution_clock::now();
+            belief.Update(*obs);
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - t;
+            updateTime += elapsed.count();
+            updates++;
+
+            t = std::chrono::high_resolution_clock::now();
+            for(int i = 0; i < samplesPerStep; i++)
+            {
+                // simulate a step on every sample
+                bboard::State& sample = belief.Sample();
+                sample.Step(moves);
+                steps += sample.timeStep;
+            }
+            elapsed = std::chrono::high_resolution_clock::now() - t;
+            sampleTime += elapsed.count();
+            samples += samplesPerStep;
+        }
+    }
+
+    std::string tst = "Belief state performance results (64 particles):\n";
+    std::cout << std::endl << FGRN(tst);
+    std::cout << "Updates/s: ";
+    RecursiveCommas(std::cout, (long)(updates / (updateTime / 1000.0)));
+    std::cout << std::endl << "Samples/s (including one step): ";
+    RecursiveCommas(std::cout, (long)(samples / (sampleTime / 1000.0)));
+    std::cout << std::endl;
+    REQUIRE(steps > 0);
+}
+
+TEST_CASE("Tensor Encoder Function", "[performance]")
+{
+    const int numGames = 50;
+
+    auto s = std::make_unique<bboard::State>();
+    std::vector<bboard::Observation> observations;
+    std::mt19937 rng(3);
+    bboard::Move moves[bboard::AGENT_COUNT];
+    for(int game = 0; game < numGames; game++)
+    {
+        *s = bboard::State();
+        s->Init(bboard::GameMode::FreeForAll, game, game);
+        while(!s->finished && s->timeStep < 800)
+        {
+            FillRandomMoves(rng, moves);
+            s->Step(moves);
+            observations.emplace_back();
+            bboard::Observation::Get(*s, s->timeStep % bboard::AGENT_COUNT, bboard::ObservationParameters(), observations.back());
+        }
+    }
+
+    const bboard::TensorEncoder encoder;
+    std::vector<float> tensors((size_t)encoder.Size() * observations.size());
+    std::vector<uint8_t> tensorsU8(tensors.size());
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    encoder.EncodeBatch(observations.data(), (int)observations.size(), tensors.data());
+    auto t1 = std::chrono::high_resolution_clock::now();
+    encoder.EncodeBatch(observations.data(), (int)observations.size(), tensorsU8.data());
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    std::chrono::duration<double, std::milli> timeFloat = t1 - t0, timeU8 = t2 - t1;
+
+    std::string tst = "Tensor encoder performance results:\n";
+    std::cout << std::endl
+              << FGRN(tst)
+              << "Encoded observations/s (float / uint8): ";
+    RecursiveCommas(std::cout, (long)(observations.size() / (timeFloat.count() / 1000.0)));
+    std::cout << " / ";
+    RecursiveCommas(std::cout, (long)(observations.size() / (timeU8.count() / 1000.0)));
+    std::cout << std::endl;
+
+    REQUIRE(std::equal(tensors.begin(), tensors.end(), tensorsU8.begin()));
+}
+
+TEST_CASE("MultiRMap Function", "[performance]")
+{
+    const int numGames = 50;
+    const int repetitions = 20;
+
+    auto s = std::make_unique<bboard::State>();
+    std::vector<bboard::State> states;
+    std::mt19937 rng(7);
+    bboard::Move moves[bboard::AGENT_COUNT];
+    for(int game = 0; game < numGames; game++)
+    {
+        *s = bboard::State();
+        s->Init(bboard::GameMode::FreeForAll, game, game);
+        while(!s->finished && s->timeStep < 800)
+        {
+            FillRandomMoves(rng, moves);
+            s->Step(moves);
+            if(s->timeStep % 4 == 0)
+            {
+                states.push_back(*s);
+            }
+        }
+    }
+
+    bboard::strategy::RMap r;
+    auto maps = std::make_unique<bboard::strategy::MultiRMap>();
+    long sumRMap = 0, sumMulti = 0;
+
+    // the maps of all alive agents, one RMap per agent vs. a single MultiRMap
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for(int k = 0; k < repetitions; k++)
+    {
+        for(const bboard::State& state : states)
+        {
+            for(int i = 0; i < bboard::AGENT_COUNT; i++)
+            {
+                if(state.agents[i].dead)
+                    continue;
+
+                bboard::strategy::FillRMap(state, r, i);
+                sumRMap += r.GetDistance(i, bboard::BOARD_SIZE - 1 - i);
+            }
+        }
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for(int k = 0; k < repetitions; k++)
+    {
+        for(const bboard::State& state : states)
+        {
+            bboard::strategy::FillMultiRMap(state, *maps);
+            for(int i = 0; i < bboard::AGENT_COUNT; i++)
+            {
+                sumMulti += maps->GetDistance(i, i, bboard::BOARD_SIZE - 1 - i);
+            }
+        }
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    std::chrono::duration<double, std::milli> timeRMap = t1 - t0, timeMulti = t2 - t1;
+    const long count = (long)states.size() * repetitions;
+
+    std::string tst = "Reachable map performance results:\n";
+    std::cout << std::endl
+              << FGRN(tst)
+              << "States/s (RMap per agent / MultiRMap): ";
+    RecursiveCommas(std::cout, (long)(count / (timeRMap.count() / 1000.0)));
+    std::cout << " / ";
+    RecursiveCommas(std::cout, (long)(count / (timeMulti.count() / 1000.0)));
+    std::cout << std::endl;
+
+    REQUIRE(sumRMap == sumMulti);
+}
+
+TEST_CASE("MCTS Agent Function", "[performance]")
+{
+    const int moves = 10;
+
+    agents::MCTSParameters params;
+    params.iterations = 0;
+    params.timeBudgetMs = 100;
+    agents::MCTSAgent agent(1, params);
+    agent.id = 0;
+
+    auto s = std::make_unique<bboard::State>();
+    auto obs = std::make_unique<bboard::Observation>();
+    s->Init(bboard::GameMode::FreeForAll, 1, 1);
+
+    std::mt19937 rng(1);
+    bboard::Move stepMoves[bboard::AGENT_COUNT];
+    long simulations = 0;
+    for(int i = 0; i < moves && !s->finished; i++)
+    {
+        bboard::Observation::Get(*s, 0, bboard::ObservationParameters(), *obs);
+        FillRandomMoves(rng, stepMoves);
+        stepMoves[0] = agent.act(obs.get());
+        simulations += agent.GetLastIterations();
+        s->Step(stepMoves);
+    }
+
+    std::string tst = "MCTS agent performance results:\n";
+    std::cout << std::endl
+              << FGRN(tst)
+              << "Simulations per move (100ms, depth " << params.maxDepth << "): ";
+    RecursiveCommas(std::cout, simulations / moves);
+    std::cout << std::endl;
+
+    REQUIRE(simulations > 0);
+}
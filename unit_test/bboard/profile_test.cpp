@@ -0,0 +1,76 @@
+#include <memory>
+#include <random>
+#include <sstream>
+#include <thread>
+
+#include "catch.hpp"
+#include "nlohmann/json.hpp"
+#include "bboard.hpp"
+#include "agents.hpp"
+#include "profile.hpp"
+#include "testing_utilities.hpp"
+
+using namespace bboard;
+
+TEST_CASE("Step Profiler", "[profile]")
+{
+    profile::Reset();
+
+    // steps in two threads
+    const int steps = 20;
+    auto play = [steps](long seed)
+    {
+        std::mt19937 rng(seed);
+        auto s = std::make_unique<State>();
+        s->Init(GameMode::FreeForAll, seed, seed);
+        Move moves[AGENT_COUNT];
+        for(int i = 0; i < steps; i++)
+        {
+            FillRandomMoves(rng, moves);
+            s->Step(moves);
+        }
+    };
+    std::thread t(play, 3);
+    t.join();
+    play(4);
+
+    // agents of the environment
+    std::mt19937 rng(5);
+    auto agents = CreateAgents<SimpleAgent>(rng);
+    Environment e;
+    e.MakeGame(ToPointerArray(agents), GameMode::FreeForAll, 5, 5);
+    e.Step(false);
+
+    const profile::Counters c = profile::Collect();
+    nlohmann::json j = nlohmann::json::parse(profile::ReportJSON());
+    REQUIRE(j["enabled"].get<bool>() == profile::Enabled());
+
+    std::stringstream table;
+    profile::Report(table);
+
+    if(profile::Enabled())
+    {
+        // every step ticks the flames once (also the terminal steps)
+        REQUIRE(c.calls[profile::TICK_FLAMES] >= 2 * steps);
+        REQUIRE(c.calls[profile::TICK_FLAMES] <= 2 * steps + 1);
+        REQUIRE(c.cycles[profile::TICK_FLAMES] > 0);
+        for(int i = 0; i < AGENT_COUNT; i++)
+        {
+            REQUIRE(c.calls[profile::ActSlot(i)] == 1);
+        }
+        REQUIRE(j["slots"][profile::SlotName(profile::EXPLODE_BOMBS)]["calls"].get<uint64_t>() == c.calls[profile::EXPLODE_BOMBS]);
+        REQUIRE(table.str().find(profile::SlotName(profile::RESOLVE_DEPENDENCIES)) != std::string::npos);
+
+        profile::Reset();
+        REQUIRE(profile::Collect().calls[profile::TICK_FLAMES] == 0);
+    }
+    else
+    {
+        // nothing is counted without POMCPP_PROFILE
+        for(int i = 0; i < profile::SLOT_COUNT; i++)
+        {
+            REQUIRE(c.calls[i] == 0);
+            REQUIRE(c.cycles[i] == 0);
+        }
+    }
+}
@@ -0,0 +1,90 @@
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "catch.hpp"
+#include "bboard.hpp"
+#include "agents.hpp"
+#include "rollout_engine.hpp"
+
+using namespace bboard;
+
+TEST_CASE("Work Stealing Pool", "[rollout engine]")
+{
+    WorkStealingPool pool(4);
+    REQUIRE(pool.GetThreadCount() == 4);
+
+    // uneven workloads (only the first block is expensive) are stolen
+    const int count = 1000;
+    std::vector<std::atomic<int>> calls(count);
+    std::atomic<int> workersOfFirstBlock[4] = {};
+    for(int run = 0; run < 3; run++)
+    {
+        pool.ParallelFor(count, [&](int i, int worker)
+        {
+            if(i < count / 4)
+            {
+                workersOfFirstBlock[worker] = 1;
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+            calls[i]++;
+        });
+    }
+
+    bool allThreeTimes = true;
+    for(int i = 0; i < count; i++)
+    {
+        allThreeTimes = allThreeTimes && calls[i] == 3;
+    }
+    REQUIRE(allThreeTimes);
+    REQUIRE(workersOfFirstBlock[0] + workersOfFirstBlock[1] + workersOfFirstBlock[2] + workersOfFirstBlock[3] > 1);
+
+    // exceptions are passed to the caller
+    REQUIRE_THROWS_AS(pool.ParallelFor(10, [](int i, int) { if(i == 7) throw std::runtime_error("fail"); }), std::runtime_error);
+    pool.ParallelFor(10, [&](int i, int) { calls[i]++; });
+    REQUIRE(calls[9] == 4);
+}
+
+TEST_CASE("Rollout Determinism", "[rollout engine]")
+{
+    auto root = std::make_unique<State>();
+    root->Init(GameMode::FreeForAll, 42, 42);
+
+    AgentFactory policy = [](int, long seed)
+    {
+        return std::make_unique<agents::SimpleUnbiasedAgent>(seed);
+    };
+
+    const int rollouts = 24;
+    RolloutResult results[3];
+    const int threadCounts[3] = {1, 3, 8};
+    for(int t = 0; t < 3; t++)
+    {
+        RolloutEngine engine(threadCounts[t]);
+        results[t] = engine.Run(*root, policy, rollouts, 1234);
+    }
+
+    for(int t = 0; t < 3; t++)
+    {
+        const RolloutResult& r = results[t];
+        REQUIRE(r.rollouts == rollouts);
+        REQUIRE(r.steps == results[0].steps);
+        REQUIRE(r.unfinished == results[0].unfinished);
+        REQUIRE(r.draws == results[0].draws);
+        for(int i = 0; i < AGENT_COUNT; i++)
+        {
+            REQUIRE(r.returns[i] == results[0].returns[i]);
+            REQUIRE(r.wins[i] == results[0].wins[i]);
+        }
+    }
+
+    // free for all games have a single winner unless they are a draw
+    const RolloutResult& r = results[0];
+    int wins = 0;
+    for(int i = 0; i < AGENT_COUNT; i++)
+    {
+        wins += r.wins[i];
+    }
+    REQUIRE(wins + r.draws + r.unfinished == rollouts);
+}
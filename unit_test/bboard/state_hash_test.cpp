@@ -0,0 +1,62 @@
+#include "catch.hpp"
+#include "bboard.hpp"
+#include "testing_utilities.hpp"
+
+using namespace bboard;
+
+uint64_t _staticInitHash()
+{
+    State s;
+    s.Init(GameMode::FreeForAll, 1234, -1);
+    return s.hash;
+}
+
+// hashed during the static initialization of this translation unit
+const uint64_t _staticHash = _staticInitHash();
+
+TEST_CASE("Incremental State Hash", "[state hash]")
+{
+    PlayRandomGames(4242, 100, 500, [](State& s, Move* moves)
+    {
+        s.Step(moves);
+        REQUIRE(s.hash == s.ComputeHash());
+    });
+}
+
+TEST_CASE("State Hash Modifications", "[state hash]")
+{
+    State s;
+    s.Init(GameMode::FreeForAll, 1234, -1);
+    const uint64_t initialHash = s.hash;
+    REQUIRE(initialHash == s.ComputeHash());
+
+    // the keys do not depend on the static initialization order
+    REQUIRE(_staticHash == initialHash);
+
+    SECTION("Bombs and Kills")
+    {
+        s.PutBomb(5, 5, 0, 2, 3, true);
+        REQUIRE(s.hash != initialHash);
+        REQUIRE(s.hash == s.ComputeHash());
+
+        s.Kill(1, 2);
+        REQUIRE(s.hash == s.ComputeHash());
+
+        s.ExplodeBombAt(0);
+        REQUIRE(s.flames.count > 0);
+        REQUIRE(s.hash == s.ComputeHash());
+    }
+
+    SECTION("Transpositions")
+    {
+        // the same positions result in the same hash (the time step is ignored)
+        Move moves[AGENT_COUNT] = {Move::DOWN, Move::IDLE, Move::IDLE, Move::IDLE};
+        s.Step(moves);
+        REQUIRE(s.hash != initialHash);
+
+        moves[0] = Move::UP;
+        s.Step(moves);
+        REQUIRE(s.agents[0].GetPos() == Position({1, 1}));
+        REQUIRE(s.hash == initialHash);
+    }
+}
@@ -0,0 +1,189 @@
+#include <memory>
+
+#include "catch.hpp"
+#include "bboard.hpp"
+#include "step_utility.hpp"
+#include "testing_utilities.hpp"
+
+using namespace bboard;
+
+/**
+ * @brief _countEvents Returns the number of events of the given type.
+ */
+int _countEvents(const StepEvents& events, StepEventType type)
+{
+    int count = 0;
+    for(int i = 0; i < events.Count(); i++)
+    {
+        count += events[i].type == type;
+    }
+    return count;
+}
+
+/**
+ * @brief _requireEventsMatchDiff Requires that the events of a step match
+ * the differences between the states before and after the step.
+ */
+void _requireEventsMatchDiff(const State& before, const State& after, const StepEvents& events)
+{
+    // kills
+    int kills = 0;
+    for(int i = 0; i < AGENT_COUNT; i++)
+    {
+        kills += !before.agents[i].dead && after.agents[i].dead;
+    }
+    REQUIRE(kills == _countEvents(events, StepEventType::AgentKilled));
+
+    // destroyed wood
+    int wood = 0;
+    for(int y = 0; y < BOARD_SIZE; y++)
+    {
+        for(int x = 0; x < BOARD_SIZE; x++)
+        {
+            wood += IS_WOOD(before.items[y][x]) && !IS_WOOD(after.items[y][x]);
+        }
+    }
+    REQUIRE(wood == _countEvents(events, StepEventType::WoodDestroyed));
+
+    // collected powerups (flames can reveal powerups at the beginning of the step)
+    auto afterFlames = std::make_unique<State>(before);
+    util::TickFlames(afterFlames.get());
+    for(int i = 0; i < events.Count(); i++)
+    {
+        const StepEvent& e = events[i];
+        INFO("event " << i << " at " << e.position);
+        REQUIRE(e.timeStep == before.timeStep);
+        if(e.type == StepEventType::PowerupCollected)
+        {
+            REQUIRE(afterFlames->items[e.position.y][e.position.x] == e.value);
+            REQUIRE((after.agents[e.agent].dead || after.agents[e.agent].GetPos() == e.position));
+        }
+        else if(e.type == StepEventType::WoodDestroyed)
+        {
+            REQUIRE(Board::FlagItem(WOOD_POWFLAG(before.items[e.position.y][e.position.x])) == e.value);
+        }
+    }
+    for(int i = 0; i < AGENT_COUNT; i++)
+    {
+        const AgentInfo& a = after.agents[i];
+        if(!a.dead && a.GetPos() != before.agents[i].GetPos() && IS_POWERUP(afterFlames->items[a.y][a.x]))
+        {
+            bool found = false;
+            for(int j = 0; j < events.Count(); j++)
+            {
+                found = found || (events[j].type == StepEventType::PowerupCollected && events[j].agent == i);
+            }
+            INFO("agent " << i);
+            REQUIRE(found);
+        }
+    }
+}
+
+TEST_CASE("Step Events", "[step events]")
+{
+    auto state = std::make_unique<State>();
+    auto events = std::make_unique<StepEvents>();
+    State& s = *state;
+
+    SECTION("Explosion")
+    {
+        s.PutAgentsInCorners(0, 1, 2, 3, 0);
+        s.Kill(0, 3);
+        s.PutAgent(3, 3, 2);
+        s.PutBomb(4, 3, 1, 2, 1, true);
+        s.items[3][5] = Item::WOOD + Board::ItemFlag(Item::KICK);
+        s.RecomputeHash();
+
+        s.activeEvents = events.get();
+        Move m[AGENT_COUNT] = {Move::IDLE, Move::IDLE, Move::IDLE, Move::IDLE};
+        s.Step(m);
+        s.activeEvents = nullptr;
+
+        REQUIRE(events->Count() == 3);
+        REQUIRE(_countEvents(*events, StepEventType::BombExploded) == 1);
+
+        for(int i = 0; i < events->Count(); i++)
+        {
+            const StepEvent& e = (*events)[i];
+            if(e.type == StepEventType::AgentKilled)
+            {
+                REQUIRE(e.agent == 2);
+                REQUIRE(e.source == 1);
+            }
+            else if(e.type == StepEventType::WoodDestroyed)
+            {
+                REQUIRE(e.agent == 1);
+                REQUIRE(e.value == Item::KICK);
+                REQUIRE(e.position == Position{5, 3});
+            }
+        }
+    }
+
+    SECTION("Kick And Powerup")
+    {
+        s.PutAgentsInCorners(0, 1, 2, 3, 0);
+        s.Kill(2, 3);
+        s.agents[0].canKick = true;
+        s.PutBomb(1, 0, 0, 1, BOMB_LIFETIME, true);
+        s.PutItem(BOARD_SIZE - 2, 0, Item::INCRRANGE);
+        s.RecomputeHash();
+
+        s.activeEvents = events.get();
+        Move m[AGENT_COUNT] = {Move::RIGHT, Move::LEFT, Move::IDLE, Move::IDLE};
+        s.Step(m);
+
+        REQUIRE(events->Count() == 2);
+        REQUIRE((*events)[0].type == StepEventType::BombKicked);
+        REQUIRE((*events)[0].agent == 0);
+        REQUIRE((*events)[0].value == int(Direction::RIGHT));
+        REQUIRE((*events)[1].type == StepEventType::PowerupCollected);
+        REQUIRE((*events)[1].agent == 1);
+        REQUIRE((*events)[1].value == Item::INCRRANGE);
+        REQUIRE(s.agents[1].bombStrength == BOMB_DEFAULT_STRENGTH + 1);
+
+        // the events of several steps are collected until they are cleared
+        s.Step(m);
+        REQUIRE(events->Count() == 2);
+        events->Clear();
+        REQUIRE(events->Count() == 0);
+    }
+
+    SECTION("Ring Buffer")
+    {
+        for(int i = 0; i < STEP_EVENTS_CAPACITY + 5; i++)
+        {
+            events->Add(StepEventType::BombExploded, 0, -1, 0, {0, 0}, i);
+        }
+        REQUIRE(events->Count() == STEP_EVENTS_CAPACITY);
+        REQUIRE(events->dropped == 5);
+        REQUIRE((*events)[0].timeStep == 5);
+    }
+}
+
+TEST_CASE("Step Events Match State Diff", "[step events]")
+{
+    auto events = std::make_unique<StepEvents>();
+    auto before = std::make_unique<State>();
+    auto expected = std::make_unique<State>();
+
+    int totalEvents = 0;
+    PlayRandomGames(99, 100, 800, [&](State& s, Move* moves)
+    {
+        *before = s;
+        *expected = s;
+        expected->Step(moves);
+
+        events->Clear();
+        s.activeEvents = events.get();
+        s.Step(moves);
+        s.activeEvents = nullptr;
+        totalEvents += events->Count();
+
+        // recording events does not change the step
+        RequireStatesEqual(s, *expected);
+        REQUIRE(s.hash == expected->hash);
+        REQUIRE(events->dropped == 0);
+        _requireEventsMatchDiff(*before, s, *events);
+    });
+    REQUIRE(totalEvents > 0);
+}
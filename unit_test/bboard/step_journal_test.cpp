@@ -0,0 +1,119 @@
+#include <memory>
+#include <random>
+
+#include "catch.hpp"
+#include "bboard.hpp"
+#include "step_utility.hpp"
+#include "testing_utilities.hpp"
+
+using namespace bboard;
+
+/**
+ * @brief _requireRestored Requires that the state equals the given state,
+ * including the hash, the flame buckets and the bomb and flame indices.
+ */
+void _requireRestored(const State& s, const State& expected)
+{
+    RequireStatesEqual(s, expected);
+    REQUIRE(s.hash == expected.hash);
+    REQUIRE(std::equal(s.flameBuckets, s.flameBuckets + FLAME_LIFETIME, expected.flameBuckets));
+
+    for(int i = 0; i < s.bombs.count; i++)
+    {
+        INFO("bomb " << i);
+        REQUIRE(s.GetBombIndex(BMB_POS_X(s.bombs[i]), BMB_POS_Y(s.bombs[i])) == i);
+    }
+    for(int i = 0; i < s.flames.count; i++)
+    {
+        INFO("flame " << i);
+        REQUIRE(s.GetFlameIndex(s.flames[i].position.x, s.flames[i].position.y) == i);
+    }
+}
+
+TEST_CASE("Step Undo", "[step journal]")
+{
+    auto journal = std::make_unique<StepJournal>();
+    auto before = std::make_unique<State>();
+    auto expected = std::make_unique<State>();
+
+    PlayRandomGames(2021, 100, 500, [&](State& s, Move* moves)
+    {
+        *before = s;
+        *expected = s;
+        expected->Step(moves);
+
+        // the recorded step is the same as a regular step
+        s.StepRecorded(moves, *journal);
+        RequireStatesEqual(s, *expected);
+        REQUIRE(s.hash == expected->hash);
+
+        // undo restores the previous state
+        s.Undo(*journal);
+        _requireRestored(s, *before);
+
+        s.Step(moves);
+    });
+}
+
+TEST_CASE("Undo Flame Removal", "[step journal]")
+{
+    auto state = std::make_unique<State>();
+    State& s = *state;
+    s.PutAgentsInCorners(0, 1, 2, 3, 0);
+    s.timeStep = 0;
+
+    // the explosion overwrites flames of several buckets
+    s.currentFlameTime = -1;
+    const Flame oldFlames[] = {{{5, 4}, 1, -1}, {{6, 5}, 2, -1}, {{3, 5}, 2, -1},
+                               {{5, 5}, 3, -1}, {{5, 7}, 3, -1}};
+    for(const Flame& f : oldFlames)
+    {
+        s.flames.AddElem(f);
+        s.items[f.position.y][f.position.x] = Item::FLAME;
+    }
+    s.currentFlameTime = util::OptimizeFlameQueue(s);
+    s.PutBomb(5, 5, 0, 2, 1, false);
+    s.RecomputeHash();
+
+    auto before = std::make_unique<State>(s);
+    auto journal = std::make_unique<StepJournal>();
+    Move m[AGENT_COUNT] = {Move::IDLE, Move::IDLE, Move::IDLE, Move::IDLE};
+    s.StepRecorded(m, *journal);
+    REQUIRE(s.GetFlameLifetime(s.GetFlameIndex(5, 7)) == FLAME_LIFETIME);
+
+    s.Undo(*journal);
+    _requireRestored(s, *before);
+}
+
+TEST_CASE("Nested Step Undo", "[step journal]")
+{
+    std::mt19937 rng(7);
+    const int depth = 12;
+    StepJournal journals[depth];
+    Move moves[depth][AGENT_COUNT];
+
+    State s;
+    s.Init(GameMode::FreeForAll, 123, -1);
+    for(int i = 0; i < AGENT_COUNT; i++)
+    {
+        s.agents[i].canKick = true;
+    }
+    const State root = s;
+
+    // walk down a random path and revert it in reverse order
+    State path[depth];
+    for(int d = 0; d < depth; d++)
+    {
+        path[d] = s;
+        FillRandomMoves(rng, moves[d]);
+        s.StepRecorded(moves[d], journals[d]);
+    }
+
+    for(int d = depth - 1; d >= 0; d--)
+    {
+        INFO("depth " << d);
+        s.Undo(journals[d]);
+        _requireRestored(s, path[d]);
+    }
+    RequireStatesEqual(s, root);
+}
@@ -0,0 +1,170 @@
+#include <memory>
+#include <random>
+
+#include "catch.hpp"
+#include "bboard.hpp"
+#include "step_utility.hpp"
+#include "testing_utilities.hpp"
+
+using namespace bboard;
+
+template<typename Rules>
+bool _stepsEqual(GameMode mode, std::mt19937& rng)
+{
+    State s;
+    s.Init(mode, rng(), rng());
+    if(!Rules::Kick)
+    {
+        RemoveKickPowerUps(s);
+    }
+
+    State rulesState = s;
+    Move moves[AGENT_COUNT];
+    for(int step = 0; step < 800 && !s.finished; step++)
+    {
+        FillRandomMoves(rng, moves);
+        s.Step(moves);
+        rulesState.StepT<Rules>(moves);
+
+        if(!StatesEqual(s, rulesState) || s.hash != rulesState.hash)
+            return false;
+    }
+    return true;
+}
+
+TEST_CASE("Step Rules", "[step rules]")
+{
+    std::mt19937 rng(17);
+
+    for(int game = 0; game < 50; game++)
+    {
+        REQUIRE(_stepsEqual<NoKickFreeForAllRules>(GameMode::FreeForAll, rng));
+        REQUIRE(_stepsEqual<StepRules<true, false, false>>(GameMode::FreeForAll, rng));
+        REQUIRE(_stepsEqual<StepRules<false, true, false>>(GameMode::TwoTeams, rng));
+        REQUIRE(_stepsEqual<StepRules<true, true, false>>(GameMode::TwoTeams, rng));
+    }
+}
+
+TEST_CASE("Step Rules Ignore Kick", "[step rules]")
+{
+    auto state = std::make_unique<State>();
+    State& s = *state;
+    s.PutAgentsInCorners(0, 1, 2, 3, 0);
+    s.Kill(1, 2, 3);
+    s.agents[0].canKick = true;
+    s.PutBomb(1, 0, 0, 1, BOMB_LIFETIME, true);
+    s.RecomputeHash();
+
+    // the agent walks against the bomb
+    Move m[AGENT_COUNT] = {Move::RIGHT, Move::IDLE, Move::IDLE, Move::IDLE};
+    State noKick = s;
+    s.Step(m);
+    noKick.StepT<NoKickFreeForAllRules>(m);
+
+    REQUIRE(s.agents[0].GetPos() == Position{1, 0});
+    REQUIRE(BMB_DIR(s.bombs[0]) == int(Direction::RIGHT));
+
+    // without kicking, the bomb blocks the agent
+    REQUIRE(noKick.agents[0].GetPos() == Position{0, 0});
+    REQUIRE(BMB_POS(noKick.bombs[0]) == Position{1, 0});
+}
+
+/**
+ * @brief Executes a step without the collision-free fast path of State::Step.
+ */
+template<typename Rules>
+void _fullStep(State& s, Move* moves)
+{
+    util::TickFlames(&s);
+    if(s.finished)
+        return;
+
+    int aliveAgentsBefore = s.aliveAgents;
+
+    Position oldPos[AGENT_COUNT];
+    Position originalDestPos[AGENT_COUNT];
+    Position destPos[AGENT_COUNT];
+    bool dead[AGENT_COUNT];
+    util::FillPositions(&s, oldPos);
+    util::FillDestPos(&s, moves, originalDestPos);
+    std::copy_n(originalDestPos, AGENT_COUNT, destPos);
+    util::FillAgentDead(&s, dead);
+    util::FixDestPos<true>(oldPos, destPos, AGENT_COUNT, dead);
+
+    util::MoveAgents<Rules>(&s, moves, destPos);
+
+    Position bombDestinations[MAX_BOMBS];
+    util::FillBombDestPos(&s, bombDestinations);
+    util::ResolveBombMovement<Rules>(&s, oldPos, originalDestPos, bombDestinations);
+    util::ApplyAgentMovement<Rules>(&s);
+    util::MoveBombs<Rules>(&s, bombDestinations);
+
+    util::TickBombs(&s);
+    util::ExplodeBombs(&s);
+    s.timeStep++;
+
+    if(aliveAgentsBefore != s.aliveAgents)
+    {
+        util::CheckTerminalState<Rules>(s);
+    }
+    s.RehashAgentsAndBombs();
+}
+
+template<typename Rules>
+bool _fastPathEqual(GameMode mode, std::mt19937& rng, int padding, int& fastSteps, int& slowSteps)
+{
+    auto state = std::make_unique<State>();
+    State& s = *state;
+    s.Init(mode, rng(), rng(), DEFAULT_NUM_RIGID, DEFAULT_NUM_WOOD, DEFAULT_NUM_POWERUPS, padding);
+    for(int i = 0; i < AGENT_COUNT; i++)
+    {
+        s.agents[i].canKick = Rules::Kick && rng() % 2 == 0;
+        s.agents[i].maxBombCount = rng() % 3;
+    }
+    s.RecomputeHash();
+
+    auto reference = std::make_unique<State>(s);
+    auto afterFlames = std::make_unique<State>();
+    Move moves[AGENT_COUNT];
+    for(int step = 0; step < 800 && !s.finished; step++)
+    {
+        FillRandomMoves(rng, moves);
+
+        // count the steps which take the fast path
+        *afterFlames = s;
+        util::TickFlames(afterFlames.get());
+        Position oldPos[AGENT_COUNT], destPos[AGENT_COUNT];
+        util::FillPositions(afterFlames.get(), oldPos);
+        util::FillDestPos(afterFlames.get(), moves, destPos);
+        if(util::IsCollisionFreeStep<Rules>(afterFlames.get(), oldPos, destPos))
+            fastSteps++;
+        else
+            slowSteps++;
+
+        s.StepT<Rules>(moves);
+        _fullStep<Rules>(*reference, moves);
+
+        if(!StatesEqual(s, *reference) || s.hash != reference->hash)
+            return false;
+    }
+    return true;
+}
+
+TEST_CASE("Collision-Free Fast Path", "[step rules]")
+{
+    std::mt19937 rng(23);
+
+    int fastSteps = 0, slowSteps = 0;
+    for(int game = 0; game < 40; game++)
+    {
+        // agents start in the corners or close to each other in the center
+        const int padding = game % 2 == 0 ? 1 : BOARD_SIZE / 2 - 1;
+        REQUIRE(_fastPathEqual<DefaultRules>(GameMode::FreeForAll, rng, padding, fastSteps, slowSteps));
+        REQUIRE(_fastPathEqual<DefaultRules>(GameMode::TwoTeams, rng, padding, fastSteps, slowSteps));
+        REQUIRE(_fastPathEqual<NoKickFreeForAllRules>(GameMode::FreeForAll, rng, padding, fastSteps, slowSteps));
+    }
+
+    // both paths are covered
+    REQUIRE(fastSteps > 0);
+    REQUIRE(slowSteps > 0);
+}
@@ -176,3 +176,44 @@ TEST_CASE("Dependency Resolving", "[step utilities]")
         REQUIRE_ROOTS(chain, 0, 1);
     }
 }
+
+TEST_CASE("Move Masks", "[step utilities][default-size]")
+{
+    // the positions are hard-coded for the default board size
+    if(bboard::BOARD_SIZE != 11)
+        return;
+
+    std::unique_ptr<bboard::State> s = std::make_unique<bboard::State>();
+    s->Clear();
+    s->PutAgent(0, 0, 0);
+    s->PutAgent(5, 5, 1);
+    s->PutAgent(8, 2, 2);
+    s->PutAgent(3, 8, 3);
+
+    // agent 0: top left corner with a rigid block below
+    s->PutItem(0, 1, bboard::Item::RIGID);
+    // agent 1: bomb to the right (no kick), wood to the left, no bombs left
+    s->PutBomb(6, 5, 1, 1, 5, true);
+    s->agents[1].maxBombCount = 1;
+    s->PutItem(4, 5, bboard::Item::WOOD);
+    // agent 2: bomb to the right (kick)
+    s->PutBomb(9, 2, 1, 1, 5, true);
+    s->agents[2].canKick = true;
+    // agent 3: dead
+    s->Kill(3);
+
+    bboard::MoveMask masks[bboard::AGENT_COUNT];
+    bboard::util::ComputeMoveMasks(*s, masks);
+
+    using bboard::MoveBit;
+    using bboard::Move;
+    REQUIRE(masks[0] == (MoveBit(Move::IDLE) | MoveBit(Move::RIGHT) | MoveBit(Move::BOMB)));
+    REQUIRE(masks[1] == (MoveBit(Move::IDLE) | MoveBit(Move::UP) | MoveBit(Move::DOWN)));
+    REQUIRE(masks[2] == bboard::ALL_MOVES);
+    REQUIRE(masks[3] == MoveBit(Move::IDLE));
+
+    // a moving bomb is not a static obstacle
+    bboard::SetBombDirection(*s->GetBomb(6, 5), bboard::Direction::UP);
+    bboard::util::ComputeMoveMasks(*s, masks);
+    REQUIRE((masks[1] & MoveBit(Move::RIGHT)) != 0);
+}
@@ -1,8 +1,10 @@
+#include <memory>
 #include <random>
 
 #include "catch.hpp"
 #include "bboard.hpp"
 #include "strategy.hpp"
+#include "testing_utilities.hpp"
 
 using namespace bboard;
 
@@ -118,8 +120,72 @@ TEST_CASE("Fill RMap", "[strategy]")
     }
 }
 
-TEST_CASE("Move Towards Methods", "[strategy]")
+TEST_CASE("Fill MultiRMap", "[strategy]")
 {
+    std::mt19937 rng(11);
+    auto s = std::make_unique<State>();
+    auto maps = std::make_unique<strategy::MultiRMap>();
+    strategy::RMap r;
+
+    bool sameDistances = true, samePredecessors = true, sameMoves = true;
+    for(int game = 0; game < 10; game++)
+    {
+        *s = State();
+        s->Init(GameMode::FreeForAll, rng(), rng());
+
+        Move moves[AGENT_COUNT];
+        for(int step = 0; step < 300 && !s->finished; step++)
+        {
+            FillRandomMoves(rng, moves);
+            s->Step(moves);
+
+            // all agents, then every agent on its own
+            for(int mask = 0; mask <= AGENT_COUNT; mask++)
+            {
+                const int agentMask = mask == AGENT_COUNT ? (1 << AGENT_COUNT) - 1 : 1 << mask;
+                strategy::FillMultiRMap(*s, *maps, agentMask);
+
+                for(int i = 0; i < AGENT_COUNT; i++)
+                {
+                    if((agentMask & (1 << i)) == 0 || s->agents[i].dead)
+                    {
+                        REQUIRE((maps->agentMask & (1 << i)) == 0);
+                        continue;
+                    }
+
+                    strategy::FillRMap(*s, r, i);
+                    const strategy::AgentRMap view(*maps, i);
+                    REQUIRE((maps->agentMask & (1 << i)) != 0);
+                    REQUIRE(maps->info[i] == r.info);
+
+                    for(int y = 0; y < BOARD_SIZE; y++)
+                    {
+                        for(int x = 0; x < BOARD_SIZE; x++)
+                        {
+                            sameDistances = sameDistances && view.GetDistance(x, y) == r.GetDistance(x, y);
+                            samePredecessors = samePredecessors && view.GetPredecessor(x, y) == r.GetPredecessor(x, y);
+                            if(r.GetDistance(x, y) != 0)
+                            {
+                                sameMoves = sameMoves && strategy::MoveTowardsPosition(view, {x, y}) == strategy::MoveTowardsPosition(r, {x, y});
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    REQUIRE(sameDistances);
+    REQUIRE(samePredecessors);
+    REQUIRE(sameMoves);
+}
+
+TEST_CASE("Move Towards Methods", "[strategy][default-size]")
+{
+    // the positions are hard-coded for the default board size
+    if(BOARD_SIZE != 11)
+        return;
+
     std::unique_ptr<State> s = std::make_unique<State>();
     InitBoardItems(*s.get(), 0x1337);
 
@@ -169,3 +235,132 @@ TEST_CASE("Move Towards Methods", "[strategy]")
         REQUIRE(m2 == Move::DOWN);
     }
 }
+
+/**
+ * @brief _firstFlameSteps Steps the state with idle agents until all bombs
+ * exploded and records the step at which every cell is hit by an explosion
+ * for the first time (0 if it is never hit).
+ */
+void _firstFlameSteps(const State& state, int steps[BOARD_SIZE][BOARD_SIZE])
+{
+    std::fill_n(&steps[0][0], BOARD_SIZE * BOARD_SIZE, 0);
+
+    auto s = std::make_unique<State>(state);
+    Move idle[AGENT_COUNT] = {Move::IDLE, Move::IDLE, Move::IDLE, Move::IDLE};
+    for(int step = 1; step <= BOMB_LIFETIME; step++)
+    {
+        // keep stepping when agents die
+        s->finished = false;
+        s->Step(idle);
+        for(int i = 0; i < s->flames.count; i++)
+        {
+            // new flames have the full lifetime
+            const Position p = s->flames[i].position;
+            if(steps[p.y][p.x] == 0 && s->GetFlameLifetime(i) == FLAME_LIFETIME)
+            {
+                steps[p.y][p.x] = step;
+            }
+        }
+    }
+}
+
+/**
+ * @brief _dangerMismatch Returns the first cell where the danger map
+ * differs from the given steps or {-1, -1}.
+ */
+Position _dangerMismatch(const strategy::DangerMap& d, const int steps[BOARD_SIZE][BOARD_SIZE])
+{
+    for(int y = 0; y < BOARD_SIZE; y++)
+    {
+        for(int x = 0; x < BOARD_SIZE; x++)
+        {
+            if(strategy::IsInDanger(d, x, y) != steps[y][x])
+            {
+                return {x, y};
+            }
+        }
+    }
+    return {-1, -1};
+}
+
+TEST_CASE("Danger Map", "[strategy][default-size]")
+{
+    // the positions are hard-coded for the default board size
+    if(BOARD_SIZE != 11)
+        return;
+
+    auto s = std::make_unique<State>();
+    strategy::DangerMap d;
+
+    SECTION("Chains And Blocks")
+    {
+        s->Kill(1, 2, 3);
+        s->PutAgent(0, 0, 0);
+        s->PutItem(4, 7, Item::RIGID);
+        s->PutItem(6, 5, Item::WOOD);
+        s->PutBomb(2, 5, 0, 2, 9, true);
+        s->PutBomb(4, 5, 0, 3, 3, true);
+
+        strategy::FillDangerMap(*s, d);
+
+        // the first bomb is hit by the second one
+        REQUIRE(strategy::IsInDanger(*s, 0, 5) == 9);
+        REQUIRE(strategy::IsInDanger(d, 0, 5) == 3);
+        REQUIRE(strategy::IsInDanger(d, 2, 7) == 3);
+        REQUIRE(strategy::IsInDanger(d, 2, 8) == 0);
+
+        // flames stop at rigid blocks and wood
+        REQUIRE(strategy::IsInDanger(d, 4, 6) == 3);
+        REQUIRE(strategy::IsInDanger(d, 4, 7) == 0);
+        REQUIRE(strategy::IsInDanger(*s, 4, 8) == 3);
+        REQUIRE(strategy::IsInDanger(d, 4, 8) == 0);
+        REQUIRE(strategy::IsInDanger(d, 6, 5) == 3);
+        REQUIRE(strategy::IsInDanger(d, 7, 5) == 0);
+
+        REQUIRE(strategy::IsInDanger(d, 0, 0) == 0);
+        REQUIRE(strategy::IsInDanger(d, -1, 5) == 0);
+    }
+    SECTION("Burnt Wood")
+    {
+        s->Kill(1, 2, 3);
+        s->PutAgent(0, 0, 0);
+        s->PutItem(2, 1, Item::WOOD);
+        s->PutBomb(0, 1, 0, 3, 5, true);
+        s->PutBomb(2, 3, 0, 2, 2, true);
+
+        strategy::FillDangerMap(*s, d);
+
+        // the second bomb burns the wood before the first bomb explodes
+        REQUIRE(strategy::IsInDanger(d, 2, 1) == 2);
+        REQUIRE(strategy::IsInDanger(d, 1, 1) == 5);
+        REQUIRE(strategy::IsInDanger(d, 3, 1) == 5);
+
+        // wood which burns at the same time still blocks
+        SetBombTime(*s->GetBomb(0, 1), 2);
+        strategy::FillDangerMap(*s, d);
+        REQUIRE(strategy::IsInDanger(d, 1, 1) == 2);
+        REQUIRE(strategy::IsInDanger(d, 3, 1) == 0);
+    }
+}
+
+TEST_CASE("Danger Map Simulation", "[strategy]")
+{
+    strategy::DangerMap d;
+    auto idle = std::make_unique<State>();
+    int steps[BOARD_SIZE][BOARD_SIZE];
+    PlayRandomGames(13, 100, 300, [&](State& s, Move* moves)
+    {
+        // moving bombs are not simulated by the danger map
+        *idle = s;
+        for(int i = 0; i < idle->bombs.count; i++)
+        {
+            SetBombDirection(idle->bombs[i], Direction::IDLE);
+        }
+
+        _firstFlameSteps(*idle, steps);
+        strategy::FillDangerMap(*idle, d);
+        REQUIRE(_dangerMismatch(d, steps) == Position{-1, -1});
+
+        s.Step(moves);
+    });
+}
@@ -0,0 +1,148 @@
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "catch.hpp"
+#include "bboard.hpp"
+#include "tensor_encoder.hpp"
+#include "testing_utilities.hpp"
+
+using namespace bboard;
+
+/**
+ * @brief _referenceValue Computes the value of a plane at (x, y) cell by cell.
+ */
+int _referenceValue(const Board& b, int agentID, Plane plane, int x, int y)
+{
+    const int item = b.items[y][x];
+    const AgentInfo& self = b.agents[agentID];
+    switch(plane)
+    {
+        case Plane::PASSAGE: return item == Item::PASSAGE;
+        case Plane::RIGID: return item == Item::RIGID;
+        case Plane::WOOD: return IS_WOOD(item);
+        case Plane::BOMB: return item == Item::BOMB;
+        case Plane::FLAME: return IS_FLAME(item);
+        case Plane::FOG: return item == Item::FOG;
+        case Plane::EXTRABOMB: return IS_POWERUP(item) && item == Item::EXTRABOMB;
+        case Plane::INCRRANGE: return IS_POWERUP(item) && item == Item::INCRRANGE;
+        case Plane::KICK: return IS_POWERUP(item) && item == Item::KICK;
+        case Plane::BOMB_TIME:
+        case Plane::BOMB_STRENGTH:
+        case Plane::BOMB_MOVING:
+        {
+            const Bomb* bomb = b.GetBomb(x, y);
+            if(bomb == nullptr) return 0;
+            if(plane == Plane::BOMB_TIME) return BMB_TIME(*bomb);
+            if(plane == Plane::BOMB_STRENGTH) return BMB_STRENGTH(*bomb);
+            return BMB_DIR(*bomb) != int(Direction::IDLE);
+        }
+        case Plane::FLAME_TIME:
+        {
+            const int i = b.GetFlameIndex(x, y);
+            return i == -1 ? 0 : b.GetFlameLifetime(i);
+        }
+        case Plane::SELF:
+        case Plane::TEAMMATE:
+        case Plane::ENEMIES:
+            for(int i = 0; i < AGENT_COUNT; i++)
+            {
+                const AgentInfo& a = b.agents[i];
+                if(a.dead || !a.visible || a.x != x || a.y != y) continue;
+                if(plane == Plane::SELF) return i == agentID;
+                if(plane == Plane::TEAMMATE) return i != agentID && self.team != 0 && a.team == self.team;
+                return i != agentID && self.IsEnemy(a);
+            }
+            return 0;
+        case Plane::SELF_AMMO: return self.maxBombCount - self.bombCount;
+        case Plane::SELF_BOMB_STRENGTH: return self.bombStrength;
+        case Plane::SELF_CAN_KICK: return self.canKick;
+        default: return -1;
+    }
+}
+
+template<typename T>
+bool _matchesReference(const TensorEncoder& encoder, const Board& b, int agentID, const T* tensor)
+{
+    const std::vector<Plane>& planes = encoder.GetPlanes();
+    for(size_t p = 0; p < planes.size(); p++)
+    {
+        for(int y = 0; y < BOARD_SIZE; y++)
+        {
+            for(int x = 0; x < BOARD_SIZE; x++)
+            {
+                if(tensor[(p * BOARD_SIZE + y) * BOARD_SIZE + x] != T(_referenceValue(b, agentID, planes[p], x, y)))
+                    return false;
+            }
+        }
+    }
+    return true;
+}
+
+TEST_CASE("Tensor Encoder", "[tensor encoder]")
+{
+    std::vector<Plane> allPlanes;
+    for(int p = 0; p < int(Plane::PLANE_COUNT); p++)
+    {
+        allPlanes.push_back(Plane(p));
+    }
+
+    const TensorEncoder defaultEncoder;
+    const TensorEncoder allEncoder(allPlanes);
+    const TensorEncoder customEncoder({Plane::ENEMIES, Plane::FLAME, Plane::BOMB_TIME, Plane::WOOD});
+    REQUIRE(defaultEncoder.PlaneCount() == 18);
+    REQUIRE(allEncoder.Size() == int(Plane::PLANE_COUNT) * BOARD_SIZE * BOARD_SIZE);
+
+    ObservationParameters partial;
+    partial.agentPartialMapView = true;
+    partial.exposePowerUps = false;
+
+    std::mt19937 rng(5);
+    auto s = std::make_unique<State>();
+    auto obs = std::make_unique<std::array<Observation, AGENT_COUNT>>();
+    std::vector<float> tensor(allEncoder.Size()), batch(AGENT_COUNT * defaultEncoder.Size());
+    std::vector<uint8_t> tensorU8(allEncoder.Size());
+
+    bool match = true;
+    for(int game = 0; game < 6; game++)
+    {
+        *s = State();
+        s->Init(game % 2 == 0 ? GameMode::FreeForAll : GameMode::TwoTeams, rng(), rng());
+        for(int i = 0; i < AGENT_COUNT; i++)
+        {
+            s->agents[i].canKick = (game + i) % 2 == 0;
+        }
+
+        Move moves[AGENT_COUNT];
+        for(int step = 0; step < 300 && !s->finished && match; step++)
+        {
+            FillRandomMoves(rng, moves);
+            s->Step(moves);
+
+            // states
+            const int agent = step % AGENT_COUNT;
+            allEncoder.Encode(*s, agent, tensor.data());
+            allEncoder.Encode(*s, agent, tensorU8.data());
+            match = match && _matchesReference(allEncoder, *s, agent, tensor.data())
+                    && _matchesReference(allEncoder, *s, agent, tensorU8.data());
+
+            // observations
+            for(int i = 0; i < AGENT_COUNT; i++)
+            {
+                Observation::Get(*s, i, step % 2 == 0 ? partial : ObservationParameters(), (*obs)[i]);
+            }
+            customEncoder.Encode((*obs)[agent], tensor.data());
+            match = match && _matchesReference(customEncoder, (*obs)[agent], agent, tensor.data());
+
+            defaultEncoder.EncodeBatch(obs->data(), AGENT_COUNT, batch.data());
+            for(int i = 0; i < AGENT_COUNT; i++)
+            {
+                match = match && _matchesReference(defaultEncoder, (*obs)[i], i, batch.data() + i * defaultEncoder.Size());
+            }
+        }
+    }
+    REQUIRE(match);
+
+    REQUIRE_THROWS_AS(TensorEncoder({Plane::PLANE_COUNT}), std::runtime_error);
+}
@@ -1,6 +1,8 @@
 #include "catch.hpp"
 #include "bboard.hpp"
 #include "from_json.hpp"
+#include "pymethods.hpp"
+#include "tensor_encoder.hpp"
 #include <tuple>
 
 // some state and the corresponding observation
@@ -25,8 +27,12 @@ bool print = true;
 PairType allStates = (PairType){{FFA, JSON_STATE}, {TEAM, JSON_STATE_TEAM}, {RADIO, JSON_STATE_RADIO}};
 TripleType allObservations = (TripleType){{FFA, JSON_OBS, 3}, {TEAM, JSON_OBS_TEAM, 0}, {RADIO, JSON_OBS_RADIO, 0}};
 
-TEST_CASE("Load State", "[json]")
+TEST_CASE("Load State", "[json][default-size]")
 {
+    // the json states are boards of the default size
+    if(bboard::BOARD_SIZE != 11)
+        return;
+
     for (auto pair : allStates)
     {
         SECTION(std::get<0>(pair))
@@ -41,8 +47,12 @@ TEST_CASE("Load State", "[json]")
     }
 }
 
-TEST_CASE("Load Observation", "[json]")
+TEST_CASE("Load Observation", "[json][default-size]")
 {
+    // the json states are boards of the default size
+    if(bboard::BOARD_SIZE != 11)
+        return;
+
     for (auto triple : allObservations)
     {
         SECTION(std::get<0>(triple))
@@ -57,8 +67,12 @@ TEST_CASE("Load Observation", "[json]")
     }
 }
 
-TEST_CASE("Reconstruct State", "[json]")
+TEST_CASE("Reconstruct State", "[json][default-size]")
 {
+    // the json states are boards of the default size
+    if(bboard::BOARD_SIZE != 11)
+        return;
+
     for (int i = 0; i < allStates.size(); i++)
     {
         auto statePair = allStates[i];
@@ -99,4 +113,65 @@ TEST_CASE("Reconstruct State", "[json]")
             }
         }
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Encode JSON", "[json][default-size]")
+{
+    // the json states are boards of the default size
+    if(bboard::BOARD_SIZE != 11)
+        return;
+
+    const bboard::TensorEncoder encoder;
+    REQUIRE(encoder_default_plane_count() == encoder.PlaneCount());
+
+    std::vector<std::string> jsons = {JSON_STATE, JSON_STATE_TEAM, JSON_OBS, JSON_OBS_TEAM};
+    std::vector<char*> cjsons;
+    for(std::string& j : jsons)
+    {
+        cjsons.push_back(&j[0]);
+    }
+    const int agentIDs[4] = {3, 0, 3, 0};
+
+    std::vector<float> buffer(4 * encoder.Size());
+    std::vector<uint8_t> bufferU8(2 * encoder.Size());
+    REQUIRE(encode_json_batch(cjsons.data(), 2, true, agentIDs, nullptr, 0, buffer.data()));
+    REQUIRE(encode_json_batch(cjsons.data() + 2, 2, false, agentIDs + 2, nullptr, 0, buffer.data() + 2 * encoder.Size()));
+    REQUIRE(encode_json_batch_u8(cjsons.data(), 2, true, agentIDs, nullptr, 0, bufferU8.data()));
+
+    std::vector<float> expected(encoder.Size());
+    for(int i = 0; i < 4; i++)
+    {
+        if(i < 2)
+        {
+            bboard::State s = StateFromJSON(jsons[i]);
+            encoder.Encode(s, agentIDs[i], expected.data());
+            REQUIRE(std::equal(expected.begin(), expected.end(), bufferU8.begin() + i * encoder.Size()));
+        }
+        else
+        {
+            bboard::Observation o = ObservationFromJSON(jsons[i], agentIDs[i]);
+            encoder.Encode(o, expected.data());
+        }
+        REQUIRE(std::equal(expected.begin(), expected.end(), buffer.begin() + i * encoder.Size()));
+    }
+
+    // selected planes and invalid planes
+    const int planes[2] = {int(bboard::Plane::SELF), int(bboard::Plane::BOMB_TIME)};
+    const bboard::TensorEncoder selected({bboard::Plane::SELF, bboard::Plane::BOMB_TIME});
+    REQUIRE(encode_json_batch(cjsons.data(), 1, true, agentIDs, planes, 2, buffer.data()));
+    bboard::State s = StateFromJSON(jsons[0]);
+    selected.Encode(s, agentIDs[0], expected.data());
+    REQUIRE(std::equal(buffer.begin(), buffer.begin() + selected.Size(), expected.begin()));
+    REQUIRE(buffer[8 + 1 * bboard::BOARD_SIZE] == 1.0f);
+
+    const int invalid[1] = {int(bboard::Plane::PLANE_COUNT)};
+    REQUIRE_FALSE(encode_json_batch(cjsons.data(), 1, true, agentIDs, invalid, 1, buffer.data()));
+    // would wrap around to a valid plane when it is cast to the enum
+    const int truncated[1] = {256 + int(bboard::Plane::SELF)};
+    REQUIRE_FALSE(encode_json_batch(cjsons.data(), 1, true, agentIDs, truncated, 1, buffer.data()));
+
+    // invalid agent ids
+    const int invalidIDs[2] = {-1, bboard::AGENT_COUNT};
+    REQUIRE_FALSE(encode_json_batch(cjsons.data(), 1, true, invalidIDs, nullptr, 0, buffer.data()));
+    REQUIRE_FALSE(encode_json_batch(cjsons.data() + 2, 1, false, invalidIDs + 1, nullptr, 0, buffer.data()));
+}
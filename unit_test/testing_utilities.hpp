@@ -7,7 +7,10 @@
 
 #include <iostream>
 #include <iomanip>
+#include <memory>
+#include <random>
 
+#include "catch.hpp"
 #include "bboard.hpp"
 #include "agents.hpp"
 
@@ -25,6 +28,200 @@ std::array<bboard::Agent*, 4> ToPointerArray(std::array<AgentType, 4> &agents)
     return {&agents[0], &agents[1], &agents[2], &agents[3]};
 }
 
+/**
+ * @brief BoardsEqual Checks whether two boards contain exactly the same
+ * information (board, agents, bombs, flames and time).
+ */
+inline bool BoardsEqual(const bboard::Board& a, const bboard::Board& b)
+{
+    if(!std::equal(&a.items[0][0], &a.items[0][0] + bboard::BOARD_SIZE * bboard::BOARD_SIZE, &b.items[0][0]))
+        return false;
+
+    for(int i = 0; i < bboard::AGENT_COUNT; i++)
+    {
+        const bboard::AgentInfo& x = a.agents[i];
+        const bboard::AgentInfo& y = b.agents[i];
+        if(x.team != y.team || x.dead != y.dead || x.visible != y.visible || x.x != y.x || x.y != y.y
+                || x.statsVisible != y.statsVisible || x.bombCount != y.bombCount || x.maxBombCount != y.maxBombCount
+                || x.bombStrength != y.bombStrength || x.canKick != y.canKick)
+            return false;
+    }
+
+    if(a.bombs.count != b.bombs.count || a.flames.count != b.flames.count)
+        return false;
+
+    for(int i = 0; i < a.bombs.count; i++)
+    {
+        if(a.bombs[i] != b.bombs[i])
+            return false;
+    }
+
+    for(int i = 0; i < a.flames.count; i++)
+    {
+        const bboard::Flame& x = a.flames[i];
+        const bboard::Flame& y = b.flames[i];
+        if(x.position != y.position || x.timeLeft != y.timeLeft || x.destroyedWoodAtTimeStep != y.destroyedWoodAtTimeStep)
+            return false;
+    }
+
+    return a.timeStep == b.timeStep && a.currentFlameTime == b.currentFlameTime;
+}
+
+/**
+ * @brief StatesEqual Checks whether two states contain exactly the same
+ * information (board, agents, bombs, flames and game status).
+ */
+inline bool StatesEqual(const bboard::State& a, const bboard::State& b)
+{
+    return BoardsEqual(a, b)
+            && a.finished == b.finished && a.isDraw == b.isDraw && a.winningTeam == b.winningTeam
+            && a.winningAgent == b.winningAgent && a.aliveAgents == b.aliveAgents;
+}
+
+/**
+ * @brief FillRandomMoves Samples a random move for every agent.
+ */
+template <typename RNG>
+void FillRandomMoves(RNG& rng, bboard::Move moves[bboard::AGENT_COUNT])
+{
+    for(int i = 0; i < bboard::AGENT_COUNT; i++)
+    {
+        moves[i] = bboard::Move(rng() % 6);
+    }
+}
+
+/**
+ * @brief CheckBoardsEqual Checks every field of two boards separately, so
+ * that failures report which fields differ.
+ */
+inline void CheckBoardsEqual(const bboard::Board& a, const bboard::Board& b)
+{
+    for(int y = 0; y < bboard::BOARD_SIZE; y++)
+    {
+        for(int x = 0; x < bboard::BOARD_SIZE; x++)
+        {
+            if(a.items[y][x] != b.items[y][x])
+            {
+                INFO("item at " << bboard::Position(x, y));
+                CHECK(a.items[y][x] == b.items[y][x]);
+            }
+        }
+    }
+
+    for(int i = 0; i < bboard::AGENT_COUNT; i++)
+    {
+        INFO("agent " << i);
+        const bboard::AgentInfo& x = a.agents[i];
+        const bboard::AgentInfo& y = b.agents[i];
+        CHECK(x.GetPos() == y.GetPos());
+        CHECK(x.dead == y.dead);
+        CHECK(x.visible == y.visible);
+        CHECK(x.team == y.team);
+        CHECK(x.statsVisible == y.statsVisible);
+        CHECK(x.bombCount == y.bombCount);
+        CHECK(x.maxBombCount == y.maxBombCount);
+        CHECK(x.bombStrength == y.bombStrength);
+        CHECK(x.canKick == y.canKick);
+    }
+
+    CHECK(a.bombs.count == b.bombs.count);
+    for(int i = 0; i < std::min(a.bombs.count, b.bombs.count); i++)
+    {
+        INFO("bomb " << i);
+        CHECK(a.bombs[i] == b.bombs[i]);
+    }
+
+    CHECK(a.flames.count == b.flames.count);
+    for(int i = 0; i < std::min(a.flames.count, b.flames.count); i++)
+    {
+        INFO("flame " << i);
+        CHECK(a.flames[i].position == b.flames[i].position);
+        CHECK(a.flames[i].timeLeft == b.flames[i].timeLeft);
+        CHECK(a.flames[i].destroyedWoodAtTimeStep == b.flames[i].destroyedWoodAtTimeStep);
+    }
+
+    CHECK(a.timeStep == b.timeStep);
+    CHECK(a.currentFlameTime == b.currentFlameTime);
+}
+
+/**
+ * @brief RequireStatesEqual Requires that two states are equal (see
+ * StatesEqual). If they are not, all differing fields are reported.
+ */
+inline void RequireStatesEqual(const bboard::State& a, const bboard::State& b)
+{
+    if(!StatesEqual(a, b))
+    {
+        CheckBoardsEqual(a, b);
+        CHECK(a.finished == b.finished);
+        CHECK(a.isDraw == b.isDraw);
+        CHECK(a.winningTeam == b.winningTeam);
+        CHECK(a.winningAgent == b.winningAgent);
+        CHECK(a.aliveAgents == b.aliveAgents);
+    }
+    REQUIRE(StatesEqual(a, b));
+}
+
+/**
+ * @brief PlayRandomGames Plays free-for-all games with random moves. Some
+ * agents can kick and start with additional and stronger bombs, which
+ * covers bomb movement and chained explosions. Every step is executed by
+ * step(state, moves). Assertions inside step report the game and the step.
+ *
+ * @param seed The seed of the boards and moves
+ * @param games The number of games
+ * @param maxSteps The maximum number of steps per game
+ * @param step Executes the step
+ */
+template <typename F>
+void PlayRandomGames(unsigned int seed, int games, int maxSteps, F step)
+{
+    std::mt19937 rng(seed);
+    auto state = std::make_unique<bboard::State>();
+    bboard::Move moves[bboard::AGENT_COUNT];
+
+    for(int game = 0; game < games; game++)
+    {
+        bboard::State& s = *state;
+        s = bboard::State();
+        s.Init(bboard::GameMode::FreeForAll, rng(), rng());
+        for(int i = 0; i < bboard::AGENT_COUNT; i++)
+        {
+            s.agents[i].canKick = (game + i) % 2 == 0;
+            s.agents[i].maxBombCount = 1 + (game + i) % 3;
+            s.agents[i].bombStrength = 1 + (game + i) % 4;
+        }
+        s.RecomputeHash();
+
+        for(int t = 0; t < maxSteps && !s.finished; t++)
+        {
+            FillRandomMoves(rng, moves);
+            INFO("game " << game << ", step " << t);
+            step(s, moves);
+        }
+    }
+}
+
+/**
+ * @brief RemoveKickPowerUps Replaces all kick powerups (also below wood) by
+ * extra bombs, so that no agent can ever kick in this game.
+ */
+inline void RemoveKickPowerUps(bboard::State& state)
+{
+    for(int y = 0; y < bboard::BOARD_SIZE; y++)
+    {
+        for(int x = 0; x < bboard::BOARD_SIZE; x++)
+        {
+            int& item = state.items[y][x];
+            if(item == bboard::Item::KICK)
+                item = bboard::Item::EXTRABOMB;
+            else if(bboard::IS_WOOD(item) && bboard::WOOD_POWFLAG(item) == 3)
+                item = bboard::Item::WOOD + 1;
+        }
+    }
+    state.RecomputeHash();
+}
+
 template<class T>
 void RecursiveCommas(std::ostream& os, T n)
 {